@@ -269,6 +269,10 @@ void ImGuiUI::renderMemoryPanel() {
         ImGui::Text("Allocation Count: %zu", memoryData.allocationCount);
         ImGui::Text("Deallocation Count: %zu", memoryData.deallocationCount);
         ImGui::Text("Fragmentation: %zu", memoryData.fragmentation);
+        ImGui::Separator();
+        ImGui::Text("Reserved: %s", formatBytes(memoryData.reservedBytes).c_str());
+        ImGui::Text("Committed: %s", formatBytes(memoryData.committedBytes).c_str());
+        ImGui::Text("Resident: %s", formatBytes(memoryData.residentBytes).c_str());
         
         // Memory usage graph
         static float values[100] = {};
@@ -0,0 +1,196 @@
+#include "JobSystem.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace VaporFrame {
+namespace Core {
+
+namespace {
+
+// The pool the current thread works for and its queue there
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local std::size_t currentQueueIndex = 0;
+
+} // namespace
+
+JobSystem::JobSystem(std::size_t workerCount) {
+    queues.reserve(workerCount + 1);
+    for (std::size_t i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    workers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+    }
+    VF_LOG_INFO("JobSystem started with {} workers", workerCount);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+std::size_t JobSystem::getDefaultWorkerCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function) {
+    return schedule(std::move(function), {});
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function, const std::vector<JobHandle>& dependencies) {
+    JobHandle job(new Job(std::move(function)));
+    for (const JobHandle& dependency : dependencies) {
+        if (!dependency) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (!dependency->finished.load(std::memory_order_relaxed)) {
+            job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency->dependents.push_back(job);
+        }
+    }
+    
+    // Drop the scheduling reference; whoever drops the last one queues it
+    if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        enqueue(job);
+    }
+    return job;
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    while (job && !job->isFinished()) {
+        if (JobHandle next = takeJob()) {
+            run(next);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::wait(const std::vector<JobHandle>& jobs) {
+    for (const JobHandle& job : jobs) {
+        wait(job);
+    }
+}
+
+void JobSystem::parallelFor(std::size_t count, std::size_t grainSize,
+                            const std::function<void(std::size_t, std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        grainSize = std::max<std::size_t>(1, count / (getThreadCount() * 4));
+    }
+    if (workers.empty() || count <= grainSize) {
+        body(0, count);
+        return;
+    }
+    
+    std::vector<JobHandle> chunks;
+    chunks.reserve((count - 1) / grainSize);
+    for (std::size_t begin = grainSize; begin < count; begin += grainSize) {
+        std::size_t end = std::min(count, begin + grainSize);
+        chunks.push_back(schedule([&body, begin, end]() { body(begin, end); }));
+    }
+    body(0, grainSize);
+    wait(chunks);
+}
+
+std::size_t JobSystem::currentQueue() const {
+    return currentSystem == this ? currentQueueIndex : 0;
+}
+
+void JobSystem::enqueue(JobHandle job) {
+    WorkQueue& queue = *queues[currentQueue()];
+    {
+        // Counted under the queue lock, so takeJob never sees the count
+        // lag behind the deques
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queuedJobs.fetch_add(1);
+        queue.jobs.push_back(std::move(job));
+    }
+    
+    // Pairs with the sleeping count a worker publishes before checking
+    // queuedJobs, so either it sees the job or we see it asleep
+    if (sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeCondition.notify_one();
+    }
+}
+
+JobHandle JobSystem::takeJob() {
+    std::size_t own = currentQueue();
+    {
+        WorkQueue& queue = *queues[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            JobHandle job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+    
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& queue = *queues[(own + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            JobHandle job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            queuedJobs.fetch_sub(1);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::run(const JobHandle& job) {
+    job->function();
+    // Release whatever the function captured
+    job->function = nullptr;
+    
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+    for (JobHandle& dependent : dependents) {
+        if (dependent->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            enqueue(std::move(dependent));
+        }
+    }
+}
+
+void JobSystem::workerLoop(std::size_t queueIndex) {
+    currentSystem = this;
+    currentQueueIndex = queueIndex;
+    
+    while (true) {
+        if (JobHandle job = takeJob()) {
+            run(job);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1);
+        wakeCondition.wait(lock, [this]() { return stopping.load() || queuedJobs.load() > 0; });
+        sleepingWorkers.fetch_sub(1);
+        // Queued jobs are drained before shutting down
+        if (stopping.load() && queuedJobs.load() == 0) {
+            break;
+        }
+    }
+    currentSystem = nullptr;
+}
+
+} // namespace Core
+} // namespace VaporFrame
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VaporFrame {
+namespace Core {
+
+/**
+ * @brief A job scheduled on a JobSystem
+ *
+ * Held by the scheduler and by whoever keeps its JobHandle. Jobs scheduled
+ * with this one as a dependency are queued once it has finished.
+ */
+class Job {
+public:
+    bool isFinished() const { return finished.load(std::memory_order_acquire); }
+    
+private:
+    explicit Job(std::function<void()> function) : function(std::move(function)) {}
+    
+    std::function<void()> function;
+    // Unfinished dependencies, plus one held while the job is scheduled
+    std::atomic<std::uint32_t> pendingDependencies{1};
+    std::atomic<bool> finished{false};
+    // Guards dependents and the switch to finished
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Job>> dependents;
+    
+    friend class JobSystem;
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+/**
+ * @brief Fixed pool of worker threads with work stealing
+ *
+ * Every worker owns a deque: it pushes and pops its own jobs at the back and
+ * steals from the front of the others' when it runs dry. Threads outside the
+ * pool share one extra deque. A thread waiting on a job runs queued jobs in
+ * the meantime, so jobs may wait on jobs they schedule, and a pool with no
+ * workers runs everything on the waiting thread.
+ *
+ * Jobs must not throw.
+ */
+class JobSystem {
+public:
+    explicit JobSystem(std::size_t workerCount = getDefaultWorkerCount());
+    ~JobSystem();
+    
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    // Queues function once every job in dependencies has finished
+    JobHandle schedule(std::function<void()> function);
+    JobHandle schedule(std::function<void()> function, const std::vector<JobHandle>& dependencies);
+    
+    // Run queued jobs until the given ones have finished
+    void wait(const JobHandle& job);
+    void wait(const std::vector<JobHandle>& jobs);
+    
+    // Calls body(begin, end) over [0, count) in chunks of grainSize, running
+    // the first chunk on the calling thread, and returns when all are done.
+    // A grainSize of 0 splits into a few chunks per thread.
+    void parallelFor(std::size_t count, std::size_t grainSize,
+                     const std::function<void(std::size_t, std::size_t)>& body);
+    
+    std::size_t getWorkerCount() const { return workers.size(); }
+    // Workers plus the thread that waits
+    std::size_t getThreadCount() const { return workers.size() + 1; }
+    
+    // One worker per hardware thread besides the caller's
+    static std::size_t getDefaultWorkerCount();
+    
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+    
+    void workerLoop(std::size_t queueIndex);
+    void enqueue(JobHandle job);
+    // Own queue first, newest job; then the oldest job of another queue
+    JobHandle takeJob();
+    void run(const JobHandle& job);
+    std::size_t currentQueue() const;
+    
+    // [0] is shared by threads outside the pool, [i + 1] belongs to workers[i]
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> queuedJobs{0};
+    std::atomic<std::size_t> sleepingWorkers{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> stopping{false};
+};
+
+} // namespace Core
+} // namespace VaporFrame
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace VaporFrame {
+namespace Core {
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The contents are paged in by the OS on first touch, so opening a large
+ * file costs neither a read nor a copy. An empty file opens with no data.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const std::string& path);
+    void close();
+    
+    bool isOpen() const { return opened; }
+    const std::uint8_t* getData() const { return data; }
+    std::size_t getSize() const { return size; }
+    
+private:
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    bool opened = false;
+};
+
+} // namespace Core
+} // namespace VaporFrame
@@ -5,6 +5,8 @@
 #include <iomanip>
 #include <sstream>
 #include <cstdint>
+#include <cstring>
+#include <new>
 
 #define NOMINMAX
 #ifdef _WIN32
@@ -12,93 +14,340 @@
 #include <malloc.h>
 #else
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
+#include <cstdio>
 #endif
 
 namespace VaporFrame {
 namespace Core {
 
-// MemoryPool Implementation
-MemoryPool::MemoryPool(const MemoryPoolConfig& config) : config(config) {
-    // Allocate initial pool
-    void* initialPool = allocateFromSystem(config.initialSize);
-    if (initialPool) {
-        pools.push_back(initialPool);
-        
-        // Create initial free block
-        Block* initialBlock = new Block();
-        initialBlock->data = initialPool;
-        initialBlock->size = config.initialSize;
-        initialBlock->used = false;
-        initialBlock->next = nullptr;
-        initialBlock->prev = nullptr;
-        
-        freeBlocks.push_back(initialBlock);
-        blockMap[initialPool] = initialBlock;
+namespace {
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Index of the lowest set bit, value must be non-zero
+std::uint32_t findFirstSet(std::uint32_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<std::uint32_t>(index);
+#else
+    return static_cast<std::uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+// Index of the highest set bit, value must be non-zero
+std::uint32_t findLastSet(std::uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<std::uint32_t>(index);
+#else
+    return static_cast<std::uint32_t>(63 - __builtin_clzll(value));
+#endif
+}
+
+char* alignPointer(char* ptr, std::size_t alignment) {
+    return reinterpret_cast<char*>(alignUp(reinterpret_cast<std::uintptr_t>(ptr), alignment));
+}
+
+// Bump chunk the calling thread is carving allocations out of. Arena ids are
+// never reused, so a chunk left over from a destroyed arena can't match.
+struct FrameChunk {
+    std::uint64_t arenaId = 0;
+    std::uint64_t frame = 0;
+    char* cursor = nullptr;
+    char* end = nullptr;
+};
+
+thread_local FrameChunk frameChunk;
+std::atomic<std::uint64_t> nextFrameArenaId{1};
+
+#ifndef _WIN32
+// Over-map by one granule and trim both ends to get an aligned range
+void* mapAligned(std::size_t size, std::size_t granule, int protection, int flags) {
+    std::size_t mappedSize = size + granule;
+    void* mapped = mmap(nullptr, mappedSize, protection, flags, -1, 0);
+    if (mapped == MAP_FAILED) return nullptr;
+    
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(mapped);
+    std::uintptr_t aligned = alignUp(start, granule);
+    std::size_t head = aligned - start;
+    std::size_t tail = mappedSize - head - size;
+    if (head) munmap(mapped, head);
+    if (tail) munmap(reinterpret_cast<void*>(aligned + size), tail);
+    return reinterpret_cast<void*>(aligned);
+}
+#endif
+
+} // namespace
+
+// MemoryRegionMap Implementation
+MemoryRegionMap& MemoryRegionMap::getInstance() {
+    static MemoryRegionMap instance;
+    return instance;
+}
+
+MemoryRegionMap::~MemoryRegionMap() {
+    for (auto& entry : root) {
+        std::free(entry.load(std::memory_order_relaxed));
     }
 }
 
-MemoryPool::~MemoryPool() {
+void MemoryRegionMap::insert(const void* base, std::size_t size, AllocatorBase* allocator) {
+    assign(base, size, allocator);
+}
+
+void MemoryRegionMap::erase(const void* base, std::size_t size) {
+    assign(base, size, nullptr);
+}
+
+void MemoryRegionMap::assign(const void* base, std::size_t size, AllocatorBase* allocator) {
     std::lock_guard<std::mutex> lock(mutex);
     
-    // Free all pools
-    for (void* pool : pools) {
-        deallocateFromSystem(pool);
+    std::uintptr_t first = reinterpret_cast<std::uintptr_t>(base) >> GranuleLog2;
+    std::uintptr_t last = (reinterpret_cast<std::uintptr_t>(base) + size - 1) >> GranuleLog2;
+    for (std::uintptr_t key = first; key <= last; ++key) {
+        if (key >> (RootBits + LeafBits)) return;
+        
+        std::atomic<Leaf*>& slot = root[key >> LeafBits];
+        Leaf* leaf = slot.load(std::memory_order_relaxed);
+        if (!leaf) {
+            if (!allocator) continue;
+            // calloc leaves the untouched parts of the leaf uncommitted
+            leaf = static_cast<Leaf*>(std::calloc(1, sizeof(Leaf)));
+            if (!leaf) throw std::bad_alloc();
+            slot.store(leaf, std::memory_order_release);
+        }
+        leaf->owners[key & LeafMask].store(allocator, std::memory_order_release);
     }
-    
-    // Free all blocks
-    for (Block* block : freeBlocks) {
-        delete block;
+}
+
+void* MemoryRegionMap::allocatePages(std::size_t size) {
+    size = alignUp(size, Granule);
+#ifdef _WIN32
+    // VirtualAlloc reservations are already aligned to the 64KB allocation granularity
+    return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    return mapAligned(size, Granule, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS);
+#endif
+}
+
+void MemoryRegionMap::freePages(void* ptr, std::size_t size) {
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, alignUp(size, Granule));
+#endif
+}
+
+void* MemoryRegionMap::reservePages(std::size_t size, std::size_t alignment) {
+    alignment = std::max(alignment, Granule);
+    size = alignUp(size, alignment);
+#ifdef _WIN32
+    if (alignment == Granule) {
+        return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
     }
-    
-    pools.clear();
-    freeBlocks.clear();
-    blockMap.clear();
+    // Reservations can't be trimmed, so find an aligned address inside an
+    // oversized one and retry there in case another thread took it meanwhile
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        void* probe = VirtualAlloc(nullptr, size + alignment, MEM_RESERVE, PAGE_NOACCESS);
+        if (!probe) return nullptr;
+        VirtualFree(probe, 0, MEM_RELEASE);
+        
+        void* aligned = reinterpret_cast<void*>(alignUp(reinterpret_cast<std::uintptr_t>(probe), alignment));
+        if (void* reserved = VirtualAlloc(aligned, size, MEM_RESERVE, PAGE_NOACCESS)) {
+            return reserved;
+        }
+    }
+    return nullptr;
+#else
+    return mapAligned(size, alignment, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE);
+#endif
 }
 
-void* MemoryPool::allocate(std::size_t size, std::size_t alignment) {
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    if (size == 0) return nullptr;
-    
-    // Find suitable free block
-    Block* block = findFreeBlock(size, alignment);
-    if (!block) {
-        // Try to expand pool
-        if (!expand(std::max(size, config.blockSize))) {
-            return nullptr;
+bool MemoryRegionMap::commitPages(void* ptr, std::size_t size) {
+#ifdef _WIN32
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void MemoryRegionMap::decommitPages(void* ptr, std::size_t size) {
+#ifdef _WIN32
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+    // Mapping fresh PROT_NONE pages over the range drops both the contents and
+    // the commit charge, while keeping the address space reserved
+    mmap(ptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+#endif
+}
+
+void MemoryRegionMap::discardPages(void* ptr, std::size_t size) {
+#ifdef _WIN32
+    VirtualAlloc(ptr, size, MEM_RESET, PAGE_READWRITE);
+#else
+    madvise(ptr, size, MADV_DONTNEED);
+#endif
+}
+
+std::size_t MemoryRegionMap::residentBytes(const void* ptr, std::size_t size) {
+#ifdef _WIN32
+    // Per-page residency needs QueryWorkingSetEx from psapi, so report the
+    // range as resident; callers only pass committed memory
+    (void)ptr;
+    return size;
+#else
+    const std::size_t page = pageSize();
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(ptr) & ~(page - 1);
+    std::uintptr_t end = alignUp(reinterpret_cast<std::uintptr_t>(ptr) + size, page);
+    
+    // Query in fixed batches so this never allocates; it may run under a pool lock
+    unsigned char residency[256];
+    std::size_t resident = 0;
+    for (std::uintptr_t batch = start; batch < end;) {
+        std::size_t pages = std::min<std::size_t>((end - batch) / page, sizeof(residency));
+        if (mincore(reinterpret_cast<void*>(batch), pages * page, residency) != 0) break;
+        for (std::size_t i = 0; i < pages; ++i) {
+            resident += (residency[i] & 1) ? page : 0;
         }
-        block = findFreeBlock(size, alignment);
-        if (!block) return nullptr;
+        batch += pages * page;
     }
+    return resident;
+#endif
+}
+
+std::size_t MemoryRegionMap::hugePageSize() {
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege and can only be committed together
+    // with their reservation, which doesn't fit pools that grow in place
+    return 0;
+#else
+    static const std::size_t size = []() {
+        std::size_t bytes = 0;
+        if (std::FILE* file = std::fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r")) {
+            unsigned long long value = 0;
+            if (std::fscanf(file, "%llu", &value) == 1) bytes = static_cast<std::size_t>(value);
+            std::fclose(file);
+        }
+        // Without THP sysfs assume the common 2MB PMD size
+        return bytes ? bytes : std::size_t(2) * 1024 * 1024;
+    }();
+    return size;
+#endif
+}
+
+bool MemoryRegionMap::commitHugePages(void* ptr, std::size_t size) {
+#if defined(_WIN32) || !defined(MAP_HUGETLB)
+    (void)ptr;
+    (void)size;
+    return false;
+#else
+    // Without MAP_NORESERVE the kernel reserves the huge pages up front, so a
+    // short pool fails here rather than with SIGBUS on first touch
+    void* mapped = mmap(ptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+    if (mapped != MAP_FAILED) return true;
     
-    // Calculate aligned address
-    std::size_t alignedOffset = (reinterpret_cast<std::uintptr_t>(static_cast<char*>(block->data)) + alignment - 1) & ~(alignment - 1);
-    std::size_t padding = alignedOffset - reinterpret_cast<std::uintptr_t>(static_cast<char*>(block->data));
-    
-    if (padding + size > block->size) {
-        return nullptr; // Block too small after alignment
+    // Older kernels unmap the range before failing; put the reservation back
+    mmap(ptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    return false;
+#endif
+}
+
+bool MemoryRegionMap::adviseHugePages(void* ptr, std::size_t size) {
+#if defined(_WIN32) || !defined(MADV_HUGEPAGE)
+    (void)ptr;
+    (void)size;
+    return false;
+#else
+    return madvise(ptr, size, MADV_HUGEPAGE) == 0;
+#endif
+}
+
+bool MemoryRegionMap::bindPages(void* ptr, std::size_t size, int node) {
+#if defined(_WIN32) || !defined(SYS_mbind)
+    // Windows and kernels without mbind leave placement to first touch
+    (void)ptr;
+    (void)size;
+    (void)node;
+    return false;
+#else
+    // Raw mbind so the engine doesn't need libnuma. MPOL_PREFERRED falls back
+    // to other nodes when the preferred one runs out instead of failing.
+    constexpr int MpolPreferred = 1;
+    unsigned long nodeMask = 0;
+    if (node < 0 || node >= static_cast<int>(sizeof(nodeMask) * 8)) return false;
+    nodeMask = 1ul << node;
+    return syscall(SYS_mbind, ptr, size, MpolPreferred, &nodeMask, sizeof(nodeMask) * 8, 0) == 0;
+#endif
+}
+
+std::size_t MemoryRegionMap::pageSize() {
+    static const std::size_t size = []() {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwPageSize);
+#else
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }();
+    return size;
+}
+
+// MemoryPool Implementation
+MemoryPool::MemoryPool(const MemoryPoolConfig& config) : config(config) {
+    // Huge pages only pay off if the pool commits whole, aligned huge pages
+    pageMode = config.pageMode;
+    std::size_t hugePage = pageMode != PoolPageMode::Default ? MemoryRegionMap::hugePageSize() : 0;
+    if (hugePage) {
+        commitStep = std::max(commitStep, hugePage);
+    } else {
+        pageMode = PoolPageMode::Default;
     }
     
-    // Split block if necessary
-    if (padding + size < block->size) {
-        splitBlock(block, padding + size);
+    // Reserve room for the pool to grow to maxSize in place, commit the initial size
+    initialCommit = alignUp(std::max(config.initialSize, MinBlockSize + sizeof(Block)), commitStep);
+    std::size_t reservation = alignUp(std::max(config.maxSize, initialCommit), commitStep);
+    base = static_cast<char*>(MemoryRegionMap::reservePages(reservation, commitStep));
+    if (!base) return;
+    
+    if (!commitRange(base, initialCommit)) {
+        MemoryRegionMap::freePages(base, reservation);
+        base = nullptr;
+        return;
     }
+    reservedSize = reservation;
+    committedSize = initialCommit;
+    MemoryRegionMap::getInstance().insert(base, reservedSize, this);
+    initializeBlocks();
+}
+
+MemoryPool::~MemoryPool() {
+    std::lock_guard<std::mutex> lock(mutex);
     
-    // Mark block as used
-    block->used = true;
+    if (base) {
+        MemoryRegionMap::getInstance().erase(base, reservedSize);
+        MemoryRegionMap::freePages(base, reservedSize);
+    }
+}
+
+void* MemoryPool::allocate(std::size_t size, std::size_t alignment) {
+    std::lock_guard<std::mutex> lock(mutex);
     
-    // Update statistics
-    stats.totalAllocated += size;
-    stats.currentUsage += size;
-    stats.allocationCount++;
-    stats.peakUsage = std::max(stats.peakUsage, stats.currentUsage);
+    if (size == 0) return nullptr;
     
-    void* result = reinterpret_cast<void*>(alignedOffset);
+    void* result = allocateBlock(size, alignment);
+    if (!result) return nullptr;
     
     // Track allocation if enabled
     if (config.enableTracking) {
-        MemoryTracker::getInstance().trackAllocation(result, size, alignment, config.name, "", 0);
+        MemoryTracker::getInstance().trackAllocation(result, blockSize(blockOf(result)), alignment, config.name.c_str(), "", 0);
     }
     
     return result;
@@ -109,32 +358,22 @@ void MemoryPool::deallocate(void* ptr) {
     
     std::lock_guard<std::mutex> lock(mutex);
     
-    // Find the block containing this pointer
-    Block* block = nullptr;
-    for (auto& pair : blockMap) {
-        if (ptr >= pair.first && ptr < static_cast<char*>(pair.first) + pair.second->size) {
-            block = pair.second;
-            break;
-        }
-    }
+    if (!containsAddress(ptr)) return;
     
-    if (!block || !block->used) return;
+    Block* block = blockOf(ptr);
+    if (block->flags & (BlockFree | BlockSentinel)) return;
     
     // Update statistics
-    std::size_t size = block->size;
+    std::size_t size = blockSize(block);
     stats.totalFreed += size;
     stats.currentUsage -= size;
     stats.deallocationCount++;
     
-    // Mark block as free
-    block->used = false;
-    
-    // Merge with adjacent free blocks
-    mergeAdjacentBlocks(block);
+    releaseBlock(block);
     
     // Track deallocation if enabled
     if (config.enableTracking) {
-        MemoryTracker::getInstance().trackDeallocation(ptr);
+        MemoryTracker::getInstance().trackDeallocation(ptr, size);
     }
 }
 
@@ -147,27 +386,46 @@ void* MemoryPool::reallocate(void* ptr, std::size_t newSize) {
     
     std::lock_guard<std::mutex> lock(mutex);
     
-    // Find current block
-    Block* block = nullptr;
-    for (auto& pair : blockMap) {
-        if (ptr >= pair.first && ptr < static_cast<char*>(pair.first) + pair.second->size) {
-            block = pair.second;
-            break;
-        }
-    }
+    if (!containsAddress(ptr)) return nullptr;
     
-    if (!block) return nullptr;
+    Block* block = blockOf(ptr);
+    if (block->flags & (BlockFree | BlockSentinel)) return nullptr;
     
     // If new size fits in current block, just return the same pointer
-    if (newSize <= block->size) {
+    std::size_t oldSize = blockSize(block);
+    if (newSize <= oldSize) {
         return ptr;
     }
     
-    // Otherwise, allocate new block and copy data
-    void* newPtr = allocate(newSize);
-    if (newPtr) {
-        std::memcpy(newPtr, ptr, block->size);
-        deallocate(ptr);
+    void* newPtr = nullptr;
+    std::size_t requiredSize = alignUp(newSize, Granule);
+    Block* next = nextPhysical(block);
+    if ((next->flags & BlockFree) && oldSize + sizeof(Block) + blockSize(next) >= requiredSize) {
+        // Grow in place by absorbing the free block that follows
+        removeFreeBlock(next);
+        block->granules += static_cast<std::uint32_t>((sizeof(Block) + blockSize(next)) >> GranuleLog2);
+        nextPhysical(block)->prevPhysical = block;
+        if (compactCursor == next) compactCursor = block;
+        splitBlock(block, requiredSize);
+        
+        stats.totalAllocated += blockSize(block) - oldSize;
+        stats.currentUsage += blockSize(block) - oldSize;
+        stats.peakUsage = std::max(stats.peakUsage, stats.currentUsage);
+        newPtr = ptr;
+    } else {
+        // Otherwise, allocate new block and copy data
+        newPtr = allocateBlock(newSize, Granule);
+        if (!newPtr) return nullptr;
+        
+        std::memcpy(newPtr, ptr, oldSize);
+        stats.totalFreed += oldSize;
+        stats.currentUsage -= oldSize;
+        stats.deallocationCount++;
+        releaseBlock(block);
+    }
+    
+    if (config.enableTracking) {
+        MemoryTracker::getInstance().trackReallocation(ptr, oldSize, newPtr, blockSize(blockOf(newPtr)));
     }
     
     return newPtr;
@@ -176,93 +434,102 @@ void* MemoryPool::reallocate(void* ptr, std::size_t newSize) {
 std::size_t MemoryPool::getSize(void* ptr) const {
     std::lock_guard<std::mutex> lock(mutex);
     
-    for (auto& pair : blockMap) {
-        if (ptr >= pair.first && ptr < static_cast<char*>(pair.first) + pair.second->size) {
-            return pair.second->size;
-        }
-    }
-    return 0;
+    if (!containsAddress(ptr)) return 0;
+    
+    Block* block = blockOf(ptr);
+    if (block->flags & (BlockFree | BlockSentinel)) return 0;
+    return blockSize(block);
 }
 
 bool MemoryPool::owns(void* ptr) const {
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    for (auto& pair : blockMap) {
-        if (ptr >= pair.first && ptr < static_cast<char*>(pair.first) + pair.second->size) {
-            return true;
-        }
-    }
-    return false;
+    return containsAddress(ptr);
 }
 
 MemoryStats MemoryPool::getStats() const {
     std::lock_guard<std::mutex> lock(mutex);
-    return stats;
+    
+    MemoryStats result = stats;
+    result.reservedBytes = reservedSize;
+    result.committedBytes = committedSize;
+    result.residentBytes = base ? MemoryRegionMap::residentBytes(base, committedSize) : 0;
+    return result;
 }
 
 void MemoryPool::reset() {
     std::lock_guard<std::mutex> lock(mutex);
     
-    // Free all pools except the first one
-    for (size_t i = 1; i < pools.size(); ++i) {
-        deallocateFromSystem(pools[i]);
-    }
-    pools.resize(1);
+    if (!base) return;
     
-    // Reset all blocks to free
-    for (auto& pair : blockMap) {
-        pair.second->used = false;
+    // Give back everything committed past the initial size
+    if (committedSize > initialCommit) {
+        MemoryRegionMap::decommitPages(base + initialCommit, committedSize - initialCommit);
+        committedSize = initialCommit;
     }
     
-    // Rebuild free blocks list
-    freeBlocks.clear();
-    for (auto& pair : blockMap) {
-        freeBlocks.push_back(pair.second);
+    // Rebuild the bins with a single free block spanning the committed range
+    firstLevelBitmap = 0;
+    std::fill(std::begin(secondLevelBitmap), std::end(secondLevelBitmap), 0u);
+    for (auto& firstLevel : freeLists) {
+        std::fill(std::begin(firstLevel), std::end(firstLevel), nullptr);
     }
+    initializeBlocks();
+    releaseHandles();
     
     stats.reset();
 }
 
 bool MemoryPool::expand(std::size_t additionalSize) {
-    if (pools.empty()) return false;
-    
-    std::size_t totalSize = 0;
-    for (void* pool : pools) {
-        totalSize += config.initialSize;
-    }
-    
-    if (totalSize + additionalSize > config.maxSize) {
-        return false;
+    if (!base) return false;
+    
+    // Grow by at least the initial size so small requests don't commit page by page
+    std::size_t step = commitStep;
+    std::size_t growth = alignUp(std::max(additionalSize + sizeof(Block), initialCommit), step);
+    if (committedSize + growth > reservedSize) {
+        growth = alignUp(additionalSize + sizeof(Block), step);
+        if (committedSize + growth > reservedSize) {
+            return false;
+        }
     }
     
-    void* newPool = allocateFromSystem(additionalSize);
-    if (!newPool) return false;
+    if (!commitRange(base + committedSize, growth)) return false;
     
-    pools.push_back(newPool);
+    // The old sentinel becomes the header of the new space, and a new sentinel
+    // closes the committed range again
+    Block* block = sentinel();
+    committedSize += growth;
+    block->flags = 0;
+    block->granules = static_cast<std::uint32_t>((growth - sizeof(Block)) >> GranuleLog2);
     
-    // Create new free block
-    Block* newBlock = new Block();
-    newBlock->data = newPool;
-    newBlock->size = additionalSize;
-    newBlock->used = false;
-    newBlock->next = nullptr;
-    newBlock->prev = nullptr;
-    
-    freeBlocks.push_back(newBlock);
-    blockMap[newPool] = newBlock;
+    Block* end = new (sentinel()) Block();
+    end->prevPhysical = block;
+    end->flags = BlockSentinel;
     
+    insertFreeBlock(mergeAdjacentBlocks(block));
     return true;
 }
 
 void MemoryPool::defragment() {
     std::lock_guard<std::mutex> lock(mutex);
     
-    // Simple defragmentation: merge adjacent free blocks
-    for (auto& pair : blockMap) {
-        if (!pair.second->used) {
-            mergeAdjacentBlocks(pair.second);
-        }
-    }
+    // Adjacent free blocks are already merged on every deallocation. Sliding
+    // relocatable blocks down gathers the remaining holes at pinned blocks and
+    // the end of the heap, where trimming hands their pages back.
+    // The first pass finishes one a budgeted call left open, the second
+    // covers frees made since it started
+    compactLocked(std::chrono::steady_clock::time_point::max());
+    compactLocked(std::chrono::steady_clock::time_point::max());
+    trimLocked();
+}
+
+std::size_t MemoryPool::defragment(std::chrono::microseconds budget) {
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    std::lock_guard<std::mutex> lock(mutex);
+    return compactLocked(deadline);
+}
+
+std::size_t MemoryPool::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return trimLocked();
 }
 
 std::size_t MemoryPool::getFragmentation() const {
@@ -271,10 +538,11 @@ std::size_t MemoryPool::getFragmentation() const {
     std::size_t totalFree = 0;
     std::size_t largestFree = 0;
     
-    for (auto& pair : blockMap) {
-        if (!pair.second->used) {
-            totalFree += pair.second->size;
-            largestFree = std::max(largestFree, pair.second->size);
+    if (!base) return 0;
+    for (Block* block = reinterpret_cast<Block*>(base); !(block->flags & BlockSentinel); block = nextPhysical(block)) {
+        if (block->flags & BlockFree) {
+            totalFree += blockSize(block);
+            largestFree = std::max(largestFree, blockSize(block));
         }
     }
     
@@ -282,102 +550,451 @@ std::size_t MemoryPool::getFragmentation() const {
     return ((totalFree - largestFree) * 100) / totalFree;
 }
 
-MemoryPool::Block* MemoryPool::findFreeBlock(std::size_t size, std::size_t alignment) {
-    for (Block* block : freeBlocks) {
-        if (!block->used) {
-            std::size_t alignedOffset = (reinterpret_cast<std::uintptr_t>(static_cast<char*>(block->data)) + alignment - 1) & ~(alignment - 1);
-            std::size_t padding = alignedOffset - reinterpret_cast<std::uintptr_t>(static_cast<char*>(block->data));
-            
-            if (padding + size <= block->size) {
-                return block;
+MemoryPool::Handle MemoryPool::allocateHandle(std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (size == 0) return Handle{};
+    
+    void* payload = allocateBlock(size + sizeof(HandlePrefix), Granule);
+    if (!payload) return Handle{};
+    
+    std::uint32_t index = freeHandle;
+    if (index != InvalidHandleIndex) {
+        freeHandle = handleSlots[index].nextFree;
+    } else {
+        index = static_cast<std::uint32_t>(handleSlots.size());
+        handleSlots.emplace_back();
+    }
+    
+    HandleSlot& slot = handleSlots[index];
+    slot.block = blockOf(payload);
+    slot.block->flags |= BlockMovable;
+    slot.generation++;
+    new (payload) HandlePrefix();
+    static_cast<HandlePrefix*>(payload)->index = index;
+    liveHandles++;
+    
+    if (config.enableTracking) {
+        MemoryTracker::getInstance().trackAllocation(payload, blockSize(slot.block), Granule, config.name.c_str(), "", 0);
+    }
+    
+    return Handle{index, slot.generation};
+}
+
+void MemoryPool::deallocateHandle(Handle handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (handle.index >= handleSlots.size()) return;
+    HandleSlot& slot = handleSlots[handle.index];
+    if (slot.generation != handle.generation || !(slot.generation & 1u)) return;
+    
+    Block* block = slot.block;
+    std::size_t size = blockSize(block);
+    stats.totalFreed += size;
+    stats.currentUsage -= size;
+    stats.deallocationCount++;
+    
+    if (config.enableTracking) {
+        MemoryTracker::getInstance().trackDeallocation(payloadOf(block), size);
+    }
+    
+    block->flags &= static_cast<std::uint16_t>(~BlockMovable);
+    releaseBlock(block);
+    
+    slot.block = nullptr;
+    slot.generation++;
+    slot.nextFree = freeHandle;
+    freeHandle = handle.index;
+    liveHandles--;
+}
+
+void* MemoryPool::resolve(Handle handle) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (handle.index >= handleSlots.size()) return nullptr;
+    const HandleSlot& slot = handleSlots[handle.index];
+    if (slot.generation != handle.generation || !(slot.generation & 1u)) return nullptr;
+    return payloadOf(slot.block) + sizeof(HandlePrefix);
+}
+
+std::size_t MemoryPool::allocateBatch(std::size_t size, std::size_t count, void** out, std::uint16_t cacheTag) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    std::size_t allocated = 0;
+    while (allocated < count) {
+        void* ptr = allocateBlock(size, Granule);
+        if (!ptr) break;
+        
+        blockOf(ptr)->cacheTag = cacheTag;
+        out[allocated++] = ptr;
+    }
+    return allocated;
+}
+
+void MemoryPool::deallocateBatch(void* const* ptrs, std::size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    for (std::size_t i = 0; i < count; ++i) {
+        Block* block = blockOf(ptrs[i]);
+        std::size_t size = blockSize(block);
+        stats.totalFreed += size;
+        stats.currentUsage -= size;
+        stats.deallocationCount++;
+        releaseBlock(block);
+    }
+}
+
+void MemoryPool::mapping(std::size_t size, std::size_t& firstLevel, std::size_t& secondLevel) {
+    if (size < SmallBlockSize) {
+        // Small sizes get one bin per granule
+        firstLevel = 0;
+        secondLevel = size >> GranuleLog2;
+    } else {
+        std::uint32_t log2 = findLastSet(size);
+        secondLevel = (size >> (log2 - SecondLevelLog2)) ^ SecondLevelCount;
+        firstLevel = log2 - FirstLevelShift + 1;
+    }
+}
+
+void MemoryPool::insertFreeBlock(Block* block) {
+    std::size_t firstLevel, secondLevel;
+    mapping(blockSize(block), firstLevel, secondLevel);
+    
+    FreeLinks* links = new (payloadOf(block)) FreeLinks();
+    links->next = freeLists[firstLevel][secondLevel];
+    if (links->next) {
+        linksOf(links->next)->prev = block;
+    }
+    freeLists[firstLevel][secondLevel] = block;
+    
+    firstLevelBitmap |= 1u << firstLevel;
+    secondLevelBitmap[firstLevel] |= 1u << secondLevel;
+    block->flags |= BlockFree;
+    block->cacheTag = 0;
+}
+
+void MemoryPool::removeFreeBlock(Block* block) {
+    std::size_t firstLevel, secondLevel;
+    mapping(blockSize(block), firstLevel, secondLevel);
+    
+    FreeLinks* links = linksOf(block);
+    if (links->prev) linksOf(links->prev)->next = links->next;
+    if (links->next) linksOf(links->next)->prev = links->prev;
+    
+    if (freeLists[firstLevel][secondLevel] == block) {
+        freeLists[firstLevel][secondLevel] = links->next;
+        if (!links->next) {
+            secondLevelBitmap[firstLevel] &= ~(1u << secondLevel);
+            if (!secondLevelBitmap[firstLevel]) {
+                firstLevelBitmap &= ~(1u << firstLevel);
             }
         }
     }
-    return nullptr;
+    block->flags &= static_cast<std::uint16_t>(~BlockFree);
 }
 
-void MemoryPool::splitBlock(Block* block, std::size_t usedSize) {
-    if (usedSize >= block->size) return;
+MemoryPool::Block* MemoryPool::findFreeBlock(std::size_t size) {
+    // Round up to the next bin boundary so every block in the chosen bin fits
+    if (size >= SmallBlockSize) {
+        size += (std::size_t(1) << (findLastSet(size) - SecondLevelLog2)) - 1;
+    }
     
-    std::size_t remainingSize = block->size - usedSize;
-    if (remainingSize < config.blockSize) return; // Too small to split
+    std::size_t firstLevel, secondLevel;
+    mapping(size, firstLevel, secondLevel);
+    if (firstLevel >= FirstLevelCount) return nullptr;
     
-    // Create new block for remaining space
-    Block* newBlock = new Block();
-    newBlock->data = static_cast<char*>(block->data) + usedSize;
-    newBlock->size = remainingSize;
-    newBlock->used = false;
-    newBlock->next = block->next;
-    newBlock->prev = block;
+    std::uint32_t secondLevelMap = secondLevelBitmap[firstLevel] & (~0u << secondLevel);
+    if (!secondLevelMap) {
+        // Nothing left in this power of two, move to the next non-empty one
+        std::uint32_t firstLevelMap = firstLevel + 1 < FirstLevelCount ? firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+        if (!firstLevelMap) return nullptr;
+        
+        firstLevel = findFirstSet(firstLevelMap);
+        secondLevelMap = secondLevelBitmap[firstLevel];
+    }
+    secondLevel = findFirstSet(secondLevelMap);
     
-    if (block->next) block->next->prev = newBlock;
-    block->next = newBlock;
+    Block* block = freeLists[firstLevel][secondLevel];
+    removeFreeBlock(block);
+    return block;
+}
+
+void MemoryPool::splitBlock(Block* block, std::size_t size) {
+    std::size_t totalSize = blockSize(block);
+    if (totalSize < size + MinBlockSize) return; // Too small to split
     
-    // Update block size
-    block->size = usedSize;
+    // Create new block for remaining space
+    Block* remainder = new (payloadOf(block) + size) Block();
+    remainder->prevPhysical = block;
+    remainder->granules = static_cast<std::uint32_t>((totalSize - size - sizeof(Block)) >> GranuleLog2);
+    block->granules = static_cast<std::uint32_t>(size >> GranuleLog2);
+    nextPhysical(remainder)->prevPhysical = remainder;
     
-    // Add to free blocks list
-    freeBlocks.push_back(newBlock);
-    blockMap[newBlock->data] = newBlock;
+    insertFreeBlock(mergeAdjacentBlocks(remainder));
 }
 
-void MemoryPool::mergeAdjacentBlocks(Block* block) {
+MemoryPool::Block* MemoryPool::mergeAdjacentBlocks(Block* block) {
     // Merge with next block
-    if (block->next && !block->next->used) {
-        block->size += block->next->size;
-        Block* nextBlock = block->next;
-        block->next = nextBlock->next;
-        if (nextBlock->next) nextBlock->next->prev = block;
-        
-        // Remove from free blocks and block map
-        auto it = std::find(freeBlocks.begin(), freeBlocks.end(), nextBlock);
-        if (it != freeBlocks.end()) freeBlocks.erase(it);
-        blockMap.erase(nextBlock->data);
-        delete nextBlock;
+    Block* next = nextPhysical(block);
+    if (next->flags & BlockFree) {
+        removeFreeBlock(next);
+        block->granules += static_cast<std::uint32_t>((sizeof(Block) + blockSize(next)) >> GranuleLog2);
+        nextPhysical(block)->prevPhysical = block;
+        if (compactCursor == next) compactCursor = block;
     }
     
     // Merge with previous block
-    if (block->prev && !block->prev->used) {
-        block->prev->size += block->size;
-        block->prev->next = block->next;
-        if (block->next) block->next->prev = block->prev;
+    Block* prev = block->prevPhysical;
+    if (prev && (prev->flags & BlockFree)) {
+        removeFreeBlock(prev);
+        prev->granules += static_cast<std::uint32_t>((sizeof(Block) + blockSize(block)) >> GranuleLog2);
+        nextPhysical(prev)->prevPhysical = prev;
+        if (compactCursor == block) compactCursor = prev;
+        block = prev;
+    }
+    
+    return block;
+}
+
+void MemoryPool::initializeBlocks() {
+    // One free block spans the committed range and a zero-sized sentinel closes
+    // it, so walking to the next physical block never leaves committed memory
+    Block* first = new (base) Block();
+    first->granules = static_cast<std::uint32_t>((committedSize - 2 * sizeof(Block)) >> GranuleLog2);
+    
+    Block* end = new (nextPhysical(first)) Block();
+    end->prevPhysical = first;
+    end->flags = BlockSentinel;
+    
+    insertFreeBlock(first);
+}
+
+std::size_t MemoryPool::trimLocked() {
+    if (!base) return 0;
+    
+    std::size_t released = 0;
+    
+    // A free block at the end of the heap is shortened and the pages behind
+    // it decommitted, down to the initial commit
+    Block* last = sentinel()->prevPhysical;
+    if (last && (last->flags & BlockFree)) {
+        std::size_t lastOffset = static_cast<std::size_t>(reinterpret_cast<char*>(last) - base);
+        std::size_t keep = alignUp(std::max(initialCommit, lastOffset + MinBlockSize + sizeof(Block)), commitStep);
+        if (keep < committedSize) {
+            removeFreeBlock(last);
+            
+            std::size_t tail = committedSize - keep;
+            released += MemoryRegionMap::residentBytes(base + keep, tail);
+            MemoryRegionMap::decommitPages(base + keep, tail);
+            committedSize = keep;
+            
+            Block* end = new (sentinel()) Block();
+            end->prevPhysical = last;
+            end->flags = BlockSentinel;
+            last->granules = static_cast<std::uint32_t>((reinterpret_cast<char*>(end) - payloadOf(last)) >> GranuleLog2);
+            insertFreeBlock(last);
+        }
+    }
+    
+    // Other free blocks keep their pages committed but let the OS drop the
+    // whole pages between their free-list links and the next header. Huge
+    // pages are only dropped whole so they don't get split.
+    const std::size_t page = pageMode != PoolPageMode::Default ? commitStep : MemoryRegionMap::pageSize();
+    for (auto& firstLevel : freeLists) {
+        for (Block* block : firstLevel) {
+            for (; block; block = linksOf(block)->next) {
+                std::uintptr_t start = alignUp(reinterpret_cast<std::uintptr_t>(payloadOf(block) + sizeof(FreeLinks)), page);
+                std::uintptr_t end = reinterpret_cast<std::uintptr_t>(nextPhysical(block)) & ~(page - 1);
+                if (end <= start) continue;
+                
+                std::size_t resident = MemoryRegionMap::residentBytes(reinterpret_cast<void*>(start), end - start);
+                if (resident) {
+                    MemoryRegionMap::discardPages(reinterpret_cast<void*>(start), end - start);
+                    released += resident;
+                }
+            }
+        }
+    }
+    
+    return released;
+}
+
+bool MemoryPool::commitRange(char* ptr, std::size_t size) {
+    if (pageMode == PoolPageMode::Explicit && !MemoryRegionMap::commitHugePages(ptr, size)) {
+        // No reserved huge pages left, transparent ones are the next best thing
+        pageMode = PoolPageMode::Transparent;
+    }
+    if (pageMode != PoolPageMode::Explicit) {
+        if (!MemoryRegionMap::commitPages(ptr, size)) return false;
+        if (pageMode == PoolPageMode::Transparent && !MemoryRegionMap::adviseHugePages(ptr, size)) {
+            pageMode = PoolPageMode::Default;
+        }
+    }
+    
+    // Decommitting drops the memory policy with the pages, so bind on every commit
+    if (config.numaNode >= 0) {
+        MemoryRegionMap::bindPages(ptr, size, config.numaNode);
+    }
+    return true;
+}
+
+bool MemoryPool::containsAddress(const void* ptr) const {
+    return MemoryRegionMap::getInstance().find(ptr) == this;
+}
+
+void* MemoryPool::allocateBlock(std::size_t size, std::size_t alignment) {
+    if (size > config.maxSize) return nullptr;
+    
+    alignment = std::max(alignment, Granule);
+    std::size_t payloadSize = std::max(alignUp(size, Granule), sizeof(FreeLinks));
+    
+    // Over-aligned requests need room to carve a free block off the front
+    std::size_t searchSize = payloadSize;
+    if (alignment > Granule) {
+        searchSize += alignment + MinBlockSize;
+    }
+    
+    // Find suitable free block
+    Block* block = findFreeBlock(searchSize);
+    if (!block) {
+        // Try to expand pool
+        if (!expand(searchSize)) {
+            return nullptr;
+        }
+        block = findFreeBlock(searchSize);
+        if (!block) return nullptr;
+    }
+    
+    if (alignment > Granule) {
+        std::uintptr_t payload = reinterpret_cast<std::uintptr_t>(payloadOf(block));
+        std::uintptr_t aligned = alignUp(payload, alignment);
+        if (aligned != payload && aligned - payload < MinBlockSize) {
+            aligned = alignUp(payload + MinBlockSize, alignment);
+        }
+        
+        std::size_t gap = aligned - payload;
+        if (gap != 0) {
+            // Leading gap becomes its own free block in front of the aligned one
+            Block* alignedBlock = new (reinterpret_cast<void*>(aligned - sizeof(Block))) Block();
+            alignedBlock->prevPhysical = block;
+            alignedBlock->granules = block->granules - static_cast<std::uint32_t>(gap >> GranuleLog2);
+            nextPhysical(alignedBlock)->prevPhysical = alignedBlock;
+            
+            block->granules = static_cast<std::uint32_t>((gap - sizeof(Block)) >> GranuleLog2);
+            insertFreeBlock(block);
+            block = alignedBlock;
+        }
+    }
+    
+    // Split block if necessary
+    splitBlock(block, payloadSize);
+    
+    // Update statistics
+    std::size_t allocatedSize = blockSize(block);
+    stats.totalAllocated += allocatedSize;
+    stats.currentUsage += allocatedSize;
+    stats.allocationCount++;
+    stats.peakUsage = std::max(stats.peakUsage, stats.currentUsage);
+    
+    return payloadOf(block);
+}
+
+void MemoryPool::releaseBlock(Block* block) {
+    insertFreeBlock(mergeAdjacentBlocks(block));
+    compactPending = true;
+}
+
+std::size_t MemoryPool::compactLocked(std::chrono::steady_clock::time_point deadline) {
+    if (!base || liveHandles == 0) return 0;
+    
+    // Only holes opened since the last full pass can be closed
+    if (!compactCursor) {
+        if (!compactPending) return 0;
+        compactPending = false;
+    }
+    
+    // A hole followed by a relocatable block swaps places with it, so the hole
+    // travels up the heap until a pinned block or the sentinel stops it
+    std::size_t moved = 0;
+    Block* block = compactCursor ? compactCursor : reinterpret_cast<Block*>(base);
+    compactCursor = nullptr;
+    for (std::size_t visited = 1; !(block->flags & BlockSentinel); ++visited) {
+        Block* next = nextPhysical(block);
+        if ((block->flags & BlockFree) && (next->flags & BlockMovable)) {
+            moved += blockSize(next);
+            block = slideDown(next, block);
+        } else {
+            block = next;
+        }
         
-        // Remove from free blocks and block map
-        auto it = std::find(freeBlocks.begin(), freeBlocks.end(), block);
-        if (it != freeBlocks.end()) freeBlocks.erase(it);
-        blockMap.erase(block->data);
-        delete block;
+        // Reading the clock costs more than a block step, so only check it
+        // every few blocks or after copying data
+        if (((visited & 63) == 0 || block != next) && std::chrono::steady_clock::now() >= deadline) {
+            if (!(block->flags & BlockSentinel)) compactCursor = block;
+            break;
+        }
     }
+    return moved;
 }
 
-void* MemoryPool::allocateFromSystem(std::size_t size) {
-#ifdef _WIN32
-    return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
-#else
-    return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-#endif
+MemoryPool::Block* MemoryPool::slideDown(Block* block, Block* hole) {
+    Block* prev = hole->prevPhysical;
+    Block* after = nextPhysical(block);
+    std::uint32_t holeGranules = hole->granules;
+    void* oldPayload = payloadOf(block);
+    removeFreeBlock(hole);
+    
+    // Header and payload move together, overlapping when the block is larger than the hole
+    std::memmove(hole, block, sizeof(Block) + blockSize(block));
+    Block* movedBlock = hole;
+    movedBlock->prevPhysical = prev;
+    handleSlots[reinterpret_cast<HandlePrefix*>(payloadOf(movedBlock))->index].block = movedBlock;
+    
+    // The hole reappears behind the block with the same size
+    Block* freed = new (nextPhysical(movedBlock)) Block();
+    freed->prevPhysical = movedBlock;
+    freed->granules = holeGranules;
+    after->prevPhysical = freed;
+    
+    if (config.enableTracking) {
+        std::size_t size = blockSize(movedBlock);
+        MemoryTracker::getInstance().trackReallocation(oldPayload, size, payloadOf(movedBlock), size);
+    }
+    
+    freed = mergeAdjacentBlocks(freed);
+    insertFreeBlock(freed);
+    return freed;
 }
 
-void MemoryPool::deallocateFromSystem(void* ptr) {
-#ifdef _WIN32
-    VirtualFree(ptr, 0, MEM_RELEASE);
-#else
-    munmap(ptr, 0);
-#endif
+void MemoryPool::releaseHandles() {
+    // Bump every live generation so handles from before a reset go stale
+    freeHandle = InvalidHandleIndex;
+    for (std::size_t i = handleSlots.size(); i-- > 0;) {
+        HandleSlot& slot = handleSlots[i];
+        if (slot.generation & 1u) slot.generation++;
+        slot.block = nullptr;
+        slot.nextFree = freeHandle;
+        freeHandle = static_cast<std::uint32_t>(i);
+    }
+    liveHandles = 0;
+    compactCursor = nullptr;
+    compactPending = false;
 }
 
 // StackAllocator Implementation
 StackAllocator::StackAllocator(std::size_t size) : totalSize(size) {
-    memory = std::malloc(size);
+    memory = MemoryRegionMap::allocatePages(size);
     if (!memory) {
         throw std::bad_alloc();
     }
     currentOffset = 0;
+    MemoryRegionMap::getInstance().insert(memory, totalSize, this);
 }
 
 StackAllocator::~StackAllocator() {
     if (memory) {
-        std::free(memory);
+        MemoryRegionMap::getInstance().erase(memory, totalSize);
+        MemoryRegionMap::freePages(memory, totalSize);
     }
 }
 
@@ -432,105 +1049,300 @@ MemoryStats StackAllocator::getStats() const {
     return stats;
 }
 
-void StackAllocator::reset() {
+void StackAllocator::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    currentOffset = 0;
+    stats.reset();
+}
+
+void* StackAllocator::getMarker() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<char*>(memory) + currentOffset;
+}
+
+void StackAllocator::freeToMarker(void* marker) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (marker < memory || marker > static_cast<char*>(memory) + totalSize) {
+        return; // Invalid marker
+    }
+    
+    std::size_t newOffset = static_cast<char*>(marker) - static_cast<char*>(memory);
+    if (newOffset <= currentOffset) {
+        currentOffset = newOffset;
+    }
+}
+
+std::size_t StackAllocator::getCurrentOffset() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return currentOffset;
+}
+
+// FrameArena Implementation
+FrameArena::FrameArena(std::size_t frameSize, std::uint32_t frameCount)
+    : bytesPerFrame(alignUp(std::max<std::size_t>(frameSize, ChunkSize), 4096)),
+      framesInFlight(std::max<std::uint32_t>(frameCount, 1)),
+      id(nextFrameArenaId.fetch_add(1, std::memory_order_relaxed)) {
+    totalSize = bytesPerFrame * framesInFlight;
+    memory = MemoryRegionMap::allocatePages(totalSize);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    
+    frames = std::make_unique<FrameBuffer[]>(framesInFlight);
+    for (std::uint32_t i = 0; i < framesInFlight; ++i) {
+        frames[i].memory = static_cast<char*>(memory) + i * bytesPerFrame;
+    }
+    MemoryRegionMap::getInstance().insert(memory, totalSize, this);
+}
+
+FrameArena::~FrameArena() {
+    for (std::uint32_t i = 0; i < framesInFlight; ++i) {
+        recycle(frames[i]);
+    }
+    MemoryRegionMap::getInstance().erase(memory, totalSize);
+    MemoryRegionMap::freePages(memory, totalSize);
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment) {
+    if (size == 0) return nullptr;
+    
+    std::uint64_t frame = frameNumber.load(std::memory_order_acquire);
+    FrameChunk& chunk = frameChunk;
+    if (chunk.arenaId == id && chunk.frame == frame) {
+        char* ptr = alignPointer(chunk.cursor, alignment);
+        if (ptr <= chunk.end && size <= static_cast<std::size_t>(chunk.end - ptr)) {
+            chunk.cursor = ptr + size;
+            return ptr;
+        }
+    }
+    
+    FrameBuffer& buffer = frames[frame % framesInFlight];
+    
+    // Large requests go straight to the shared buffer rather than eating a chunk
+    if (size + alignment > ChunkSize / 4) {
+        if (char* ptr = claim(buffer, size, alignment)) {
+            return ptr;
+        }
+        return allocateOverflow(buffer, size, alignment);
+    }
+    
+    char* start = claim(buffer, ChunkSize, alignof(std::max_align_t));
+    if (!start) {
+        return allocateOverflow(buffer, size, alignment);
+    }
+    
+    char* ptr = alignPointer(start, alignment);
+    chunk.arenaId = id;
+    chunk.frame = frame;
+    chunk.cursor = ptr + size;
+    chunk.end = start + ChunkSize;
+    return ptr;
+}
+
+void FrameArena::deallocate(void* ptr) {
+    // Frame memory is released all at once when its buffer is recycled
+    (void)ptr;
+}
+
+void* FrameArena::reallocate(void* ptr, std::size_t newSize) {
+    // Sizes aren't recorded, so there is nothing to copy from
+    (void)ptr;
+    (void)newSize;
+    return nullptr;
+}
+
+std::size_t FrameArena::getSize(void* ptr) const {
+    (void)ptr;
+    return 0;
+}
+
+bool FrameArena::owns(void* ptr) const {
+    return ptr >= memory && ptr < static_cast<char*>(memory) + totalSize;
+}
+
+MemoryStats FrameArena::getStats() const {
     std::lock_guard<std::mutex> lock(mutex);
-    currentOffset = 0;
-    stats.reset();
+    
+    // Per-allocation counts would need shared counters on the bump path, so
+    // only buffer occupancy is reported
+    const FrameBuffer& buffer = frames[getFrameNumber() % framesInFlight];
+    MemoryStats result;
+    result.currentUsage = buffer.offset.load(std::memory_order_relaxed);
+    result.peakUsage = std::max(peakUsage, result.currentUsage);
+    result.fragmentation = overflowCount;
+    return result;
 }
 
-void* StackAllocator::getMarker() const {
+void FrameArena::reset() {
     std::lock_guard<std::mutex> lock(mutex);
-    return static_cast<char*>(memory) + currentOffset;
+    
+    for (std::uint32_t i = 0; i < framesInFlight; ++i) {
+        recycle(frames[i]);
+    }
+    peakUsage = 0;
+    overflowCount = 0;
+    // Bumping the frame number invalidates every thread's cached chunk
+    frameNumber.fetch_add(1, std::memory_order_release);
 }
 
-void StackAllocator::freeToMarker(void* marker) {
+void FrameArena::beginFrame() {
     std::lock_guard<std::mutex> lock(mutex);
     
-    if (marker < memory || marker > static_cast<char*>(memory) + totalSize) {
-        return; // Invalid marker
-    }
+    std::uint64_t frame = frameNumber.load(std::memory_order_relaxed);
+    const FrameBuffer& current = frames[frame % framesInFlight];
+    peakUsage = std::max(peakUsage, current.offset.load(std::memory_order_relaxed));
     
-    std::size_t newOffset = static_cast<char*>(marker) - static_cast<char*>(memory);
-    if (newOffset <= currentOffset) {
-        currentOffset = newOffset;
-    }
+    // The next buffer was last used framesInFlight - 1 frames ago, which is as
+    // long as the renderer can still be reading from it
+    recycle(frames[(frame + 1) % framesInFlight]);
+    frameNumber.store(frame + 1, std::memory_order_release);
 }
 
-std::size_t StackAllocator::getCurrentOffset() const {
+char* FrameArena::claim(FrameBuffer& buffer, std::size_t size, std::size_t alignment) {
+    // Compare-exchange rather than fetch_add so a request that doesn't fit
+    // leaves the rest of the buffer usable for smaller ones
+    std::size_t reserve = size + alignment - 1;
+    std::size_t offset = buffer.offset.load(std::memory_order_relaxed);
+    do {
+        if (reserve > bytesPerFrame - offset) {
+            return nullptr;
+        }
+    } while (!buffer.offset.compare_exchange_weak(offset, offset + reserve, std::memory_order_relaxed));
+    return alignPointer(buffer.memory + offset, alignment);
+}
+
+void* FrameArena::allocateOverflow(FrameBuffer& buffer, std::size_t size, std::size_t alignment) {
+    // The frame outgrew its buffer: fall back to the heap and free the block
+    // along with the buffer
+    alignment = std::max(alignment, alignof(std::max_align_t));
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(size, alignment);
+#else
+    void* ptr = std::aligned_alloc(alignment, alignUp(size, alignment));
+#endif
+    if (!ptr) return nullptr;
+    
     std::lock_guard<std::mutex> lock(mutex);
-    return currentOffset;
+    buffer.overflow.push_back(ptr);
+    overflowCount++;
+    return ptr;
+}
+
+void FrameArena::recycle(FrameBuffer& buffer) {
+    buffer.offset.store(0, std::memory_order_relaxed);
+    for (void* ptr : buffer.overflow) {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+    buffer.overflow.clear();
 }
 
 // MemoryTracker Implementation
+// Hands the thread's record back when the thread exits; its counters and any
+// queued events stay with the tracker
+struct MemoryTracker::ThreadRecordHandle {
+    ThreadRecord* record = nullptr;
+    
+    ~ThreadRecordHandle() {
+        if (record) {
+            MemoryTracker::getInstance().releaseThreadRecord(record);
+        }
+    }
+};
+
+thread_local MemoryTracker::ThreadRecordHandle MemoryTracker::threadRecordHandle;
+thread_local MemoryTracker::ThreadRecord* MemoryTracker::threadRecord = nullptr;
+
 MemoryTracker& MemoryTracker::getInstance() {
     static MemoryTracker instance;
     return instance;
 }
 
-void MemoryTracker::trackAllocation(void* ptr, std::size_t size, std::size_t alignment, 
-                                   const std::string& tag, const std::string& file, int line, bool isArray) {
-    if (!trackingEnabled) return;
-    
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    AllocationInfo info(ptr, size, alignment, tag, file, line, isArray);
-    allocations[ptr] = info;
-    
-    globalStats.totalAllocated += size;
-    globalStats.currentUsage += size;
-    globalStats.allocationCount++;
-    globalStats.peakUsage = std::max(globalStats.peakUsage, globalStats.currentUsage);
+MemoryTracker::~MemoryTracker() {
+    for (auto& slot : threadRecords) {
+        delete slot.load(std::memory_order_relaxed);
+    }
 }
 
-void MemoryTracker::trackDeallocation(void* ptr) {
-    if (!trackingEnabled) return;
-    
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    auto it = allocations.find(ptr);
-    if (it != allocations.end()) {
-        globalStats.totalFreed += it->second.size;
-        globalStats.currentUsage -= it->second.size;
-        globalStats.deallocationCount++;
-        allocations.erase(it);
-    }
+bool MemoryTracker::recordAllocation(ThreadRecord& record, void* ptr, std::size_t size, std::size_t alignment,
+                                     const char* tag, const char* file, int line, bool isArray, bool alwaysRecord) {
+    bool sampled = record.countdown <= 0 && advanceCountdown(record);
+    if (!sampled && !alwaysRecord) return false;
+    
+    Event event;
+    event.ptr = ptr;
+    event.size = size;
+    event.alignment = alignment;
+    event.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    event.tag = intern(record, tag);
+    event.file = intern(record, file);
+    event.line = line;
+    event.isAllocation = true;
+    event.isArray = isArray;
+    event.unsized = alwaysRecord;
+    
+    sampledFilter[filterSlot(ptr)].fetch_add(1, std::memory_order_relaxed);
+    pushEvent(record, event);
+    return true;
 }
 
-void MemoryTracker::trackReallocation(void* oldPtr, void* newPtr, std::size_t newSize) {
-    if (!trackingEnabled) return;
-    
-    std::lock_guard<std::mutex> lock(mutex);
-    
-    // Remove old allocation
-    auto it = allocations.find(oldPtr);
-    if (it != allocations.end()) {
-        globalStats.totalFreed += it->second.size;
-        globalStats.currentUsage -= it->second.size;
-        allocations.erase(it);
+void MemoryTracker::recordDeallocation(ThreadRecord& record, void* ptr, std::size_t size) {
+    Event event;
+    event.ptr = ptr;
+    event.size = size;
+    event.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    pushEvent(record, event);
+}
+
+void MemoryTracker::trackReallocation(void* oldPtr, std::size_t oldSize, void* newPtr, std::size_t newSize) {
+    trackDeallocation(oldPtr, oldSize);
+    trackAllocation(newPtr, newSize, 8, "realloc", "", 0);
+}
+
+void MemoryTracker::trackReallocation(const ReallocationKey& oldBlock, void* newPtr, std::size_t newSize) {
+    if (!newPtr || !trackingEnabled.load(std::memory_order_relaxed)) return;
+    ThreadRecord* record = getThreadRecord();
+    if (!record) return;
+    
+    void* oldPtr = reinterpret_cast<void*>(oldBlock.address);
+    if (sampledFilter[filterSlot(oldPtr)].load(std::memory_order_relaxed) != 0) {
+        Event event;
+        event.ptr = oldPtr;
+        event.sequence = oldBlock.sequence;
+        pushEvent(*record, event);
     }
-    
-    // Add new allocation
-    AllocationInfo info(newPtr, newSize, 8, "realloc", "", 0);
-    allocations[newPtr] = info;
-    
-    globalStats.totalAllocated += newSize;
-    globalStats.currentUsage += newSize;
-    globalStats.allocationCount++;
-    globalStats.peakUsage = std::max(globalStats.peakUsage, globalStats.currentUsage);
+    trackAllocation(newPtr, newSize, 8, "realloc", "", 0, false, true);
 }
 
 MemoryStats MemoryTracker::getGlobalStats() const {
     std::lock_guard<std::mutex> lock(mutex);
-    return globalStats;
+    drainAll();
+    return collectStats();
 }
 
 std::vector<AllocationInfo> MemoryTracker::getActiveAllocations() const {
     std::lock_guard<std::mutex> lock(mutex);
+    drainAll();
+    
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> internLock(internMutex);
+        names.reserve(internNames.size());
+        for (const std::string* name : internNames) {
+            names.push_back(*name);
+        }
+    }
+    
     std::vector<AllocationInfo> result;
     result.reserve(allocations.size());
-    
     for (const auto& pair : allocations) {
-        result.push_back(pair.second);
+        const Record& record = pair.second;
+        result.emplace_back(pair.first, record.size, record.alignment, names[record.tag],
+                            names[record.file], record.line, record.isArray);
     }
     
     return result;
@@ -542,37 +1354,70 @@ std::vector<AllocationInfo> MemoryTracker::getLeakedAllocations() const {
 
 void MemoryTracker::reset() {
     std::lock_guard<std::mutex> lock(mutex);
+    drainAll();
+    
+    // Counters are owned by their threads, so reset by moving the baseline
+    adjustments = MemoryStats{};
+    baseline = MemoryStats{};
+    MemoryStats current = collectStats();
+    baseline.totalAllocated = current.totalAllocated;
+    baseline.totalFreed = current.totalFreed;
+    baseline.allocationCount = current.allocationCount;
+    baseline.deallocationCount = current.deallocationCount;
+    peakUsage = 0;
+    // The owner may race this and keep an older mark; it only ever rises.
+    // A mark reached before the reset can still arrive with its next publish.
+    for (const auto& slot : threadRecords) {
+        if (ThreadRecord* record = slot.load(std::memory_order_acquire)) {
+            auto live = static_cast<std::int64_t>(record->publishedAllocated.load(std::memory_order_relaxed) -
+                                                  record->publishedFreed.load(std::memory_order_relaxed));
+            record->peak.store(live, std::memory_order_relaxed);
+            record->peakBaseline.store(live, std::memory_order_relaxed);
+        }
+    }
+    
     allocations.clear();
-    globalStats.reset();
+    pendingFrees.clear();
+    for (auto& slot : sampledFilter) {
+        slot.store(0, std::memory_order_relaxed);
+    }
 }
 
 void MemoryTracker::dumpStats() const {
-    std::lock_guard<std::mutex> lock(mutex);
+    MemoryStats stats = getGlobalStats();
+    std::size_t recorded = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        recorded = allocations.size();
+    }
     
     std::cout << "\n=== Memory Statistics ===" << std::endl;
-    std::cout << "Total Allocated: " << globalStats.totalAllocated << " bytes" << std::endl;
-    std::cout << "Total Freed: " << globalStats.totalFreed << " bytes" << std::endl;
-    std::cout << "Current Usage: " << globalStats.currentUsage << " bytes" << std::endl;
-    std::cout << "Peak Usage: " << globalStats.peakUsage << " bytes" << std::endl;
-    std::cout << "Allocation Count: " << globalStats.allocationCount << std::endl;
-    std::cout << "Deallocation Count: " << globalStats.deallocationCount << std::endl;
-    std::cout << "Active Allocations: " << allocations.size() << std::endl;
+    std::cout << "Total Allocated: " << stats.totalAllocated << " bytes" << std::endl;
+    std::cout << "Total Freed: " << stats.totalFreed << " bytes" << std::endl;
+    std::cout << "Current Usage: " << stats.currentUsage << " bytes" << std::endl;
+    std::cout << "Peak Usage: " << stats.peakUsage << " bytes" << std::endl;
+    std::cout << "Allocation Count: " << stats.allocationCount << std::endl;
+    std::cout << "Deallocation Count: " << stats.deallocationCount << std::endl;
+    std::cout << "Active Allocations: " << stats.allocationCount - stats.deallocationCount;
+    if (sampleRate > 1 || sampleInterval > 0) {
+        std::cout << " (" << recorded << " sampled)";
+    }
+    std::cout << std::endl;
     std::cout << "========================\n" << std::endl;
 }
 
 void MemoryTracker::dumpLeaks() const {
-    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<AllocationInfo> leaks = getLeakedAllocations();
     
-    if (allocations.empty()) {
+    if (leaks.empty()) {
         std::cout << "No memory leaks detected!" << std::endl;
         return;
     }
     
     std::cout << "\n=== Memory Leaks Detected ===" << std::endl;
-    std::cout << "Total leaks: " << allocations.size() << std::endl;
+    std::cout << "Total leaks: " << leaks.size() << std::endl;
     
-    for (const auto& pair : allocations) {
-        const AllocationInfo& info = pair.second;
+    for (const AllocationInfo& info : leaks) {
         std::cout << "Leak: " << info.ptr << " (" << info.size << " bytes)";
         if (!info.tag.empty()) {
             std::cout << " - " << info.tag;
@@ -585,18 +1430,358 @@ void MemoryTracker::dumpLeaks() const {
     std::cout << "============================\n" << std::endl;
 }
 
+MemoryTracker::ThreadRecord* MemoryTracker::adoptThreadRecord() {
+    for (auto& slot : threadRecords) {
+        ThreadRecord* record = slot.load(std::memory_order_acquire);
+        if (!record) {
+            std::lock_guard<std::mutex> lock(mutex);
+            record = slot.load(std::memory_order_relaxed);
+            if (!record) {
+                record = new ThreadRecord();
+                slot.store(record, std::memory_order_release);
+            }
+        }
+        
+        bool expected = false;
+        if (record->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            // Run the countdown out so the first allocation picks up the settings
+            record->countdown = 0;
+            record->armed = 0;
+            threadRecordHandle.record = record;
+            threadRecord = record;
+            return record;
+        }
+    }
+    return nullptr;
+}
+
+void MemoryTracker::releaseThreadRecord(ThreadRecord* record) {
+    publish(*record);
+    threadRecord = nullptr;
+    record->inUse.store(false, std::memory_order_release);
+}
+
+bool MemoryTracker::advanceCountdown(ThreadRecord& record) {
+    publish(record);
+    
+    record.untilSample -= record.armed - record.countdown;
+    bool sampled = record.untilSample <= 0;
+    std::uint32_t version = configVersion.load(std::memory_order_relaxed);
+    if (sampled || record.configVersion != version) {
+        std::size_t interval = sampleInterval.load(std::memory_order_relaxed);
+        std::uint32_t rate = sampleRate.load(std::memory_order_relaxed);
+        record.countBytes = interval != 0;
+        record.configVersion = version;
+        
+        // Jitter the gap so periodic allocation patterns don't alias with it.
+        // Gaps are uniform in [1, 2 * mean), which keeps the mean unbiased.
+        record.random ^= record.random << 13;
+        record.random ^= record.random >> 7;
+        record.random ^= record.random << 17;
+        std::uint64_t mean = interval ? interval : rate;
+        record.untilSample = static_cast<std::int64_t>(1 + record.random % (2 * mean - 1));
+    }
+    
+    record.armed = std::min(record.untilSample, record.countBytes ? PublishBytes : PublishCount);
+    record.countdown = record.armed;
+    return sampled;
+}
+
+void MemoryTracker::publish(ThreadRecord& record) {
+    record.publishedAllocated.store(record.allocated, std::memory_order_relaxed);
+    record.publishedFreed.store(record.freed, std::memory_order_relaxed);
+    record.publishedAllocationCount.store(record.allocationCount, std::memory_order_relaxed);
+    record.publishedDeallocationCount.store(record.deallocationCount, std::memory_order_relaxed);
+    if (record.batchPeak > record.peak.load(std::memory_order_relaxed)) {
+        record.peak.store(record.batchPeak, std::memory_order_relaxed);
+    }
+    record.batchPeak = static_cast<std::int64_t>(record.allocated - record.freed);
+}
+
+void MemoryTracker::pushEvent(ThreadRecord& record, const Event& event) {
+    std::uint64_t tail = record.tail.load(std::memory_order_relaxed);
+    if (tail - record.head.load(std::memory_order_acquire) == RingCapacity) {
+        std::lock_guard<std::mutex> lock(mutex);
+        drain(record);
+    }
+    record.events[tail % RingCapacity] = event;
+    record.tail.store(tail + 1, std::memory_order_release);
+}
+
+std::uint32_t MemoryTracker::intern(ThreadRecord& record, const char* str) {
+    if (!str || !*str) return 0;
+    
+    // Tags and file names are nearly always literals, so a pointer-keyed cache
+    // hits almost every time; the compare guards against reused buffers
+    InternCacheEntry& entry = record.internCache[(reinterpret_cast<std::uintptr_t>(str) >> 3) % InternCacheSize];
+    if (entry.key == str && *entry.name == str) {
+        return entry.id;
+    }
+    
+    std::lock_guard<std::mutex> lock(internMutex);
+    if (internNames.empty()) {
+        internNames.push_back(&internIds.emplace(std::string(), 0).first->first);
+    }
+    auto result = internIds.emplace(str, static_cast<std::uint32_t>(internNames.size()));
+    if (result.second) {
+        internNames.push_back(&result.first->first);
+    }
+    
+    entry.key = str;
+    entry.name = &result.first->first;
+    entry.id = result.first->second;
+    return entry.id;
+}
+
+void MemoryTracker::drain(ThreadRecord& record) const {
+    std::uint64_t head = record.head.load(std::memory_order_relaxed);
+    std::uint64_t tail = record.tail.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+        apply(record.events[head % RingCapacity]);
+    }
+    record.head.store(head, std::memory_order_release);
+    
+    MemoryStats stats = collectStats();
+    peakUsage = std::max(peakUsage, stats.currentUsage);
+}
+
+void MemoryTracker::drainAll() const {
+    // Apply in sequence order so an allocation and its free made on different
+    // threads usually meet in the right order
+    std::vector<Event> events;
+    for (const auto& slot : threadRecords) {
+        ThreadRecord* record = slot.load(std::memory_order_acquire);
+        if (!record) continue;
+        
+        std::uint64_t head = record->head.load(std::memory_order_relaxed);
+        std::uint64_t tail = record->tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            events.push_back(record->events[head % RingCapacity]);
+        }
+        record->head.store(head, std::memory_order_release);
+    }
+    
+    std::sort(events.begin(), events.end(),
+              [](const Event& a, const Event& b) { return a.sequence < b.sequence; });
+    for (const Event& event : events) {
+        apply(event);
+    }
+    
+    MemoryStats stats = collectStats();
+    peakUsage = std::max(peakUsage, stats.currentUsage);
+}
+
+void MemoryTracker::apply(const Event& event) const {
+    // Rings are drained independently, so events for one address can arrive
+    // out of order. Sequence numbers decide which side is stale.
+    auto existing = allocations.find(event.ptr);
+    auto pending = pendingFrees.find(event.ptr);
+    
+    if (event.isAllocation) {
+        Record record;
+        record.size = event.size;
+        record.alignment = event.alignment;
+        record.sequence = event.sequence;
+        record.tag = event.tag;
+        record.file = event.file;
+        record.line = event.line;
+        record.isArray = event.isArray;
+        record.unsized = event.unsized;
+        
+        if (pending != pendingFrees.end()) {
+            std::uint64_t freeSequence = pending->second;
+            pendingFrees.erase(pending);
+            if (freeSequence > event.sequence) {
+                // Already freed
+                removeRecord(event.ptr, record);
+                return;
+            }
+        }
+        if (existing != allocations.end()) {
+            if (existing->second.sequence > event.sequence) {
+                // A newer allocation owns the address, so this one was freed
+                removeRecord(event.ptr, record);
+                return;
+            }
+            Record stale = existing->second;
+            allocations.erase(existing);
+            removeRecord(event.ptr, stale);
+        }
+        allocations.emplace(event.ptr, record);
+        return;
+    }
+    
+    if (existing != allocations.end()) {
+        if (existing->second.sequence < event.sequence) {
+            Record record = existing->second;
+            allocations.erase(existing);
+            removeRecord(event.ptr, record);
+        }
+        return;
+    }
+    
+    // Either the allocation is still queued on another thread or this free is
+    // a filter false positive; the next allocation at this address settles it
+    std::uint64_t& sequence = pendingFrees[event.ptr];
+    sequence = std::max(sequence, event.sequence);
+}
+
+void MemoryTracker::removeRecord(void* ptr, const Record& record) const {
+    sampledFilter[filterSlot(ptr)].fetch_sub(1, std::memory_order_relaxed);
+    if (record.unsized) {
+        adjustments.totalFreed += record.size;
+        adjustments.deallocationCount++;
+    }
+}
+
+MemoryStats MemoryTracker::collectStats() const {
+    // Other threads' counters are as of their last publish; ours are current
+    if (threadRecord) {
+        publish(*threadRecord);
+    }
+    
+    MemoryStats stats;
+    std::int64_t threadPeak = 0;
+    for (const auto& slot : threadRecords) {
+        if (ThreadRecord* record = slot.load(std::memory_order_acquire)) {
+            stats.totalAllocated += record->publishedAllocated.load(std::memory_order_relaxed);
+            stats.totalFreed += record->publishedFreed.load(std::memory_order_relaxed);
+            stats.allocationCount += record->publishedAllocationCount.load(std::memory_order_relaxed);
+            stats.deallocationCount += record->publishedDeallocationCount.load(std::memory_order_relaxed);
+            threadPeak = std::max(threadPeak, record->peak.load(std::memory_order_relaxed) -
+                                                  record->peakBaseline.load(std::memory_order_relaxed));
+        }
+    }
+    
+    stats.totalAllocated -= baseline.totalAllocated;
+    stats.totalFreed += adjustments.totalFreed - baseline.totalFreed;
+    stats.allocationCount -= baseline.allocationCount;
+    stats.deallocationCount += adjustments.deallocationCount - baseline.deallocationCount;
+    stats.currentUsage = stats.totalAllocated - stats.totalFreed;
+    // Each thread's own high-water mark is exact. Memory that crosses threads
+    // only shows up in the global peak sampled on queries and drains.
+    stats.peakUsage = std::max({peakUsage, stats.currentUsage, static_cast<std::size_t>(threadPeak)});
+    return stats;
+}
+
+// ThreadCache Implementation
+std::uint32_t ThreadCache::capacityOf(std::size_t sizeClass) {
+    // Keep roughly the same number of bytes cached per class
+    std::size_t size = (sizeClass + 1) * SizeClassGranule;
+    if (size <= 128) return 64;
+    if (size <= 512) return 32;
+    return 16;
+}
+
+void* ThreadCache::allocate(MemoryPool& pool, std::size_t size) {
+    Magazine& magazine = magazines[sizeClassOf(size)];
+    if (magazine.count == 0) {
+        // Reclaim blocks other threads freed before going to the pool
+        if (remoteFrees.load(std::memory_order_relaxed)) {
+            drainRemote(pool);
+        }
+        if (magazine.count == 0) {
+            std::size_t sizeClass = sizeClassOf(size);
+            std::size_t classSize = (sizeClass + 1) * SizeClassGranule;
+            magazine.count = static_cast<std::uint32_t>(
+                pool.allocateBatch(classSize, capacityOf(sizeClass) / 2, magazine.slots, tag));
+            if (magazine.count == 0) return nullptr;
+        }
+    }
+    return magazine.slots[--magazine.count];
+}
+
+void ThreadCache::deallocate(MemoryPool& pool, void* ptr) {
+    store(pool, ptr);
+}
+
+void ThreadCache::flush(MemoryPool& pool) {
+    drainRemote(pool);
+    for (Magazine& magazine : magazines) {
+        pool.deallocateBatch(magazine.slots, magazine.count);
+        magazine.count = 0;
+    }
+}
+
+void ThreadCache::pushRemote(void* ptr) {
+    // Treiber stack threaded through the first word of each freed block
+    void* head = remoteFrees.load(std::memory_order_relaxed);
+    do {
+        *static_cast<void**>(ptr) = head;
+    } while (!remoteFrees.compare_exchange_weak(head, ptr, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void ThreadCache::drainRemote(MemoryPool& pool) {
+    void* ptr = remoteFrees.exchange(nullptr, std::memory_order_acquire);
+    while (ptr) {
+        void* next = *static_cast<void**>(ptr);
+        store(pool, ptr);
+        ptr = next;
+    }
+}
+
+void ThreadCache::store(MemoryPool& pool, void* ptr) {
+    // A block grown in place by reallocate may have outgrown the cache
+    std::size_t size = MemoryPool::getBlockSize(ptr);
+    if (size > MaxCachedSize) {
+        pool.deallocateBatch(&ptr, 1);
+        return;
+    }
+    
+    std::size_t sizeClass = sizeClassOf(size);
+    Magazine& magazine = magazines[sizeClass];
+    std::uint32_t capacity = capacityOf(sizeClass);
+    if (magazine.count == capacity) {
+        // Hand the older half back so the magazine can absorb a burst either way
+        std::uint32_t half = capacity / 2;
+        pool.deallocateBatch(magazine.slots, half);
+        std::copy(magazine.slots + half, magazine.slots + capacity, magazine.slots);
+        magazine.count -= half;
+    }
+    magazine.slots[magazine.count++] = ptr;
+}
+
 // MemoryManager Implementation
+// Returns the thread's cache to the manager when the thread exits
+struct MemoryManager::ThreadCacheHandle {
+    ThreadCache* cache = nullptr;
+    
+    ~ThreadCacheHandle() {
+        if (cache) {
+            MemoryManager::getInstance().releaseThreadCache(cache);
+        }
+    }
+};
+
+thread_local MemoryManager::ThreadCacheHandle MemoryManager::threadCacheHandle;
+
 MemoryManager& MemoryManager::getInstance() {
     static MemoryManager instance;
     return instance;
 }
 
+MemoryManager::MemoryManager() {
+    // Construct the region map first so it is destroyed after us; pools
+    // still alive at exit unregister from it in their destructors
+    MemoryRegionMap::getInstance();
+}
+
+MemoryManager::~MemoryManager() {
+    for (auto& slot : threadCaches) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
 void MemoryManager::initialize(const MemoryPoolConfig& defaultConfig) {
     std::lock_guard<std::mutex> lock(mutex);
     
     if (initialized) return;
     
-    defaultPool = std::make_unique<MemoryPool>(defaultConfig);
+    // The manager records default-pool allocations itself, with the caller's
+    // tag, so the pool must not record them a second time
+    MemoryPoolConfig poolConfig = defaultConfig;
+    poolConfig.enableTracking = false;
+    defaultPool = std::make_unique<MemoryPool>(poolConfig);
     initialized = true;
 }
 
@@ -605,11 +1790,20 @@ void MemoryManager::shutdown() {
     
     if (!initialized) return;
     
+    // Pull every cached block back into the default pool. Other threads are
+    // expected to have stopped allocating by now.
+    for (auto& slot : threadCaches) {
+        if (ThreadCache* cache = slot.load(std::memory_order_acquire)) {
+            cache->flush(*defaultPool);
+        }
+    }
+    
     // Dump final statistics
     tracker.dumpStats();
     tracker.dumpLeaks();
     
     // Clean up all allocators
+    frameArena.reset();
     stackAllocators.clear();
     pools.clear();
     defaultPool.reset();
@@ -618,7 +1812,7 @@ void MemoryManager::shutdown() {
 }
 
 void* MemoryManager::allocate(std::size_t size, std::size_t alignment, 
-                             const std::string& tag, const std::string& file, int line) {
+                             const char* tag, const char* file, int line) {
     if (!initialized) {
         // Fallback to system allocator
 #ifdef _WIN32
@@ -628,12 +1822,26 @@ void* MemoryManager::allocate(std::size_t size, std::size_t alignment,
 #endif
     }
     
+    // Small requests go through the calling thread's cache first
+    if (threadCachesEnabled && alignment <= ThreadCache::SizeClassGranule && size <= ThreadCache::MaxCachedSize && size > 0) {
+        if (ThreadCache* cache = getThreadCache()) {
+            if (void* ptr = cache->allocate(*defaultPool, size)) {
+                if (tracker.isTrackingEnabled() &&
+                    tracker.trackAllocation(ptr, MemoryPool::getBlockSize(ptr), alignment, tag, file, line)) {
+                    MemoryPool::setSampled(ptr, true);
+                }
+                return ptr;
+            }
+        }
+    }
+    
     // Try default pool first
     if (defaultPool) {
         void* ptr = defaultPool->allocate(size, alignment);
         if (ptr) {
-            if (tracker.isTrackingEnabled()) {
-                tracker.trackAllocation(ptr, size, alignment, tag, file, line);
+            if (tracker.isTrackingEnabled() &&
+                tracker.trackAllocation(ptr, MemoryPool::getBlockSize(ptr), alignment, tag, file, line)) {
+                MemoryPool::setSampled(ptr, true);
             }
             return ptr;
         }
@@ -646,7 +1854,9 @@ void* MemoryManager::allocate(std::size_t size, std::size_t alignment,
     void* ptr = std::aligned_alloc(alignment, size);
 #endif
     if (ptr && tracker.isTrackingEnabled()) {
-        tracker.trackAllocation(ptr, size, alignment, tag, file, line);
+        // Nothing knows the size of system blocks when they're freed, so
+        // they're always recorded
+        tracker.trackAllocation(ptr, size, alignment, tag, file, line, false, true);
     }
     return ptr;
 }
@@ -654,35 +1864,40 @@ void* MemoryManager::allocate(std::size_t size, std::size_t alignment,
 void MemoryManager::deallocate(void* ptr) {
     if (!ptr) return;
     
-    if (!initialized) {
-#ifdef _WIN32
-        _aligned_free(ptr);
-#else
-        std::free(ptr);
-#endif
-        return;
-    }
-    
-    // Try to deallocate from default pool
-    if (defaultPool && defaultPool->owns(ptr)) {
-        defaultPool->deallocate(ptr);
-        return;
-    }
-    
-    // Try other pools
-    for (auto& pool : pools) {
-        if (pool->owns(ptr)) {
-            pool->deallocate(ptr);
+    // Pools and stack allocators register their memory, so the owner is a
+    // single lookup rather than asking each allocator in turn
+    AllocatorBase* owner = MemoryRegionMap::getInstance().find(ptr);
+    if (owner && owner == defaultPool.get()) {
+        // The mark is cleared even with tracking off, so a reused block
+        // never reports a stale sample
+        bool sampled = MemoryPool::isSampled(ptr);
+        if (sampled) {
+            MemoryPool::setSampled(ptr, false);
+        }
+        if (tracker.isTrackingEnabled()) {
+            tracker.trackDeallocation(ptr, MemoryPool::getBlockSize(ptr), sampled);
+        }
+        
+        std::uint16_t cacheTag = MemoryPool::getCacheTag(ptr);
+        if (cacheTag != 0) {
+            // Local frees refill our own magazines, remote frees go back to the owner
+            ThreadCache* cache = threadCaches[cacheTag - 1].load(std::memory_order_acquire);
+            if (cache == threadCacheHandle.cache) {
+                cache->deallocate(*defaultPool, ptr);
+            } else {
+                cache->pushRemote(ptr);
+            }
             return;
         }
     }
+    if (owner) {
+        // Other allocators record their own frees
+        owner->deallocate(ptr);
+        return;
+    }
     
-    // Try stack allocators
-    for (auto& stack : stackAllocators) {
-        if (stack->owns(ptr)) {
-            // Stack allocators don't support individual deallocation
-            return;
-        }
+    if (initialized && tracker.isTrackingEnabled()) {
+        tracker.trackDeallocation(ptr);
     }
     
     // Fallback to system deallocator
@@ -700,35 +1915,35 @@ void* MemoryManager::reallocate(void* ptr, std::size_t newSize) {
         return nullptr;
     }
     
-    if (!initialized) {
-        return std::realloc(ptr, newSize);
-    }
-    
-    // Try to reallocate from default pool
-    if (defaultPool && defaultPool->owns(ptr)) {
-        void* newPtr = defaultPool->reallocate(ptr, newSize);
-        if (newPtr && tracker.isTrackingEnabled()) {
-            tracker.trackReallocation(ptr, newPtr, newSize);
+    if (AllocatorBase* owner = MemoryRegionMap::getInstance().find(ptr)) {
+        if (owner != defaultPool.get()) {
+            return owner->reallocate(ptr, newSize);
+        }
+        
+        std::size_t oldSize = MemoryPool::getBlockSize(ptr);
+        bool sampled = MemoryPool::isSampled(ptr);
+        void* newPtr = owner->reallocate(ptr, newSize);
+        if (newPtr) {
+            // A block resized in place keeps its header, mark included
+            MemoryPool::setSampled(newPtr, false);
+            if (tracker.isTrackingEnabled()) {
+                tracker.trackDeallocation(ptr, oldSize, sampled);
+                if (tracker.trackAllocation(newPtr, MemoryPool::getBlockSize(newPtr), 8, "realloc", "", 0)) {
+                    MemoryPool::setSampled(newPtr, true);
+                }
+            }
         }
         return newPtr;
     }
     
-    // Try other pools
-    for (auto& pool : pools) {
-        if (pool->owns(ptr)) {
-            void* newPtr = pool->reallocate(ptr, newSize);
-            if (newPtr && tracker.isTrackingEnabled()) {
-                tracker.trackReallocation(ptr, newPtr, newSize);
-            }
-            return newPtr;
-        }
+    if (!initialized) {
+        return std::realloc(ptr, newSize);
     }
     
     // Fallback to system reallocator
+    MemoryTracker::ReallocationKey oldBlock = tracker.beginReallocation(ptr);
     void* newPtr = std::realloc(ptr, newSize);
-    if (newPtr && tracker.isTrackingEnabled()) {
-        tracker.trackReallocation(ptr, newPtr, newSize);
-    }
+    tracker.trackReallocation(oldBlock, newPtr, newSize);
     return newPtr;
 }
 
@@ -772,8 +1987,113 @@ void MemoryManager::destroyStackAllocator(StackAllocator* allocator) {
     }
 }
 
+FrameArena* MemoryManager::createFrameArena(std::size_t bytesPerFrame, std::uint32_t framesInFlight) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    frameArena = std::make_unique<FrameArena>(bytesPerFrame, framesInFlight);
+    return frameArena.get();
+}
+
+void* MemoryManager::allocateFrame(std::size_t size, std::size_t alignment) {
+    // No heap fallback: nothing would ever free it
+    return frameArena ? frameArena->allocate(size, alignment) : nullptr;
+}
+
+void MemoryManager::beginFrame() {
+    if (frameArena) {
+        frameArena->beginFrame();
+    }
+}
+
 MemoryStats MemoryManager::getGlobalStats() const {
-    return tracker.getGlobalStats();
+    MemoryStats stats = tracker.getGlobalStats();
+    
+    // Address space figures come from the pools, the tracker only sees blocks
+    std::lock_guard<std::mutex> lock(mutex);
+    auto addPool = [&stats](const MemoryPool& pool) {
+        MemoryStats poolStats = pool.getStats();
+        stats.reservedBytes += poolStats.reservedBytes;
+        stats.committedBytes += poolStats.committedBytes;
+        stats.residentBytes += poolStats.residentBytes;
+    };
+    if (defaultPool) addPool(*defaultPool);
+    for (const auto& pool : pools) {
+        addPool(*pool);
+    }
+    return stats;
+}
+
+std::size_t MemoryManager::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (!initialized) return 0;
+    
+    // Blocks parked in the calling thread's cache count as allocated, so hand
+    // them back first or the pages under them could never be released
+    if (threadCacheHandle.cache) {
+        threadCacheHandle.cache->flush(*defaultPool);
+    }
+    
+    std::size_t released = defaultPool->trim();
+    for (const auto& pool : pools) {
+        released += pool->trim();
+    }
+    return released;
+}
+
+std::size_t MemoryManager::defragment(std::chrono::microseconds budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (!initialized) return 0;
+    
+    // Pools share the budget in turn; one with nothing to move returns at once
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    std::size_t moved = defaultPool->defragment(budget);
+    for (const auto& pool : pools) {
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) break;
+        moved += pool->defragment(remaining);
+    }
+    return moved;
+}
+
+ThreadCache* MemoryManager::getThreadCache() {
+    if (!threadCacheHandle.cache) {
+        threadCacheHandle.cache = adoptThreadCache();
+    }
+    return threadCacheHandle.cache;
+}
+
+ThreadCache* MemoryManager::adoptThreadCache() {
+    for (std::size_t i = 0; i < MaxThreadCaches; ++i) {
+        ThreadCache* cache = threadCaches[i].load(std::memory_order_acquire);
+        if (!cache) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cache = threadCaches[i].load(std::memory_order_relaxed);
+            if (!cache) {
+                cache = new ThreadCache(static_cast<std::uint16_t>(i + 1));
+                threadCaches[i].store(cache, std::memory_order_release);
+            }
+        }
+        
+        // Caches of exited threads are reused, along with any remote frees
+        // that arrived after their owner left
+        bool expected = false;
+        if (cache->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return cache;
+        }
+    }
+    return nullptr;
+}
+
+void MemoryManager::releaseThreadCache(ThreadCache* cache) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (initialized && defaultPool) {
+            cache->flush(*defaultPool);
+        }
+    }
+    cache->inUse.store(false, std::memory_order_release);
 }
 
 std::size_t MemoryManager::getAlignmentPadding(std::size_t size, std::size_t alignment) {
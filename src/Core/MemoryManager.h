@@ -11,6 +11,8 @@
 #include <string>
 #include <optional>
 #include <chrono>
+#include <new>
+#include <algorithm>
 
 namespace VaporFrame {
 namespace Core {
@@ -19,6 +21,8 @@ namespace Core {
 class MemoryPool;
 class MemoryTracker;
 class AllocatorBase;
+class ThreadCache;
+class FrameArena;
 
 /**
  * @brief Memory allocation statistics
@@ -32,6 +36,11 @@ struct MemoryStats {
     std::size_t deallocationCount = 0;
     std::size_t fragmentation = 0;
     
+    // Address space held, pages backed by commit charge, pages actually in RAM
+    std::size_t reservedBytes = 0;
+    std::size_t committedBytes = 0;
+    std::size_t residentBytes = 0;
+    
     void reset() {
         totalAllocated = 0;
         totalFreed = 0;
@@ -40,6 +49,9 @@ struct MemoryStats {
         allocationCount = 0;
         deallocationCount = 0;
         fragmentation = 0;
+        reservedBytes = 0;
+        committedBytes = 0;
+        residentBytes = 0;
     }
 };
 
@@ -61,6 +73,15 @@ struct AllocationInfo {
         : ptr(p), size(s), alignment(align), tag(t), file(f), line(l), isArray(arr) {}
 };
 
+/**
+ * @brief Page size backing a memory pool
+ */
+enum class PoolPageMode {
+    Default,     // Regular OS pages
+    Transparent, // Ask the kernel to back the pool with huge pages (MADV_HUGEPAGE)
+    Explicit     // Reserved huge pages (MAP_HUGETLB), transparent if none are free
+};
+
 /**
  * @brief Memory pool configuration
  */
@@ -72,6 +93,12 @@ struct MemoryPoolConfig {
     bool enableTracking = true;
     std::string name = "DefaultPool";
     
+    // Huge pages cut TLB misses when large pools are walked. Both settings are
+    // hints: the pool falls back to regular pages and first-touch placement
+    // when the OS can't honour them.
+    PoolPageMode pageMode = PoolPageMode::Default;
+    int numaNode = -1; // Preferred NUMA node, -1 places pages on first touch
+    
     MemoryPoolConfig() = default;
     MemoryPoolConfig(std::size_t init, std::size_t max, std::size_t block, 
                      std::size_t align = 16, bool track = true, const std::string& n = "DefaultPool")
@@ -98,11 +125,104 @@ public:
     virtual const std::string& getName() const = 0;
 };
 
+/**
+ * @brief Page-indexed radix map from addresses to the allocator that owns them
+ *
+ * Allocators register their memory in 64KB granules, so mapping any pointer to
+ * its owner is two array loads instead of asking every allocator in turn.
+ * Registered ranges must be granule aligned and never share a granule.
+ */
+class MemoryRegionMap {
+public:
+    static constexpr std::size_t GranuleLog2 = 16;
+    static constexpr std::size_t Granule = std::size_t(1) << GranuleLog2;
+    
+    static MemoryRegionMap& getInstance();
+    
+    void insert(const void* base, std::size_t size, AllocatorBase* allocator);
+    void erase(const void* base, std::size_t size);
+    
+    AllocatorBase* find(const void* ptr) const {
+        std::uintptr_t key = reinterpret_cast<std::uintptr_t>(ptr) >> GranuleLog2;
+        if (key >> (RootBits + LeafBits)) return nullptr;
+        
+        Leaf* leaf = root[key >> LeafBits].load(std::memory_order_acquire);
+        return leaf ? leaf->owners[key & LeafMask].load(std::memory_order_acquire) : nullptr;
+    }
+    
+    // Granule aligned memory straight from the OS, suitable for insert()
+    static void* allocatePages(std::size_t size);
+    static void freePages(void* ptr, std::size_t size);
+    
+    // Reserve address space only; commit ranges of it before touching them.
+    // Reservations are released with freePages().
+    static void* reservePages(std::size_t size, std::size_t alignment = Granule);
+    static bool commitPages(void* ptr, std::size_t size);
+    static void decommitPages(void* ptr, std::size_t size);
+    // Drop the contents of committed pages so the OS can reclaim them; they
+    // read back as zero (or garbage on Windows) and stay usable
+    static void discardPages(void* ptr, std::size_t size);
+    static std::size_t residentBytes(const void* ptr, std::size_t size);
+    static std::size_t pageSize();
+    
+    // Huge page and NUMA placement for committed ranges. Each returns false
+    // when the OS can't do it, leaving the pages as they were.
+    static std::size_t hugePageSize();
+    static bool commitHugePages(void* ptr, std::size_t size);
+    static bool adviseHugePages(void* ptr, std::size_t size);
+    static bool bindPages(void* ptr, std::size_t size, int node);
+    
+private:
+    // 16 + 16 + 16 bits covers a 48-bit virtual address space
+    static constexpr std::size_t LeafBits = 16;
+    static constexpr std::size_t RootBits = 16;
+    static constexpr std::uintptr_t LeafMask = (std::uintptr_t(1) << LeafBits) - 1;
+    
+    struct Leaf {
+        std::atomic<AllocatorBase*> owners[std::size_t(1) << LeafBits];
+    };
+    
+    MemoryRegionMap() = default;
+    ~MemoryRegionMap();
+    MemoryRegionMap(const MemoryRegionMap&) = delete;
+    MemoryRegionMap& operator=(const MemoryRegionMap&) = delete;
+    
+    void assign(const void* base, std::size_t size, AllocatorBase* allocator);
+    
+    std::atomic<Leaf*> root[std::size_t(1) << RootBits];
+    std::mutex mutex;
+};
+
 /**
  * @brief Memory pool for efficient small allocations
+ *
+ * Free blocks are kept in two-level segregated fit (TLSF) bins: the first level
+ * splits sizes by power of two, the second level splits each power of two into
+ * linear steps. A pair of bitmaps makes finding a fitting bin O(1), and block
+ * headers live in-band so freeing and coalescing never search.
+ *
+ * The pool reserves maxSize bytes of address space up front and commits pages
+ * as it grows, so it stays one contiguous heap. trim() returns the pages under
+ * free blocks to the OS without giving up the reservation.
+ *
+ * Blocks allocated through allocateHandle() are relocatable: defragment()
+ * slides them down over the holes in front of them, so long-lived data that
+ * outlives many loads and unloads doesn't strand memory between live blocks.
  */
 class MemoryPool : public AllocatorBase {
 public:
+    static constexpr std::uint32_t InvalidHandleIndex = 0xFFFFFFFFu;
+    
+    // Stable name for a relocatable block, resolved through the pool's handle table
+    struct Handle {
+        std::uint32_t index = InvalidHandleIndex;
+        std::uint32_t generation = 0;
+        
+        bool isValid() const { return index != InvalidHandleIndex; }
+        bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+    
     explicit MemoryPool(const MemoryPoolConfig& config = MemoryPoolConfig{});
     ~MemoryPool();
     
@@ -118,30 +238,137 @@ public:
     
     // Pool-specific methods
     bool expand(std::size_t additionalSize);
+    // Compacts every relocatable block, then trims the pages freed up
     void defragment();
+    // Compacts until the budget is spent and picks up where it stopped on the
+    // next call. Returns the bytes moved, 0 once there is nothing left to do.
+    std::size_t defragment(std::chrono::microseconds budget);
+    // Releases idle pages: decommits the free tail and discards whole pages
+    // inside other free blocks. Returns the bytes handed back.
+    std::size_t trim();
+    // Page mode actually in effect, Explicit degrades to Transparent or Default
+    PoolPageMode getPageMode() const { std::lock_guard<std::mutex> lock(mutex); return pageMode; }
     std::size_t getFragmentation() const;
     
+    // Relocatable allocations. Pointers from resolve() are only good until the
+    // next defragment() call, and the blocks are 16-byte aligned. Free them with
+    // deallocateHandle(), never deallocate().
+    Handle allocateHandle(std::size_t size);
+    void deallocateHandle(Handle handle);
+    void* resolve(Handle handle) const;
+    
+    // Batch interface for thread caches: one lock round-trip for many blocks.
+    // Blocks are stamped with cacheTag so frees can find their owning cache.
+    std::size_t allocateBatch(std::size_t size, std::size_t count, void** out, std::uint16_t cacheTag);
+    void deallocateBatch(void* const* ptrs, std::size_t count);
+    
+    // Header reads for live blocks returned by this pool, no locking
+    static std::uint16_t getCacheTag(const void* ptr) { return blockOf(const_cast<void*>(ptr))->cacheTag & ~CacheTagSampled; }
+    static std::size_t getBlockSize(const void* ptr) { return blockSize(blockOf(const_cast<void*>(ptr))); }
+    
+    // Whether the tracker recorded a live block, so its free only consults the
+    // tracker when it did. Kept in the cache tag's top bit, a field only the
+    // block's holder writes while it is live.
+    static bool isSampled(const void* ptr) { return blockOf(const_cast<void*>(ptr))->cacheTag & CacheTagSampled; }
+    static void setSampled(void* ptr, bool sampled) {
+        Block* block = blockOf(ptr);
+        block->cacheTag = static_cast<std::uint16_t>(sampled ? block->cacheTag | CacheTagSampled
+                                                             : block->cacheTag & ~CacheTagSampled);
+    }
+    
 private:
+    // Payloads are handed out in 16-byte granules
+    static constexpr std::size_t GranuleLog2 = 4;
+    static constexpr std::size_t Granule = std::size_t(1) << GranuleLog2;
+    // Each power of two is split into 16 second-level bins
+    static constexpr std::size_t SecondLevelLog2 = 4;
+    static constexpr std::size_t SecondLevelCount = std::size_t(1) << SecondLevelLog2;
+    // Sizes below SmallBlockSize all map to first level 0 in linear 16-byte steps
+    static constexpr std::size_t FirstLevelShift = SecondLevelLog2 + GranuleLog2;
+    static constexpr std::size_t SmallBlockSize = std::size_t(1) << FirstLevelShift;
+    static constexpr std::size_t FirstLevelCount = 32;
+    
+    static constexpr std::uint16_t BlockFree = 1u << 0;
+    static constexpr std::uint16_t BlockSentinel = 1u << 1;
+    static constexpr std::uint16_t BlockMovable = 1u << 2; // Owned by a handle, defragment() may move it
+    static constexpr std::uint16_t CacheTagSampled = 1u << 15;
+    
+    // In-band header stored directly in front of every payload
     struct Block {
-        void* data = nullptr;
-        std::size_t size = 0;
-        bool used = false;
+        Block* prevPhysical = nullptr; // Previous block in the same region, nullptr at region start
+        std::uint32_t granules = 0;    // Payload size in granules
+        std::uint16_t flags = 0;
+        std::uint16_t cacheTag = 0;    // Thread cache that handed the block out, 0 if none
+    };
+    static_assert(sizeof(Block) == 16, "Block header must keep payloads 16-byte aligned");
+    
+    // Free-list links, stored in the payload of free blocks
+    struct FreeLinks {
         Block* next = nullptr;
         Block* prev = nullptr;
     };
     
+    static constexpr std::size_t MinBlockSize = sizeof(Block) + sizeof(FreeLinks);
+    
+    // Relocatable blocks start with their handle index so a block found while
+    // compacting can update its table entry. Read as a block header it looks
+    // like a sentinel, so deallocate() on a resolved pointer is ignored.
+    struct HandlePrefix {
+        std::uint32_t index = InvalidHandleIndex;
+        std::uint32_t reserved[2] = {};
+        std::uint16_t flags = BlockSentinel;
+        std::uint16_t padding = 0;
+    };
+    static_assert(sizeof(HandlePrefix) == Granule, "Handle prefix must keep payloads 16-byte aligned");
+    static_assert(offsetof(HandlePrefix, flags) == offsetof(Block, flags), "Handle prefix must mirror the block header flags");
+    
+    struct HandleSlot {
+        Block* block = nullptr;
+        std::uint32_t generation = 0; // Odd while the handle is live
+        std::uint32_t nextFree = InvalidHandleIndex;
+    };
+    
     MemoryPoolConfig config;
-    std::vector<void*> pools;
-    std::vector<Block*> freeBlocks;
-    std::unordered_map<void*, Block*> blockMap;
+    char* base = nullptr;
+    std::size_t reservedSize = 0;
+    std::size_t committedSize = 0;
+    std::size_t initialCommit = 0;
+    std::size_t commitStep = MemoryRegionMap::Granule;
+    PoolPageMode pageMode = PoolPageMode::Default;
+    std::uint32_t firstLevelBitmap = 0;
+    std::uint32_t secondLevelBitmap[FirstLevelCount] = {};
+    Block* freeLists[FirstLevelCount][SecondLevelCount] = {};
     MemoryStats stats;
     mutable std::mutex mutex;
     
-    Block* findFreeBlock(std::size_t size, std::size_t alignment);
+    std::vector<HandleSlot> handleSlots;
+    std::uint32_t freeHandle = InvalidHandleIndex;
+    std::size_t liveHandles = 0;
+    Block* compactCursor = nullptr; // Where an unfinished compaction pass resumes
+    bool compactPending = false;    // Set by frees, cleared when a pass starts
+    
+    static char* payloadOf(Block* block) { return reinterpret_cast<char*>(block) + sizeof(Block); }
+    static Block* blockOf(void* payload) { return reinterpret_cast<Block*>(static_cast<char*>(payload) - sizeof(Block)); }
+    static std::size_t blockSize(const Block* block) { return std::size_t(block->granules) << GranuleLog2; }
+    static Block* nextPhysical(Block* block) { return reinterpret_cast<Block*>(payloadOf(block) + blockSize(block)); }
+    static FreeLinks* linksOf(Block* block) { return reinterpret_cast<FreeLinks*>(payloadOf(block)); }
+    static void mapping(std::size_t size, std::size_t& firstLevel, std::size_t& secondLevel);
+    
+    void insertFreeBlock(Block* block);
+    void removeFreeBlock(Block* block);
+    Block* findFreeBlock(std::size_t size);
     void splitBlock(Block* block, std::size_t size);
-    void mergeAdjacentBlocks(Block* block);
-    void* allocateFromSystem(std::size_t size);
-    void deallocateFromSystem(void* ptr);
+    Block* mergeAdjacentBlocks(Block* block);
+    Block* sentinel() const { return reinterpret_cast<Block*>(base + committedSize - sizeof(Block)); }
+    void initializeBlocks();
+    bool commitRange(char* ptr, std::size_t size);
+    bool containsAddress(const void* ptr) const;
+    void* allocateBlock(std::size_t size, std::size_t alignment);
+    void releaseBlock(Block* block);
+    std::size_t trimLocked();
+    std::size_t compactLocked(std::chrono::steady_clock::time_point deadline);
+    Block* slideDown(Block* block, Block* hole);
+    void releaseHandles();
 };
 
 /**
@@ -175,24 +402,412 @@ private:
     mutable std::mutex mutex;
 };
 
+/**
+ * @brief Frame-scoped linear allocator, buffered across frames in flight
+ *
+ * Memory handed out during a frame stays valid until its buffer comes around
+ * again framesInFlight frames later, so per-frame temporaries can outlive the
+ * CPU side of the frame without being freed individually. Each thread bumps
+ * through its own chunk of the current buffer, so allocation takes no lock.
+ */
+class FrameArena : public AllocatorBase {
+public:
+    // Bytes a thread claims from the shared buffer at a time
+    static constexpr std::size_t ChunkSize = 64 * 1024;
+
+    FrameArena(std::size_t frameSize, std::uint32_t frameCount);
+    ~FrameArena();
+
+    // AllocatorBase interface
+    void* allocate(std::size_t size, std::size_t alignment = 8) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, std::size_t newSize) override;
+    std::size_t getSize(void* ptr) const override;
+    bool owns(void* ptr) const override;
+    MemoryStats getStats() const override;
+    void reset() override;
+    const std::string& getName() const override { return name; }
+
+    // Recycles the oldest buffer for the next frame. Call once per frame from
+    // the thread driving the main loop; other threads may keep allocating.
+    void beginFrame();
+    std::uint64_t getFrameNumber() const { return frameNumber.load(std::memory_order_acquire); }
+    std::uint32_t getFramesInFlight() const { return framesInFlight; }
+    std::size_t getBytesPerFrame() const { return bytesPerFrame; }
+
+private:
+    struct FrameBuffer {
+        char* memory = nullptr;
+        std::atomic<std::size_t> offset{0};
+        std::vector<void*> overflow; // Heap blocks used once the buffer ran out
+    };
+
+    char* claim(FrameBuffer& buffer, std::size_t size, std::size_t alignment);
+    void* allocateOverflow(FrameBuffer& buffer, std::size_t size, std::size_t alignment);
+    void recycle(FrameBuffer& buffer);
+
+    std::size_t bytesPerFrame;
+    std::uint32_t framesInFlight;
+    std::uint64_t id;
+    void* memory = nullptr;
+    std::size_t totalSize = 0;
+    std::unique_ptr<FrameBuffer[]> frames;
+    std::atomic<std::uint64_t> frameNumber{0};
+    std::size_t peakUsage = 0;
+    std::size_t overflowCount = 0;
+    std::string name = "FrameArena";
+    mutable std::mutex mutex;
+};
+
+/**
+ * @brief Typed pool of fixed-size objects
+ *
+ * Objects live in chunks that never move, so pointers stay valid until the
+ * object is destroyed. Free slots are chained through their own storage and
+ * each slot's generation is bumped on create and destroy, which lets handles
+ * detect reuse without a per-object header. Chunks are aligned to their size,
+ * so a pointer finds its chunk with a mask. Not thread safe.
+ */
+template<typename T>
+class ObjectPool {
+public:
+    static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+    struct Handle {
+        std::uint32_t index = InvalidIndex;
+        std::uint32_t generation = 0;
+
+        bool isValid() const { return index != InvalidIndex; }
+        bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    ObjectPool() = default;
+    ~ObjectPool() {
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            for (std::uint32_t slot = 0; slot < SlotsPerChunk; ++slot) {
+                // Odd generations mark live slots
+                if (chunks[i]->generations[slot] & 1u) {
+                    reinterpret_cast<T*>(chunks[i]->slots[slot].storage)->~T();
+                }
+            }
+            ::operator delete(chunks[i], std::align_val_t(ChunkBytes));
+        }
+    }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template<typename... Args>
+    Handle create(Args&&... args) {
+        void* storage = allocateSlot();
+        try {
+            ::new (storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocateSlot(storage);
+            throw;
+        }
+        return getHandle(static_cast<T*>(storage));
+    }
+
+    void destroy(Handle handle) {
+        if (T* object = get(handle)) {
+            object->~T();
+            deallocateSlot(object);
+        }
+    }
+
+    T* get(Handle handle) const {
+        if (handle.index >= chunks.size() * SlotsPerChunk) return nullptr;
+        Chunk* chunk = chunks[handle.index / SlotsPerChunk];
+        std::uint32_t slot = handle.index % SlotsPerChunk;
+        // Free slots have even generations, so only an odd match is a live object
+        if ((handle.generation & 1u) == 0 || chunk->generations[slot] != handle.generation) return nullptr;
+        return reinterpret_cast<T*>(chunk->slots[slot].storage);
+    }
+
+    bool isAlive(Handle handle) const { return get(handle) != nullptr; }
+
+    // Handle for a live object owned by this pool
+    Handle getHandle(const T* object) const {
+        Chunk* chunk = chunkOf(object);
+        std::uint32_t slot = slotOf(chunk, object);
+        return Handle{chunk->index * SlotsPerChunk + slot, chunk->generations[slot]};
+    }
+
+    // Uninitialized storage for one T, for class-level operator new/delete.
+    // The caller constructs and destroys the object itself.
+    void* allocateSlot() {
+        if (freeHead == InvalidIndex) {
+            addChunk();
+        }
+        Chunk* chunk = chunks[freeHead / SlotsPerChunk];
+        std::uint32_t slot = freeHead % SlotsPerChunk;
+        freeHead = chunk->slots[slot].nextFree;
+        chunk->generations[slot]++;
+        liveCount++;
+        return chunk->slots[slot].storage;
+    }
+
+    void deallocateSlot(void* ptr) {
+        Chunk* chunk = chunkOf(ptr);
+        std::uint32_t slot = slotOf(chunk, ptr);
+        chunk->generations[slot]++;
+        chunk->slots[slot].nextFree = freeHead;
+        freeHead = chunk->index * SlotsPerChunk + slot;
+        liveCount--;
+    }
+
+    void reserve(std::size_t count) {
+        while (capacity() < count) {
+            addChunk();
+        }
+    }
+
+    std::size_t size() const { return liveCount; }
+    std::size_t capacity() const { return chunks.size() * SlotsPerChunk; }
+
+private:
+    union Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::uint32_t nextFree;
+    };
+
+    // At least 64KB, and big enough for a few dozen objects of large types
+    static constexpr std::size_t chunkBytesFor(std::size_t slotSize) {
+        std::size_t bytes = 64 * 1024;
+        while (bytes < 32 * (slotSize + sizeof(std::uint32_t)) + 256) {
+            bytes *= 2;
+        }
+        return bytes;
+    }
+
+    static constexpr std::size_t ChunkBytes = chunkBytesFor(sizeof(Slot));
+    static constexpr std::uint32_t SlotsPerChunk = static_cast<std::uint32_t>(
+        (ChunkBytes - sizeof(std::uint32_t) - alignof(Slot)) / (sizeof(Slot) + sizeof(std::uint32_t)));
+
+    // Slots come first so slot 0 sits at the chunk's own address. GCC then
+    // can't prove a pooled object is at an offset into a heap block and
+    // warns with -Wfree-nonheap-object when one is deleted.
+    struct Chunk {
+        Slot slots[SlotsPerChunk];
+        std::uint32_t generations[SlotsPerChunk];
+        std::uint32_t index;
+    };
+    static_assert(sizeof(Chunk) <= ChunkBytes, "Chunk must fit its alignment");
+
+    static Chunk* chunkOf(const void* ptr) {
+        return reinterpret_cast<Chunk*>(reinterpret_cast<std::uintptr_t>(ptr) & ~std::uintptr_t(ChunkBytes - 1));
+    }
+    static std::uint32_t slotOf(const Chunk* chunk, const void* ptr) {
+        return static_cast<std::uint32_t>(
+            (static_cast<const unsigned char*>(ptr) - chunk->slots[0].storage) / sizeof(Slot));
+    }
+
+    void addChunk() {
+        Chunk* chunk = static_cast<Chunk*>(::operator new(ChunkBytes, std::align_val_t(ChunkBytes)));
+        chunk->index = static_cast<std::uint32_t>(chunks.size());
+        // Thread the new slots onto the free list so the lowest address goes first
+        std::uint32_t base = chunk->index * SlotsPerChunk;
+        for (std::uint32_t slot = SlotsPerChunk; slot-- > 0;) {
+            chunk->generations[slot] = 0;
+            chunk->slots[slot].nextFree = freeHead;
+            freeHead = base + slot;
+        }
+        chunks.push_back(chunk);
+    }
+
+    std::vector<Chunk*> chunks;
+    std::uint32_t freeHead = InvalidIndex;
+    std::size_t liveCount = 0;
+};
+
+/**
+ * @brief Opt-in base that routes new/delete of T through a shared ObjectPool
+ *
+ * Derive as `class Foo : public PooledObject<Foo>` and plain new/delete and
+ * std::unique_ptr<Foo> keep working. Subclasses of a different size that
+ * don't opt in themselves fall back to the global heap.
+ */
+template<typename T>
+class PooledObject {
+public:
+    static void* operator new(std::size_t size) {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        std::lock_guard<std::mutex> lock(getMutex());
+        return getPool().allocateSlot();
+    }
+
+    static void operator delete(void* ptr, std::size_t size) {
+        if (!ptr) return;
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(getMutex());
+        getPool().deallocateSlot(ptr);
+    }
+
+    // Lock getMutex() while inspecting the pool from more than one thread
+    static ObjectPool<T>& getPool() {
+        // Never destroyed, objects may be deleted during static destruction
+        static ObjectPool<T>* pool = new ObjectPool<T>();
+        return *pool;
+    }
+
+    static std::mutex& getMutex() {
+        static std::mutex* mutex = new std::mutex();
+        return *mutex;
+    }
+};
+
+/**
+ * @brief Per-thread magazine cache in front of the default pool
+ *
+ * Small allocations are served from per-size-class magazines owned by one
+ * thread, refilled from and flushed to the pool in batches. Blocks remember
+ * which cache handed them out; frees from other threads go onto that cache's
+ * lock-free return queue and are reclaimed by the owner on its next miss.
+ */
+class ThreadCache {
+public:
+    static constexpr std::size_t MaxCachedSize = 1024;
+    static constexpr std::size_t SizeClassGranule = 16;
+    static constexpr std::size_t SizeClassCount = MaxCachedSize / SizeClassGranule;
+    static constexpr std::size_t MaxMagazineSize = 64;
+    
+    explicit ThreadCache(std::uint16_t tag) : tag(tag) {}
+    
+    // Owner thread only
+    void* allocate(MemoryPool& pool, std::size_t size);
+    void deallocate(MemoryPool& pool, void* ptr);
+    void flush(MemoryPool& pool);
+    
+    // Any thread
+    void pushRemote(void* ptr);
+    std::uint16_t getTag() const { return tag; }
+    
+private:
+    struct Magazine {
+        void* slots[MaxMagazineSize];
+        std::uint32_t count = 0;
+    };
+    
+    static std::size_t sizeClassOf(std::size_t size) { return (size + SizeClassGranule - 1) / SizeClassGranule - 1; }
+    static std::uint32_t capacityOf(std::size_t sizeClass);
+    
+    void drainRemote(MemoryPool& pool);
+    void store(MemoryPool& pool, void* ptr);
+    
+    Magazine magazines[SizeClassCount];
+    std::atomic<void*> remoteFrees{nullptr};
+    std::atomic<bool> inUse{false};
+    std::uint16_t tag;
+    
+    friend class MemoryManager;
+};
+
 /**
  * @brief Memory tracker for debugging and profiling
+ *
+ * Byte and call counters are kept per thread in plain fields and published
+ * in batches, so they are exact once a thread publishes: every PublishBytes
+ * or PublishCount allocations, when it exits, and when it queries the
+ * tracker itself. Individual allocation records are sampled, either 1 in N
+ * calls or one per so many bytes, with tags and file names interned to
+ * integer ids. Sampled events go into a per-thread ring buffer and are folded
+ * into the live-allocation table only when a ring fills up or someone asks
+ * for the records, so the common path never takes a lock.
  */
 class MemoryTracker {
 public:
     static MemoryTracker& getInstance();
     
-    void trackAllocation(void* ptr, std::size_t size, std::size_t alignment, 
-                        const std::string& tag, const std::string& file, int line, bool isArray = false);
-    void trackDeallocation(void* ptr);
-    void trackReallocation(void* oldPtr, void* newPtr, std::size_t newSize);
+    // Sizes must match between an allocation and its free. Memory whose size
+    // the caller can't report when freeing is passed with alwaysRecord set and
+    // freed with size 0, so the size is looked up from the record instead.
+    //
+    // Inline so that an unsampled allocation costs a few adds and a single
+    // countdown branch; sampling and publishing happen when it runs out.
+    // Returns whether the allocation was recorded.
+    bool trackAllocation(void* ptr, std::size_t size, std::size_t alignment, 
+                        const char* tag, const char* file, int line, bool isArray = false, bool alwaysRecord = false) {
+        if (!ptr || !trackingEnabled.load(std::memory_order_relaxed)) return false;
+        ThreadRecord* record = threadRecord ? threadRecord : adoptThreadRecord();
+        if (!record) return false;
+        
+        record->allocated += size;
+        record->allocationCount++;
+        record->batchPeak = std::max(record->batchPeak, static_cast<std::int64_t>(record->allocated - record->freed));
+        record->countdown -= record->countBytes ? static_cast<std::int64_t>(size) : 1;
+        if (record->countdown > 0 && !alwaysRecord) return false;
+        return recordAllocation(*record, ptr, size, alignment, tag, file, line, isArray, alwaysRecord);
+    }
+    
+    void trackDeallocation(void* ptr, std::size_t size = 0) {
+        if (!ptr || !trackingEnabled.load(std::memory_order_relaxed)) return;
+        ThreadRecord* record = threadRecord ? threadRecord : adoptThreadRecord();
+        if (!record) return;
+        
+        // Unsized frees are counted once their record turns up
+        if (size != 0) {
+            record->freed += size;
+            record->deallocationCount++;
+        }
+        // Most frees are of unsampled memory and stop here
+        if (sampledFilter[filterSlot(ptr)].load(std::memory_order_relaxed) == 0) return;
+        recordDeallocation(*record, ptr, size);
+    }
+    
+    // For callers that kept trackAllocation's result, which skips the filter
+    void trackDeallocation(void* ptr, std::size_t size, bool sampled) {
+        if (!ptr || !trackingEnabled.load(std::memory_order_relaxed)) return;
+        ThreadRecord* record = threadRecord ? threadRecord : adoptThreadRecord();
+        if (!record) return;
+        
+        record->freed += size;
+        record->deallocationCount++;
+        if (sampled) {
+            recordDeallocation(*record, ptr, size);
+        }
+    }
+    
+    void trackReallocation(void* oldPtr, std::size_t oldSize, void* newPtr, std::size_t newSize);
+    
+    // The system realloc frees the old block before it returns, so another
+    // thread can be handed that address and record it first. Take a key
+    // before the call and pass it in after; the free is ordered at the key.
+    struct ReallocationKey {
+        std::uintptr_t address = 0;
+        std::uint64_t sequence = 0;
+    };
+    ReallocationKey beginReallocation(const void* ptr) {
+        return {reinterpret_cast<std::uintptr_t>(ptr), nextSequence.fetch_add(1, std::memory_order_relaxed)};
+    }
+    // For unsized memory recorded with alwaysRecord
+    void trackReallocation(const ReallocationKey& oldBlock, void* newPtr, std::size_t newSize);
     
     MemoryStats getGlobalStats() const;
     std::vector<AllocationInfo> getActiveAllocations() const;
     std::vector<AllocationInfo> getLeakedAllocations() const;
     
     void enableTracking(bool enable) { trackingEnabled = enable; }
-    bool isTrackingEnabled() const { return trackingEnabled; }
+    bool isTrackingEnabled() const { return trackingEnabled.load(std::memory_order_relaxed); }
+    
+    // Record roughly 1 in oneInN allocations; 1 records every allocation.
+    // Threads pick up a new setting by their next publish.
+    void setSampleRate(std::uint32_t oneInN) {
+        sampleRate = oneInN > 0 ? oneInN : 1;
+        configVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::uint32_t getSampleRate() const { return sampleRate; }
+    // Record roughly one allocation per bytes allocated; overrides the rate when non-zero
+    void setSampleInterval(std::size_t bytes) {
+        sampleInterval = bytes;
+        configVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::size_t getSampleInterval() const { return sampleInterval; }
     
     void reset();
     void dumpStats() const;
@@ -200,14 +815,130 @@ public:
     
 private:
     MemoryTracker() = default;
-    ~MemoryTracker() = default;
+    ~MemoryTracker();
     MemoryTracker(const MemoryTracker&) = delete;
     MemoryTracker& operator=(const MemoryTracker&) = delete;
     
-    std::unordered_map<void*, AllocationInfo> allocations;
-    MemoryStats globalStats;
-    mutable std::mutex mutex;
+    static constexpr std::size_t MaxThreadRecords = 256;
+    static constexpr std::size_t RingCapacity = 1024;
+    static constexpr std::size_t InternCacheSize = 16;
+    static constexpr std::size_t FilterLog2 = 14;
+    // Counters are published at least this often, in the sampling countdown's units
+    static constexpr std::int64_t PublishBytes = 64 * 1024;
+    static constexpr std::int64_t PublishCount = 256;
+    
+    // Sampled allocation or free, strings already interned
+    struct Event {
+        void* ptr = nullptr;
+        std::size_t size = 0;
+        std::size_t alignment = 0;
+        std::uint64_t sequence = 0;
+        std::uint32_t tag = 0;
+        std::uint32_t file = 0;
+        std::int32_t line = 0;
+        bool isAllocation = false;
+        bool isArray = false;
+        bool unsized = false; // Free will not report a size
+    };
+    
+    struct Record {
+        std::size_t size = 0;
+        std::size_t alignment = 0;
+        std::uint64_t sequence = 0;
+        std::uint32_t tag = 0;
+        std::uint32_t file = 0;
+        std::int32_t line = 0;
+        bool isArray = false;
+        bool unsized = false;
+    };
+    
+    struct InternCacheEntry {
+        const char* key = nullptr;
+        const std::string* name = nullptr;
+        std::uint32_t id = 0;
+    };
+    
+    // Owned by one thread at a time. The plain fields are the owner's; it
+    // copies its running totals to the published ones in batches. The ring
+    // is single-producer, drained by whoever holds the tracker mutex.
+    struct ThreadRecord {
+        std::size_t allocated = 0;
+        std::size_t freed = 0;
+        std::size_t allocationCount = 0;
+        std::size_t deallocationCount = 0;
+        // High-water mark of allocated - freed since the last publish. Frees
+        // of other threads' memory can take the difference below zero.
+        std::int64_t batchPeak = 0;
+        // Bytes or calls left before the next publish, and its starting value
+        std::int64_t countdown = 0;
+        std::int64_t armed = 0;
+        // What is left of the sampling gap once the countdown runs out
+        std::int64_t untilSample = 0;
+        bool countBytes = false;
+        std::uint32_t configVersion = 0;
+        std::uint64_t random = 0x9E3779B97F4A7C15ull;
+        InternCacheEntry internCache[InternCacheSize];
+        
+        alignas(64) std::atomic<std::size_t> publishedAllocated{0};
+        std::atomic<std::size_t> publishedFreed{0};
+        std::atomic<std::size_t> publishedAllocationCount{0};
+        std::atomic<std::size_t> publishedDeallocationCount{0};
+        // Published high-water mark, and live bytes at the last reset
+        std::atomic<std::int64_t> peak{0};
+        std::atomic<std::int64_t> peakBaseline{0};
+        std::atomic<std::uint64_t> head{0};
+        std::atomic<std::uint64_t> tail{0};
+        Event events[RingCapacity];
+        std::atomic<bool> inUse{false};
+    };
+    
+    struct ThreadRecordHandle;
+    static thread_local ThreadRecordHandle threadRecordHandle;
+    // Plain copy of the handle's pointer; trivially destructible thread_locals
+    // skip the lazy-init check on every access
+    static thread_local ThreadRecord* threadRecord;
+    
+    ThreadRecord* getThreadRecord() { return threadRecord ? threadRecord : adoptThreadRecord(); }
+    ThreadRecord* adoptThreadRecord();
+    void releaseThreadRecord(ThreadRecord* record);
+    bool recordAllocation(ThreadRecord& record, void* ptr, std::size_t size, std::size_t alignment,
+                          const char* tag, const char* file, int line, bool isArray, bool alwaysRecord);
+    void recordDeallocation(ThreadRecord& record, void* ptr, std::size_t size);
+    bool advanceCountdown(ThreadRecord& record);
+    static void publish(ThreadRecord& record);
+    void pushEvent(ThreadRecord& record, const Event& event);
+    std::uint32_t intern(ThreadRecord& record, const char* str);
+    void drain(ThreadRecord& record) const;
+    void drainAll() const;
+    void apply(const Event& event) const;
+    void removeRecord(void* ptr, const Record& record) const;
+    MemoryStats collectStats() const;
+    
+    static std::size_t filterSlot(const void* ptr) {
+        return static_cast<std::size_t>((reinterpret_cast<std::uintptr_t>(ptr) >> 4) * 0x9E3779B97F4A7C15ull >> (64 - FilterLog2));
+    }
+    
+    std::atomic<ThreadRecord*> threadRecords[MaxThreadRecords] = {};
+    // Counts sampled pointers per hash slot so frees of unsampled memory skip the ring
+    mutable std::atomic<std::uint16_t> sampledFilter[std::size_t(1) << FilterLog2] = {};
+    std::atomic<std::uint64_t> nextSequence{1};
+    std::atomic<std::uint32_t> sampleRate{1};
+    std::atomic<std::size_t> sampleInterval{0};
+    std::atomic<std::uint32_t> configVersion{0};
     std::atomic<bool> trackingEnabled{true};
+    
+    // Interned strings, id 0 is the empty string
+    std::unordered_map<std::string, std::uint32_t> internIds;
+    std::vector<const std::string*> internNames;
+    mutable std::mutex internMutex;
+    
+    // Folded-in state, updated lazily from const queries
+    mutable std::unordered_map<void*, Record> allocations;
+    mutable std::unordered_map<void*, std::uint64_t> pendingFrees; // Frees drained before their allocation
+    mutable MemoryStats adjustments; // Unsized frees resolved while draining
+    mutable MemoryStats baseline;    // Counter values at the last reset
+    mutable std::size_t peakUsage = 0;
+    mutable std::mutex mutex;
 };
 
 /**
@@ -223,7 +954,7 @@ public:
     
     // Global allocation methods
     void* allocate(std::size_t size, std::size_t alignment = 8, 
-                  const std::string& tag = "", const std::string& file = "", int line = 0);
+                  const char* tag = "", const char* file = "", int line = 0);
     void deallocate(void* ptr);
     void* reallocate(void* ptr, std::size_t newSize);
     
@@ -235,33 +966,60 @@ public:
     // Stack allocator management
     StackAllocator* createStackAllocator(std::size_t size);
     void destroyStackAllocator(StackAllocator* allocator);
+
+    // Frame-scoped temporaries, recycled by beginFrame()
+    FrameArena* createFrameArena(std::size_t frameSize, std::uint32_t frameCount);
+    FrameArena* getFrameArena() const { return frameArena.get(); }
+    void* allocateFrame(std::size_t size, std::size_t alignment = 8);
+    void beginFrame();
+
+    // Returns idle pool pages to the OS, reporting how many bytes were released
+    std::size_t trim();
+    // Compacts relocatable pool blocks for at most budget, returns the bytes moved
+    std::size_t defragment(std::chrono::microseconds budget);
     
     // Statistics and debugging
     MemoryStats getGlobalStats() const;
     MemoryTracker& getTracker() { return tracker; }
     
+    // Per-thread caches for small default-pool allocations
+    void enableThreadCaches(bool enable) { threadCachesEnabled = enable; }
+    bool areThreadCachesEnabled() const { return threadCachesEnabled; }
+    
     // Memory utilities
     std::size_t getAlignmentPadding(std::size_t size, std::size_t alignment);
     bool isPowerOfTwo(std::size_t value);
     std::size_t nextPowerOfTwo(std::size_t value);
     
 private:
-    MemoryManager() = default;
-    ~MemoryManager() = default;
+    MemoryManager();
+    ~MemoryManager();
     MemoryManager(const MemoryManager&) = delete;
     MemoryManager& operator=(const MemoryManager&) = delete;
     
+    static constexpr std::size_t MaxThreadCaches = 256;
+    
+    struct ThreadCacheHandle;
+    static thread_local ThreadCacheHandle threadCacheHandle;
+    
+    ThreadCache* getThreadCache();
+    ThreadCache* adoptThreadCache();
+    void releaseThreadCache(ThreadCache* cache);
+    
     std::unique_ptr<MemoryPool> defaultPool;
     std::vector<std::unique_ptr<MemoryPool>> pools;
     std::vector<std::unique_ptr<StackAllocator>> stackAllocators;
+    std::unique_ptr<FrameArena> frameArena;
     MemoryTracker& tracker = MemoryTracker::getInstance();
-    bool initialized = false;
+    std::atomic<ThreadCache*> threadCaches[MaxThreadCaches] = {};
+    std::atomic<bool> threadCachesEnabled{true};
+    std::atomic<bool> initialized{false};
     mutable std::mutex mutex;
 };
 
 // Global convenience functions
 inline void* Allocate(std::size_t size, std::size_t alignment = 8, 
-                     const std::string& tag = "", const std::string& file = "", int line = 0) {
+                     const char* tag = "", const char* file = "", int line = 0) {
     return MemoryManager::getInstance().allocate(size, alignment, tag, file, line);
 }
 
@@ -273,6 +1031,64 @@ inline void* Reallocate(void* ptr, std::size_t newSize) {
     return MemoryManager::getInstance().reallocate(ptr, newSize);
 }
 
+/**
+ * @brief STL allocator adapter over a FrameArena
+ *
+ * Containers using it must not outlive the frames in flight; deallocation is
+ * a no-op and the memory goes away when the frame buffer is recycled.
+ * Without a frame arena (tools and tests) it falls back to the heap.
+ */
+template<typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept : arena(MemoryManager::getInstance().getFrameArena()) {}
+    explicit FrameAllocator(FrameArena* arena) noexcept : arena(arena) {}
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+    T* allocate(std::size_t count) {
+        if (count > std::size_t(-1) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        if (!arena) {
+            return std::allocator<T>().allocate(count);
+        }
+        void* ptr = arena->allocate(count * sizeof(T), alignof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t count) noexcept {
+        if (!arena) {
+            std::allocator<T>().deallocate(ptr, count);
+        }
+    }
+
+    FrameArena* getArena() const noexcept { return arena; }
+
+private:
+    FrameArena* arena;
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) noexcept {
+    return a.getArena() == b.getArena();
+}
+
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) noexcept {
+    return !(a == b);
+}
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
 // Macro for automatic file/line tracking
 #define VF_ALLOCATE(size, alignment, tag) \
     VaporFrame::Core::Allocate(size, alignment, tag, __FILE__, __LINE__)
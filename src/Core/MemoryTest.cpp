@@ -4,6 +4,12 @@
 #include <vector>
 #include <chrono>
 #include <random>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 using namespace VaporFrame::Core;
 
@@ -62,10 +68,140 @@ void testMemoryPool() {
     
     std::cout << "Pool deallocated all pointers" << std::endl;
     
+    // Pointers from any pool can be freed through the manager
+    void* routed = pool->allocate(256, 16);
+    VF_DEALLOCATE(routed);
+    std::cout << "Manager routed free to pool: " << (pool->getStats().deallocationCount == 4 ? "yes" : "no") << std::endl;
+    
     // Destroy pool
     MemoryManager::getInstance().destroyPool(pool);
 }
 
+void testPoolTrim() {
+    std::cout << "\n=== Testing Pool Trim ===" << std::endl;
+    
+    MemoryPoolConfig config(1024 * 1024, 256 * 1024 * 1024, 4096, 16, false, "TrimPool");
+    MemoryPool* pool = MemoryManager::getInstance().createPool(config);
+    
+    // Touch 64MB so the pool has to grow and every page becomes resident
+    std::vector<void*> blocks;
+    for (int i = 0; i < 64; ++i) {
+        void* ptr = pool->allocate(1024 * 1024, 16);
+        if (!ptr) break;
+        std::memset(ptr, 0xAB, 1024 * 1024);
+        blocks.push_back(ptr);
+    }
+    MemoryStats grown = pool->getStats();
+    std::cout << "Reserved: " << grown.reservedBytes << " bytes, committed: " << grown.committedBytes
+              << " bytes, resident: " << grown.residentBytes << " bytes" << std::endl;
+    std::cout << "Grew in place: " << (blocks.size() == 64 && grown.reservedBytes >= config.maxSize ? "yes" : "no") << std::endl;
+    
+    // Freeing every other block leaves holes that only discarding can shrink
+    for (std::size_t i = 0; i < blocks.size(); i += 2) {
+        pool->deallocate(blocks[i]);
+    }
+    std::size_t released = pool->trim();
+    MemoryStats holes = pool->getStats();
+    std::cout << "Trim released " << released << " bytes from holes, resident now " << holes.residentBytes << " bytes" << std::endl;
+    std::cout << "Holes discarded: " << (holes.residentBytes + 16 * 1024 * 1024 < grown.residentBytes ? "yes" : "no") << std::endl;
+    
+    // Surviving blocks are untouched by the discard
+    bool intact = true;
+    for (std::size_t i = 1; i < blocks.size(); i += 2) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(blocks[i]);
+        intact = intact && bytes[0] == 0xAB && bytes[1024 * 1024 - 1] == 0xAB;
+    }
+    std::cout << "Live blocks intact: " << (intact ? "yes" : "no") << std::endl;
+    
+    for (std::size_t i = 1; i < blocks.size(); i += 2) {
+        pool->deallocate(blocks[i]);
+    }
+    pool->trim();
+    MemoryStats trimmed = pool->getStats();
+    std::cout << "After full trim - committed: " << trimmed.committedBytes << " bytes, resident: " << trimmed.residentBytes << " bytes" << std::endl;
+    std::cout << "Committed back to initial size: " << (trimmed.committedBytes == config.initialSize ? "yes" : "no") << std::endl;
+    
+    // Decommitted pages come back on demand
+    void* again = pool->allocate(32 * 1024 * 1024, 16);
+    if (again) std::memset(again, 0xCD, 32 * 1024 * 1024);
+    std::cout << "Recommit after trim: " << (again && pool->owns(again) ? "yes" : "no") << std::endl;
+    pool->deallocate(again);
+    
+    MemoryManager::getInstance().destroyPool(pool);
+}
+
+void testPoolDefragment() {
+    std::cout << "\n=== Testing Pool Defragmentation ===" << std::endl;
+    
+    MemoryPoolConfig config(1024 * 1024, 256 * 1024 * 1024, 4096, 16, false, "DefragPool");
+    MemoryPool* pool = MemoryManager::getInstance().createPool(config);
+    
+    // Relocatable blocks of mixed sizes, each filled with its own index
+    std::vector<MemoryPool::Handle> handles;
+    std::vector<std::size_t> sizes;
+    for (std::size_t i = 0; i < 20000; ++i) {
+        std::size_t size = 64 + (i * 37) % 4096;
+        MemoryPool::Handle handle = pool->allocateHandle(size);
+        if (!handle.isValid()) break;
+        std::memset(pool->resolve(handle), static_cast<int>(i & 0xFF), size);
+        handles.push_back(handle);
+        sizes.push_back(size);
+    }
+    
+    // A raw allocation in the middle stays pinned
+    void* pinned = pool->allocate(1024, 16);
+    std::memset(pinned, 0x5A, 1024);
+    for (std::size_t i = 0; i < 1000; ++i) {
+        MemoryPool::Handle handle = pool->allocateHandle(256);
+        std::memset(pool->resolve(handle), 0x77, 256);
+        handles.push_back(handle);
+        sizes.push_back(256);
+    }
+    
+    // Free every other block to leave the heap full of holes
+    for (std::size_t i = 0; i < handles.size(); i += 2) {
+        pool->deallocateHandle(handles[i]);
+    }
+    MemoryPool::Handle stale = handles[0];
+    std::cout << "Freed handle resolves to null: " << (pool->resolve(stale) == nullptr ? "yes" : "no") << std::endl;
+    std::size_t before = pool->getFragmentation();
+    
+    // Budgeted passes, as the main loop runs them once per frame
+    std::size_t frames = 0;
+    std::size_t moved = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    while (std::size_t step = pool->defragment(std::chrono::microseconds(200))) {
+        moved += step;
+        frames++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::size_t after = pool->getFragmentation();
+    std::cout << "Moved " << moved << " bytes over " << frames << " budgeted calls in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " microseconds" << std::endl;
+    std::cout << "Fragmentation: " << before << "% -> " << after << "%" << std::endl;
+    std::cout << "Fragmentation reduced: " << (after < before ? "yes" : "no") << std::endl;
+    
+    bool intact = true;
+    for (std::size_t i = 1; i < handles.size(); i += 2) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(pool->resolve(handles[i]));
+        unsigned char expected = i < 20000 ? static_cast<unsigned char>(i & 0xFF) : 0x77;
+        intact = intact && bytes && bytes[0] == expected && bytes[sizes[i] - 1] == expected;
+    }
+    std::cout << "Moved blocks intact: " << (intact ? "yes" : "no") << std::endl;
+    std::cout << "Pinned block intact: " << (static_cast<unsigned char*>(pinned)[1023] == 0x5A ? "yes" : "no") << std::endl;
+    
+    // The holes gathered at the end of the heap can now be decommitted
+    std::size_t committed = pool->getStats().committedBytes;
+    pool->defragment();
+    std::cout << "Committed after compaction: " << committed << " -> " << pool->getStats().committedBytes << " bytes" << std::endl;
+    
+    for (std::size_t i = 1; i < handles.size(); i += 2) {
+        pool->deallocateHandle(handles[i]);
+    }
+    pool->deallocate(pinned);
+    MemoryManager::getInstance().destroyPool(pool);
+}
+
 void testStackAllocator() {
     std::cout << "\n=== Testing Stack Allocator ===" << std::endl;
     
@@ -97,6 +233,121 @@ void testStackAllocator() {
     MemoryManager::getInstance().destroyStackAllocator(stack);
 }
 
+void testFrameArena() {
+    std::cout << "\n=== Testing Frame Arena ===" << std::endl;
+    
+    auto& manager = MemoryManager::getInstance();
+    const std::uint32_t framesInFlight = 2;
+    FrameArena* arena = manager.createFrameArena(1024 * 1024, framesInFlight);
+    
+    void* first = manager.allocateFrame(256, 16);
+    std::cout << "Frame allocation: " << first << std::endl;
+    std::cout << "Owned by frame arena: " << (arena->owns(first) ? "yes" : "no") << std::endl;
+    std::cout << "Routed free ignored: " << (MemoryRegionMap::getInstance().find(first) == arena ? "yes" : "no") << std::endl;
+    VF_DEALLOCATE(first);
+    
+    // STL containers bump through the same frame buffer
+    FrameVector<int> values;
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(i);
+    }
+    std::cout << "FrameVector in arena: " << (arena->owns(values.data()) ? "yes" : "no") << std::endl;
+    
+    // Without an arena the adapter is a plain heap allocator
+    FrameString json(FrameAllocator<char>(nullptr));
+    json += "{\"frame\":";
+    json += std::to_string(1234567890123ull);
+    json += "}";
+    std::cout << "FrameString without arena: " << (json == "{\"frame\":1234567890123}" ? "yes" : "no") << std::endl;
+    
+    // Every thread gets its own chunk, so concurrent allocations never overlap
+    std::vector<std::vector<char*>> perThread(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < perThread.size(); ++t) {
+        threads.emplace_back([&perThread, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                char* ptr = static_cast<char*>(MemoryManager::getInstance().allocateFrame(64, 16));
+                std::memset(ptr, static_cast<int>(t), 64);
+                perThread[t].push_back(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    bool intact = true;
+    for (std::size_t t = 0; t < perThread.size(); ++t) {
+        for (char* ptr : perThread[t]) {
+            intact = intact && ptr[0] == static_cast<char>(t) && ptr[63] == static_cast<char>(t);
+        }
+    }
+    std::cout << "Threaded frame allocations intact: " << (intact ? "yes" : "no") << std::endl;
+    
+    // The buffer is handed out again once every frame in flight has passed
+    for (std::uint32_t i = 0; i < framesInFlight; ++i) {
+        manager.beginFrame();
+    }
+    void* recycled = manager.allocateFrame(256, 16);
+    std::cout << "Buffer recycled after " << framesInFlight << " frames: " << (recycled == first ? "yes" : "no") << std::endl;
+    
+    // Running out of buffer falls back to the heap until the frame is recycled
+    void* large = manager.allocateFrame(4 * 1024 * 1024, 16);
+    std::cout << "Oversized frame allocation: " << (large && !arena->owns(large) ? "heap fallback" : "failed") << std::endl;
+    
+    MemoryStats stats = arena->getStats();
+    std::cout << "Frame usage: " << stats.currentUsage << " bytes, peak " << stats.peakUsage << " bytes" << std::endl;
+    
+    const int iterations = 1000000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        if ((i & 0xFFF) == 0) {
+            manager.beginFrame();
+        }
+        void* ptr = manager.allocateFrame(64, 16);
+        static_cast<char*>(ptr)[0] = 0;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Frame arena: " << iterations << " allocations in " << duration.count() << " microseconds" << std::endl;
+}
+
+void testObjectPool() {
+    std::cout << "\n=== Testing Object Pool ===" << std::endl;
+    
+    struct Particle {
+        float position[3] = {};
+        float velocity[3] = {};
+        int* liveCount;
+        explicit Particle(int* count) : liveCount(count) { ++*liveCount; }
+        ~Particle() { --*liveCount; }
+    };
+    
+    int liveCount = 0;
+    {
+        ObjectPool<Particle> pool;
+        std::vector<ObjectPool<Particle>::Handle> handles;
+        for (int i = 0; i < 10000; ++i) {
+            handles.push_back(pool.create(&liveCount));
+        }
+        Particle* first = pool.get(handles.front());
+        
+        // Growing adds chunks instead of moving existing objects
+        pool.reserve(100000);
+        std::cout << "Pointers stable across growth: " << (pool.get(handles.front()) == first ? "yes" : "no") << std::endl;
+        std::cout << "Handle round trip: " << (pool.getHandle(first) == handles.front() ? "yes" : "no") << std::endl;
+        
+        pool.destroy(handles.front());
+        ObjectPool<Particle>::Handle reused = pool.create(&liveCount);
+        std::cout << "Freed slot reused: " << (pool.get(reused) == first ? "yes" : "no") << std::endl;
+        std::cout << "Stale handle rejected: " << (pool.get(handles.front()) == nullptr ? "yes" : "no") << std::endl;
+        // Generation 0 names a slot that was never constructed
+        ObjectPool<Particle>::Handle unused{static_cast<std::uint32_t>(pool.capacity() - 1), 0};
+        std::cout << "Free slot handle rejected: " << (pool.get(unused) == nullptr ? "yes" : "no") << std::endl;
+        std::cout << "Live objects: " << pool.size() << " of " << pool.capacity() << " slots" << std::endl;
+    }
+    std::cout << "Pool destruction destroyed live objects: " << (liveCount == 0 ? "yes" : "no") << std::endl;
+}
+
 void testReallocation() {
     std::cout << "\n=== Testing Reallocation ===" << std::endl;
     
@@ -109,6 +360,18 @@ void testReallocation() {
     
     VF_DEALLOCATE(newPtr);
     std::cout << "Deallocated reallocated pointer" << std::endl;
+    
+    // Blocks larger than the default pool go to the system allocator
+    auto& tracker = MemoryTracker::getInstance();
+    bool wasTracking = tracker.isTrackingEnabled();
+    tracker.enableTracking(true);
+    std::size_t usageBefore = tracker.getGlobalStats().currentUsage;
+    void* large = VF_ALLOCATE(200 * 1024 * 1024, 16, "realloc_system");
+    void* larger = large ? VF_REALLOCATE(large, 300 * 1024 * 1024) : nullptr;
+    VF_DEALLOCATE(larger ? larger : large);
+    std::size_t usageAfter = tracker.getGlobalStats().currentUsage;
+    std::cout << "System reallocation balanced: " << (large && usageAfter == usageBefore ? "yes" : "no") << std::endl;
+    tracker.enableTracking(wasTracking);
 }
 
 void testPerformance() {
@@ -147,6 +410,335 @@ void testPerformance() {
     std::cout << "Speedup: " << (double)systemTime.count() / managerTime.count() << "x" << std::endl;
 }
 
+// Baseline that reproduces the previous MemoryPool strategy: free blocks in one
+// vector scanned first-fit, merges found with std::find + erase
+class FirstFitPool {
+public:
+    explicit FirstFitPool(std::size_t size) : memory(static_cast<char*>(std::malloc(size))) {
+        Block* block = new Block{memory, size, false, nullptr, nullptr};
+        freeBlocks.push_back(block);
+    }
+    
+    ~FirstFitPool() {
+        for (auto& pair : usedBlocks) delete pair.second;
+        for (Block* block : freeBlocks) delete block;
+        std::free(memory);
+    }
+    
+    void* allocate(std::size_t size) {
+        size = (size + 15) & ~std::size_t(15);
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            Block* block = *it;
+            if (block->size < size) continue;
+            
+            freeBlocks.erase(it);
+            if (block->size - size >= 32) {
+                Block* remainder = new Block{block->data + size, block->size - size, false, block, block->next};
+                if (block->next) block->next->prev = remainder;
+                block->next = remainder;
+                block->size = size;
+                freeBlocks.push_back(remainder);
+            }
+            block->used = true;
+            usedBlocks[block->data] = block;
+            return block->data;
+        }
+        return nullptr;
+    }
+    
+    void deallocate(void* ptr) {
+        auto found = usedBlocks.find(ptr);
+        if (found == usedBlocks.end()) return;
+        
+        Block* block = found->second;
+        usedBlocks.erase(found);
+        block->used = false;
+        freeBlocks.push_back(block);
+        
+        if (block->next && !block->next->used) {
+            Block* next = block->next;
+            block->size += next->size;
+            block->next = next->next;
+            if (next->next) next->next->prev = block;
+            freeBlocks.erase(std::find(freeBlocks.begin(), freeBlocks.end(), next));
+            delete next;
+        }
+        if (block->prev && !block->prev->used) {
+            Block* prev = block->prev;
+            prev->size += block->size;
+            prev->next = block->next;
+            if (block->next) block->next->prev = prev;
+            freeBlocks.erase(std::find(freeBlocks.begin(), freeBlocks.end(), block));
+            delete block;
+        }
+    }
+    
+private:
+    struct Block {
+        char* data;
+        std::size_t size;
+        bool used;
+        Block* prev;
+        Block* next;
+    };
+    
+    char* memory;
+    std::vector<Block*> freeBlocks;
+    std::unordered_map<void*, Block*> usedBlocks;
+};
+
+// Fills an allocator with liveBlocks random-sized blocks, then measures a steady
+// churn of free-one/allocate-one operations and returns operations per second
+template<typename AllocFn, typename FreeFn>
+double measureChurn(std::size_t liveBlocks, std::size_t churnOps, AllocFn allocFn, FreeFn freeFn) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<std::size_t> sizeDist(16, 256);
+    
+    std::vector<void*> live;
+    live.reserve(liveBlocks);
+    for (std::size_t i = 0; i < liveBlocks; ++i) {
+        live.push_back(allocFn(sizeDist(rng)));
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < churnOps; ++i) {
+        std::size_t victim = rng() % live.size();
+        freeFn(live[victim]);
+        live[victim] = allocFn(sizeDist(rng));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    for (void* ptr : live) {
+        freeFn(ptr);
+    }
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return seconds > 0.0 ? churnOps / seconds : 0.0;
+}
+
+void testPoolScaling() {
+    std::cout << "\n=== Testing Pool Scaling (size-class bins vs first-fit) ===" << std::endl;
+    
+    const std::size_t liveCounts[] = {1000, 100000, 1000000};
+    const std::size_t churnOps = 20000;
+    const std::size_t arenaSize = std::size_t(512) * 1024 * 1024;
+    
+    for (std::size_t liveBlocks : liveCounts) {
+        MemoryPoolConfig config(64 * 1024 * 1024, arenaSize, 4096, 16, false, "ScalingPool");
+        auto pool = std::make_unique<MemoryPool>(config);
+        double binnedOps = measureChurn(liveBlocks, churnOps,
+            [&](std::size_t size) { return pool->allocate(size, 16); },
+            [&](void* ptr) { pool->deallocate(ptr); });
+        pool.reset();
+        
+        auto firstFit = std::make_unique<FirstFitPool>(arenaSize);
+        double firstFitOps = measureChurn(liveBlocks, churnOps,
+            [&](std::size_t size) { return firstFit->allocate(size); },
+            [&](void* ptr) { firstFit->deallocate(ptr); });
+        firstFit.reset();
+        
+        std::cout << liveBlocks << " live blocks: size-class bins " << static_cast<std::size_t>(binnedOps)
+                  << " ops/s, first-fit " << static_cast<std::size_t>(firstFitOps) << " ops/s ("
+                  << binnedOps / firstFitOps << "x)" << std::endl;
+    }
+}
+
+// Transform-sized record for the page-mode benchmark
+struct StridedTransform {
+    float position[3];
+    float rotation[4];
+    float scale[3];
+    float world[16];
+};
+
+// Walks transforms with a stride that lands on a new 4KB page every step and
+// returns the best pass time in milliseconds
+double measureStridedTransforms(MemoryPool& pool, std::size_t count) {
+    StridedTransform* transforms = static_cast<StridedTransform*>(pool.allocate(count * sizeof(StridedTransform), 64));
+    if (!transforms) return 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        StridedTransform& t = transforms[i];
+        std::fill(std::begin(t.position), std::end(t.position), 1.0f);
+        std::fill(std::begin(t.world), std::end(t.world), 0.0f);
+    }
+    
+    // An odd stride coprime with count still visits every transform once
+    const std::size_t stride = 4096 / sizeof(StridedTransform) + 1;
+    double best = 0.0;
+    for (int pass = 0; pass < 3; ++pass) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            StridedTransform& t = transforms[index];
+            t.world[12] += t.position[0];
+            t.world[13] += t.position[1];
+            t.world[14] += t.position[2];
+            index += stride;
+            if (index >= count) index -= count;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        best = pass == 0 ? ms : std::min(best, ms);
+    }
+    
+    pool.deallocate(transforms);
+    return best;
+}
+
+void testHugePages() {
+    std::cout << "\n=== Testing Pool Page Modes (strided transform iteration) ===" << std::endl;
+    
+    // ~400MB of transforms, far beyond what the TLB covers with 4KB pages.
+    // A prime count keeps the stride walk a single cycle.
+    const std::size_t count = 3999971;
+    const std::size_t poolSize = std::size_t(512) * 1024 * 1024;
+    const char* modeNames[] = {"default", "transparent", "explicit"};
+    
+    struct Run { PoolPageMode mode; int numaNode; };
+    const Run runs[] = {
+        {PoolPageMode::Default, -1},
+        {PoolPageMode::Transparent, -1},
+        {PoolPageMode::Explicit, -1},
+        {PoolPageMode::Transparent, 0},
+    };
+    
+    double baseline = 0.0;
+    for (const Run& run : runs) {
+        MemoryPoolConfig config(poolSize, poolSize, 4096, 16, false, "PagePool");
+        config.pageMode = run.mode;
+        config.numaNode = run.numaNode;
+        auto pool = std::make_unique<MemoryPool>(config);
+    
+        double ms = measureStridedTransforms(*pool, count);
+        if (run.mode == PoolPageMode::Default) baseline = ms;
+    
+        std::cout << modeNames[static_cast<int>(run.mode)] << " pages";
+        if (run.numaNode >= 0) std::cout << " on node " << run.numaNode;
+        std::cout << " (in effect: " << modeNames[static_cast<int>(pool->getPageMode())] << "): "
+                  << ms << " ms";
+        if (ms > 0.0 && baseline > 0.0) std::cout << " (" << baseline / ms << "x)";
+        std::cout << std::endl;
+    }
+}
+
+// Runs the same small-object churn on threadCount threads and returns total operations per second
+double measureThreadedChurn(unsigned threadCount, std::size_t opsPerThread) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&go, opsPerThread, t]() {
+            std::mt19937 rng(42 + t);
+            std::uniform_int_distribution<std::size_t> sizeDist(16, 512);
+            std::vector<void*> live(256, nullptr);
+            
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < opsPerThread; ++i) {
+                void*& slot = live[rng() % live.size()];
+                VF_DEALLOCATE(slot);
+                slot = VF_ALLOCATE(sizeDist(rng), 16, "thread_churn");
+            }
+            for (void* ptr : live) {
+                VF_DEALLOCATE(ptr);
+            }
+        });
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return seconds > 0.0 ? (threadCount * opsPerThread) / seconds : 0.0;
+}
+
+void testThreadScaling() {
+    std::cout << "\n=== Testing Thread Scaling (thread caches vs shared pool) ===" << std::endl;
+    
+    auto& manager = MemoryManager::getInstance();
+    bool wasTracking = MemoryTracker::getInstance().isTrackingEnabled();
+    MemoryTracker::getInstance().enableTracking(false);
+    
+    // Blocks freed on another thread must find their way back to the owner,
+    // which picks them up once its own magazine for that size runs dry
+    void* remote = VF_ALLOCATE(1000, 16, "remote_free");
+    std::thread([remote]() { VF_DEALLOCATE(remote); }).join();
+    std::vector<void*> drained;
+    bool returned = false;
+    for (std::size_t i = 0; i < ThreadCache::MaxMagazineSize && !returned; ++i) {
+        drained.push_back(VF_ALLOCATE(1000, 16, "remote_free"));
+        returned = drained.back() == remote;
+    }
+    std::cout << "Remote free returned to owning thread: " << (returned ? "yes" : "no") << std::endl;
+    for (void* ptr : drained) {
+        VF_DEALLOCATE(ptr);
+    }
+    
+    const std::size_t opsPerThread = 200000;
+    unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        manager.enableThreadCaches(false);
+        double sharedOps = measureThreadedChurn(threadCount, opsPerThread);
+        manager.enableThreadCaches(true);
+        double cachedOps = measureThreadedChurn(threadCount, opsPerThread);
+        
+        std::cout << threadCount << " thread(s): thread caches " << static_cast<std::size_t>(cachedOps)
+                  << " ops/s, shared pool " << static_cast<std::size_t>(sharedOps) << " ops/s ("
+                  << cachedOps / sharedOps << "x)" << std::endl;
+    }
+    
+    MemoryTracker::getInstance().enableTracking(wasTracking);
+}
+
+void testTrackingOverhead() {
+    std::cout << "\n=== Testing Tracking Overhead ===" << std::endl;
+    
+    auto& tracker = MemoryTracker::getInstance();
+    const std::size_t opsPerThread = 500000;
+    unsigned threadCount = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+    
+    // Churn runs are noisy, so the modes take turns and each keeps its best run
+    double untracked = 0.0, full = 0.0, rateSampled = 0.0, byteSampled = 0.0;
+    MemoryStats before{}, after{};
+    for (int run = 0; run < 5; ++run) {
+        tracker.enableTracking(false);
+        untracked = std::max(untracked, measureThreadedChurn(threadCount, opsPerThread));
+        
+        tracker.enableTracking(true);
+        tracker.setSampleRate(1);
+        tracker.setSampleInterval(0);
+        full = std::max(full, measureThreadedChurn(threadCount, opsPerThread));
+        
+        tracker.setSampleRate(64);
+        rateSampled = std::max(rateSampled, measureThreadedChurn(threadCount, opsPerThread));
+        
+        tracker.setSampleRate(1);
+        tracker.setSampleInterval(512 * 1024);
+        before = tracker.getGlobalStats();
+        byteSampled = std::max(byteSampled, measureThreadedChurn(threadCount, opsPerThread));
+        after = tracker.getGlobalStats();
+    }
+    
+    auto overhead = [untracked](double ops) { return (untracked / ops - 1.0) * 100.0; };
+    std::cout << "Untracked: " << static_cast<std::size_t>(untracked) << " ops/s" << std::endl;
+    std::cout << "Every allocation: " << static_cast<std::size_t>(full) << " ops/s (" << overhead(full) << "% overhead)" << std::endl;
+    std::cout << "1 in 64: " << static_cast<std::size_t>(rateSampled) << " ops/s (" << overhead(rateSampled) << "% overhead)" << std::endl;
+    std::cout << "Every 512KB: " << static_cast<std::size_t>(byteSampled) << " ops/s (" << overhead(byteSampled) << "% overhead)" << std::endl;
+    
+    // Counters stay exact while records are sampled
+    std::size_t expected = threadCount * opsPerThread;
+    std::size_t counted = after.allocationCount - before.allocationCount;
+    std::cout << "Sampled counters exact: " << (counted == expected ? "yes" : "no") << std::endl;
+    std::cout << "Sampled usage balanced: " << (after.currentUsage == before.currentUsage ? "yes" : "no") << std::endl;
+    
+    tracker.setSampleInterval(0);
+}
+
 void testMemoryTracking() {
     std::cout << "\n=== Testing Memory Tracking ===" << std::endl;
     
@@ -188,9 +780,17 @@ int main() {
     try {
         testBasicAllocation();
         testMemoryPool();
+        testPoolTrim();
+        testPoolDefragment();
         testStackAllocator();
+        testFrameArena();
+        testObjectPool();
         testReallocation();
         testPerformance();
+        testPoolScaling();
+        testHugePages();
+        testThreadScaling();
+        testTrackingOverhead();
         testMemoryTracking();
         
         // Shutdown memory manager
@@ -1,14 +1,383 @@
 #include "MeshLoader.h"
-#include <fstream>
-#include <sstream>
+#include "MappedFile.h"
+#include "JobSystem.h"
 #include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <filesystem>
+#include <numeric>
+#include <string_view>
+#include <type_traits>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace VaporFrame {
 namespace Core {
 
+namespace {
+
+// In-place scanning for the text formats. Each reader advances cursor past
+// what it consumed and never reads at or beyond end, the end of the line.
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+void skipBlanks(const char*& cursor, const char* end) {
+    while (cursor < end && isBlank(*cursor)) ++cursor;
+}
+
+std::string_view readToken(const char*& cursor, const char* end) {
+    skipBlanks(cursor, end);
+    const char* begin = cursor;
+    while (cursor < end && !isBlank(*cursor)) ++cursor;
+    return std::string_view(begin, static_cast<std::size_t>(cursor - begin));
+}
+
+// Leaves value untouched unless the whole token is a number
+bool readFloat(const char*& cursor, const char* end, float& value) {
+    skipBlanks(cursor, end);
+    // from_chars rejects the leading '+' that stof accepted
+    const char* begin = cursor < end && *cursor == '+' ? cursor + 1 : cursor;
+    float parsed;
+    auto [next, error] = std::from_chars(begin, end, parsed);
+    if (error != std::errc() || (next < end && !isBlank(*next))) return false;
+    value = parsed;
+    cursor = next;
+    return true;
+}
+
+bool readVec3(const char*& cursor, const char* end, glm::vec3& value) {
+    glm::vec3 parsed;
+    if (!readFloat(cursor, end, parsed.x) || !readFloat(cursor, end, parsed.y) || !readFloat(cursor, end, parsed.z)) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+bool readIndex(const char*& cursor, const char* end, int& index) {
+    auto [next, error] = std::from_chars(cursor, end, index);
+    if (error != std::errc()) return false;
+    cursor = next;
+    return true;
+}
+
+// One face corner: "v", "v/vt", "v//vn" or "v/vt/vn". Absent indices are 0.
+bool readCorner(const char*& cursor, const char* end, int& position, int& texCoord, int& normal) {
+    if (!readIndex(cursor, end, position)) return false;
+    if (cursor < end && *cursor == '/') {
+        ++cursor;
+        if (cursor < end && *cursor != '/' && !readIndex(cursor, end, texCoord)) return false;
+        if (cursor < end && *cursor == '/') {
+            ++cursor;
+            if (!readIndex(cursor, end, normal)) return false;
+        }
+    }
+    return cursor == end || isBlank(*cursor);
+}
+
+// OBJ indices count from 1, or back from the latest element when negative.
+// Returns count for 0 and anything out of range.
+std::size_t resolveIndex(int index, std::size_t count) {
+    if (index > 0 && static_cast<std::size_t>(index) <= count) {
+        return static_cast<std::size_t>(index) - 1;
+    }
+    if (index < 0 && static_cast<std::size_t>(-static_cast<long long>(index)) <= count) {
+        return count - static_cast<std::size_t>(-static_cast<long long>(index));
+    }
+    return count;
+}
+
+// Open-addressing hash table of vertex indices, for deduplication. Slots
+// hold an index and its key's hash; the keys stay with the caller, which
+// compares them through a callback. Linear probing over a power-of-two
+// table that doubles at half full.
+class VertexIndexTable {
+public:
+    static constexpr std::uint32_t Empty = 0xFFFFFFFFu;
+    
+    explicit VertexIndexTable(std::size_t expected = 0) {
+        std::size_t capacity = 16;
+        while (capacity < expected * 2) capacity *= 2;
+        slots.resize(capacity);
+    }
+    
+    // The index stored under a key equal(stored) finds, or index once stored
+    template<typename Equal>
+    std::uint32_t insert(std::uint32_t hash, std::uint32_t index, Equal&& equal) {
+        if ((count + 1) * 2 > slots.size()) {
+            grow();
+        }
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots[i];
+            if (slot.index == Empty) {
+                slot = Slot{hash, index};
+                ++count;
+                return index;
+            }
+            if (slot.hash == hash && equal(slot.index)) {
+                return slot.index;
+            }
+        }
+    }
+    
+private:
+    struct Slot {
+        std::uint32_t hash = 0;
+        std::uint32_t index = Empty;
+    };
+    
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        std::size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.index == Empty) continue;
+            std::size_t i = slot.hash & mask;
+            while (slots[i].index != Empty) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+    
+    std::vector<Slot> slots;
+    std::size_t count = 0;
+};
+
+// Folds words into a 32-bit hash, mixed so that nearby values spread out
+template<typename Word>
+std::uint32_t hashWords(const Word* words, std::size_t count) {
+    std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+    for (std::size_t i = 0; i < count; ++i) {
+        hash = (hash ^ static_cast<std::uint64_t>(words[i])) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    return static_cast<std::uint32_t>(hash);
+}
+
+// An OBJ file is parsed as independent slices split at line boundaries,
+// then stitched. Faces keep their raw indices and how many of each
+// attribute the slice had defined before them, which is all resolving
+// them against the whole file needs once the earlier slices are counted.
+struct OBJCorner {
+    int position = 0;
+    int texCoord = 0;
+    int normal = 0;
+};
+
+struct OBJFace {
+    std::uint32_t firstCorner;
+    std::uint32_t cornerCount;
+    std::uint32_t positionCount;
+    std::uint32_t texCoordCount;
+    std::uint32_t normalCount;
+};
+
+// A distinct vertex: its resolved position, texture coordinate and normal
+// indices, Empty where the corner has none
+struct OBJVertexKey {
+    std::uint32_t attributes[3];
+    
+    bool operator==(const OBJVertexKey& other) const {
+        return attributes[0] == other.attributes[0] && attributes[1] == other.attributes[1] &&
+               attributes[2] == other.attributes[2];
+    }
+    std::uint32_t hash() const { return hashWords(attributes, 3); }
+};
+
+// usemtl and mtllib, replayed in file order. Names point into the mapping.
+struct OBJDirective {
+    bool library;
+    std::string_view name;
+};
+
+struct OBJChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<OBJCorner> corners;
+    std::vector<OBJFace> faces;
+    std::vector<OBJDirective> directives;
+    std::size_t triangleCount = 0;
+    
+    // The slice's distinct vertices in first-use order, the table finding
+    // them, and each triangle corner's vertex among them
+    std::vector<OBJVertexKey> vertexKeys;
+    VertexIndexTable vertexTable;
+    std::vector<std::uint32_t> triangleVertices;
+    // Each of vertexKeys' vertex in the whole mesh
+    std::vector<std::uint32_t> meshVertices;
+    
+    // Where this slice's attributes and triangles go in the whole mesh
+    std::size_t positionBase = 0;
+    std::size_t texCoordBase = 0;
+    std::size_t normalBase = 0;
+    std::size_t triangleBase = 0;
+};
+
+// Slices of at least minimumSize bytes, about chunkCount of them, and at
+// least one
+std::vector<OBJChunk> splitOBJ(const char* begin, const char* end, std::size_t chunkCount, std::size_t minimumSize) {
+    std::size_t size = static_cast<std::size_t>(end - begin);
+    std::size_t chunkSize = std::max(minimumSize, size / std::max<std::size_t>(chunkCount, 1) + 1);
+    std::vector<OBJChunk> chunks;
+    for (const char* cursor = begin; cursor < end;) {
+        const char* split = static_cast<std::size_t>(end - cursor) > chunkSize ? cursor + chunkSize : end;
+        if (split < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(split, '\n', end - split));
+            split = lineEnd ? lineEnd + 1 : end;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = cursor;
+        chunks.back().end = split;
+        cursor = split;
+    }
+    // An empty file is one empty slice
+    if (chunks.empty()) {
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = end;
+    }
+    return chunks;
+}
+
+// Sizes a slice's arrays from a count of each record type, so they don't
+// regrow and copy while parsing
+void reserveOBJChunk(OBJChunk& chunk) {
+    std::size_t positionCount = 0, normalCount = 0, texCoordCount = 0, faceCount = 0;
+    for (const char* cursor = chunk.begin; cursor < chunk.end;) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', chunk.end - cursor));
+        if (!lineEnd) lineEnd = chunk.end;
+        if (lineEnd - cursor > 2) {
+            if (cursor[0] == 'v') {
+                positionCount += cursor[1] == ' ' || cursor[1] == '\t';
+                normalCount += cursor[1] == 'n';
+                texCoordCount += cursor[1] == 't';
+            } else {
+                faceCount += cursor[0] == 'f';
+            }
+        }
+        cursor = lineEnd < chunk.end ? lineEnd + 1 : chunk.end;
+    }
+    chunk.positions.reserve(positionCount);
+    chunk.normals.reserve(normalCount);
+    chunk.texCoords.reserve(texCoordCount);
+    chunk.faces.reserve(faceCount);
+    chunk.corners.reserve(faceCount * 3);
+}
+
+// Reads the corners of the face record in [cursor, end). Faces with fewer
+// than three corners or a malformed corner are skipped.
+void readOBJFace(const char* cursor, const char* end, OBJChunk& chunk) {
+    OBJFace face;
+    face.firstCorner = static_cast<std::uint32_t>(chunk.corners.size());
+    face.positionCount = static_cast<std::uint32_t>(chunk.positions.size());
+    face.texCoordCount = static_cast<std::uint32_t>(chunk.texCoords.size());
+    face.normalCount = static_cast<std::uint32_t>(chunk.normals.size());
+    for (skipBlanks(cursor, end); cursor < end; skipBlanks(cursor, end)) {
+        OBJCorner corner;
+        if (!readCorner(cursor, end, corner.position, corner.texCoord, corner.normal)) {
+            chunk.corners.resize(face.firstCorner);
+            return;
+        }
+        chunk.corners.push_back(corner);
+    }
+    face.cornerCount = static_cast<std::uint32_t>(chunk.corners.size()) - face.firstCorner;
+    if (face.cornerCount < 3) {
+        chunk.corners.resize(face.firstCorner);
+        return;
+    }
+    chunk.faces.push_back(face);
+    chunk.triangleCount += face.cornerCount - 2;
+}
+
+void parseOBJChunk(OBJChunk& chunk) {
+    reserveOBJChunk(chunk);
+    for (const char* cursor = chunk.begin; cursor < chunk.end;) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', chunk.end - cursor));
+        if (!lineEnd) lineEnd = chunk.end;
+        
+        // Comments and unknown records fall through
+        std::string_view command = readToken(cursor, lineEnd);
+        if (command == "v") { // Vertex position
+            glm::vec3 position;
+            if (readVec3(cursor, lineEnd, position)) {
+                chunk.positions.push_back(position);
+            }
+        } else if (command == "vn") { // Vertex normal
+            glm::vec3 normal;
+            if (readVec3(cursor, lineEnd, normal)) {
+                chunk.normals.push_back(normal);
+            }
+        } else if (command == "vt") { // Vertex texture coordinate
+            glm::vec2 texCoord;
+            if (readFloat(cursor, lineEnd, texCoord.x) && readFloat(cursor, lineEnd, texCoord.y)) {
+                chunk.texCoords.push_back(texCoord);
+            }
+        } else if (command == "f") { // Face
+            readOBJFace(cursor, lineEnd, chunk);
+        } else if (command == "usemtl" || command == "mtllib") { // Material, material library
+            std::string_view name = readToken(cursor, lineEnd);
+            if (!name.empty()) {
+                chunk.directives.push_back(OBJDirective{command == "mtllib", name});
+            }
+        }
+        
+        cursor = lineEnd < chunk.end ? lineEnd + 1 : chunk.end;
+    }
+}
+
+// Resolves a slice's corners against the whole file and fans its faces
+// into triangles over the slice's distinct vertices. Indices resolve
+// against what the file had defined up to the face; missing or out of range
+// attributes are left Empty.
+void indexOBJChunk(OBJChunk& chunk) {
+    // Typical meshes share each vertex among four to six corners
+    chunk.vertexTable = VertexIndexTable(chunk.corners.size() / 4);
+    chunk.triangleVertices.resize(chunk.triangleCount * 3);
+    std::size_t out = 0;
+    for (const OBJFace& face : chunk.faces) {
+        std::size_t positionCount = chunk.positionBase + face.positionCount;
+        std::size_t texCoordCount = chunk.texCoordBase + face.texCoordCount;
+        std::size_t normalCount = chunk.normalBase + face.normalCount;
+        auto vertexOf = [&](const OBJCorner& corner) {
+            std::size_t position = resolveIndex(corner.position, positionCount);
+            std::size_t texCoord = resolveIndex(corner.texCoord, texCoordCount);
+            std::size_t normal = resolveIndex(corner.normal, normalCount);
+            OBJVertexKey key{{position < positionCount ? static_cast<std::uint32_t>(position) : VertexIndexTable::Empty,
+                              texCoord < texCoordCount ? static_cast<std::uint32_t>(texCoord) : VertexIndexTable::Empty,
+                              normal < normalCount ? static_cast<std::uint32_t>(normal) : VertexIndexTable::Empty}};
+            auto next = static_cast<std::uint32_t>(chunk.vertexKeys.size());
+            std::uint32_t vertex = chunk.vertexTable.insert(key.hash(), next, [&](std::uint32_t stored) {
+                return chunk.vertexKeys[stored] == key;
+            });
+            if (vertex == next) {
+                chunk.vertexKeys.push_back(key);
+            }
+            return vertex;
+        };
+        
+        // Fan triangulation
+        const OBJCorner* corners = chunk.corners.data() + face.firstCorner;
+        std::uint32_t first = vertexOf(corners[0]);
+        std::uint32_t previous = vertexOf(corners[1]);
+        for (std::uint32_t i = 2; i < face.cornerCount; ++i) {
+            std::uint32_t current = vertexOf(corners[i]);
+            chunk.triangleVertices[out++] = first;
+            chunk.triangleVertices[out++] = previous;
+            chunk.triangleVertices[out++] = current;
+            previous = current;
+        }
+    }
+}
+
+} // namespace
+
 // Mesh methods
 void Mesh::calculateBounds() {
     minBounds = glm::vec3(std::numeric_limits<float>::max());
@@ -102,18 +471,31 @@ std::shared_ptr<Mesh> MeshLoader::loadMesh(const std::string& filepath) {
     std::string extension = getFileExtension(filepath);
     std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
     
-    std::shared_ptr<Mesh> mesh;
-    
-    if (extension == ".obj") {
-        mesh = loadOBJ(filepath);
-    } else if (extension == ".ply") {
-        mesh = loadPLY(filepath);
-    } else {
+    if (extension != ".obj" && extension != ".ply") {
         lastError = "Unsupported file format: " + extension;
         VF_LOG_ERROR("Failed to load mesh: {}", lastError);
         return nullptr;
     }
     
+    // A cooked copy of the same source bytes skips the import entirely
+    std::shared_ptr<Mesh> mesh;
+    std::string cookedPath;
+    uint64_t key = 0;
+    if (cookedMeshCache && hashMeshSource(filepath, key)) {
+        cookedPath = cookedMeshPath(filepath, key);
+        mesh = std::make_shared<Mesh>(getFilename(filepath));
+        if (!loadCookedMesh(cookedPath, filepath, key, *mesh)) {
+            mesh.reset();
+        }
+    }
+    
+    if (!mesh) {
+        mesh = extension == ".obj" ? loadOBJ(filepath) : loadPLY(filepath);
+        if (mesh && !cookedPath.empty()) {
+            saveCookedMesh(cookedPath, filepath, key, *mesh);
+        }
+    }
+    
     if (mesh) {
         meshCache[filepath] = mesh;
         VF_LOG_INFO("Successfully loaded mesh: {} ({} vertices, {} indices)", 
@@ -131,6 +513,7 @@ std::shared_ptr<Mesh> MeshLoader::loadOBJ(const std::string& filepath) {
     }
     
     mesh->optimize();
+    MeshUtils::optimizeIndices(*mesh);
     return mesh;
 }
 
@@ -142,154 +525,170 @@ std::shared_ptr<Mesh> MeshLoader::loadPLY(const std::string& filepath) {
     }
     
     mesh->optimize();
+    MeshUtils::optimizeIndices(*mesh);
     return mesh;
 }
 
 bool MeshLoader::parseOBJ(const std::string& filepath, Mesh& mesh) {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filepath)) {
         lastError = "Failed to open file: " + filepath;
         return false;
     }
+    materialLibraries.clear();
     
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> texCoords;
-    std::string currentMaterial = "default";
-    
-    // Create default material
-    Material defaultMat("default");
-    mesh.materials.push_back(defaultMat);
-    
-    // Create default submesh
-    Submesh defaultSubmesh("default");
-    mesh.submeshes.push_back(defaultSubmesh);
+    // A few slices per thread, so uneven ones balance out
+    const char* begin = reinterpret_cast<const char*>(file.getData());
+    std::size_t threadCount = jobSystem ? jobSystem->getThreadCount() : 1;
+    std::vector<OBJChunk> chunks = splitOBJ(begin, begin + file.getSize(), threadCount * 4, OBJChunkMinimumSize);
+    auto forEachChunk = [&](auto&& body) {
+        if (jobSystem && chunks.size() > 1) {
+            jobSystem->parallelFor(chunks.size(), 1, [&](std::size_t first, std::size_t last) {
+                for (std::size_t i = first; i < last; ++i) body(chunks[i]);
+            });
+        } else {
+            for (OBJChunk& chunk : chunks) body(chunk);
+        }
+    };
+    forEachChunk(parseOBJChunk);
     
-    std::string line;
-    uint32_t lineNumber = 0;
+    // Create default material and submesh
+    mesh.materials.emplace_back("default");
+    mesh.submeshes.emplace_back("default");
+    Submesh& submesh = mesh.submeshes.back();
     
-    while (std::getline(file, line)) {
-        lineNumber++;
-        line = trimString(line);
-        
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        
-        std::vector<std::string> tokens = splitString(line, ' ');
-        if (tokens.empty()) continue;
+    // Lay the slices out in file order and apply their material records
+    std::size_t positionCount = 0, texCoordCount = 0, normalCount = 0, triangleCount = 0;
+    for (OBJChunk& chunk : chunks) {
+        chunk.positionBase = positionCount;
+        chunk.texCoordBase = texCoordCount;
+        chunk.normalBase = normalCount;
+        chunk.triangleBase = triangleCount;
+        positionCount += chunk.positions.size();
+        texCoordCount += chunk.texCoords.size();
+        normalCount += chunk.normals.size();
+        triangleCount += chunk.triangleCount;
         
-        std::string command = tokens[0];
-        
-        if (command == "v") { // Vertex position
-            if (tokens.size() >= 4) {
-                glm::vec3 pos = parseVec3(tokens[1] + " " + tokens[2] + " " + tokens[3]);
-                positions.push_back(pos);
-            }
-        } else if (command == "vn") { // Vertex normal
-            if (tokens.size() >= 4) {
-                glm::vec3 norm = parseVec3(tokens[1] + " " + tokens[2] + " " + tokens[3]);
-                normals.push_back(norm);
-            }
-        } else if (command == "vt") { // Vertex texture coordinate
-            if (tokens.size() >= 3) {
-                glm::vec2 tex = parseVec2(tokens[1] + " " + tokens[2]);
-                texCoords.push_back(tex);
-            }
-        } else if (command == "f") { // Face
-            if (tokens.size() >= 4) {
-                processOBJFace(line, positions, normals, texCoords, 
-                              mesh.submeshes.back().vertices, mesh.submeshes.back().indices);
+        for (const OBJDirective& directive : chunk.directives) {
+            if (directive.library) {
+                materialLibraries.emplace_back(directive.name);
+                parseMTL((std::filesystem::path(filepath).parent_path() / std::string(directive.name)).string(),
+                         mesh.materials);
+                continue;
             }
-        } else if (command == "usemtl") { // Use material
-            if (tokens.size() >= 2) {
-                currentMaterial = tokens[1];
-                // Find or create material
-                bool found = false;
-                for (size_t i = 0; i < mesh.materials.size(); i++) {
-                    if (mesh.materials[i].name == currentMaterial) {
-                        mesh.submeshes.back().materialIndex = static_cast<uint32_t>(i);
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    Material newMat(currentMaterial);
-                    mesh.materials.push_back(newMat);
-                    mesh.submeshes.back().materialIndex = static_cast<uint32_t>(mesh.materials.size() - 1);
-                }
+            // Use material, created if no library defines it
+            auto material = std::find_if(mesh.materials.begin(), mesh.materials.end(),
+                                         [&directive](const Material& m) { return m.name == directive.name; });
+            if (material == mesh.materials.end()) {
+                mesh.materials.emplace_back(std::string(directive.name));
+                material = mesh.materials.end() - 1;
             }
-        } else if (command == "mtllib") { // Material library
-            if (tokens.size() >= 2) {
-                std::string mtlPath = getDirectory(filepath) + "/" + tokens[1];
-                parseMTL(mtlPath, mesh.materials);
+            submesh.materialIndex = static_cast<uint32_t>(material - mesh.materials.begin());
+        }
+    }
+    
+    std::vector<glm::vec3> positions(positionCount);
+    std::vector<glm::vec3> normals(normalCount);
+    std::vector<glm::vec2> texCoords(texCoordCount);
+    forEachChunk([&](OBJChunk& chunk) {
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordBase);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+        indexOBJChunk(chunk);
+    });
+    
+    // Number the distinct vertices in file order. The first slice's are all
+    // new, so its table carries on for the rest.
+    std::vector<OBJVertexKey> vertexKeys = std::move(chunks.front().vertexKeys);
+    VertexIndexTable vertexTable = std::move(chunks.front().vertexTable);
+    chunks.front().meshVertices.resize(vertexKeys.size());
+    std::iota(chunks.front().meshVertices.begin(), chunks.front().meshVertices.end(), 0u);
+    for (std::size_t c = 1; c < chunks.size(); ++c) {
+        OBJChunk& chunk = chunks[c];
+        chunk.meshVertices.resize(chunk.vertexKeys.size());
+        for (std::size_t i = 0; i < chunk.vertexKeys.size(); ++i) {
+            const OBJVertexKey& key = chunk.vertexKeys[i];
+            auto next = static_cast<std::uint32_t>(vertexKeys.size());
+            std::uint32_t vertex = vertexTable.insert(key.hash(), next, [&](std::uint32_t stored) {
+                return vertexKeys[stored] == key;
+            });
+            if (vertex == next) {
+                vertexKeys.push_back(key);
             }
+            chunk.meshVertices[i] = vertex;
         }
+        chunk.vertexTable = VertexIndexTable();
     }
+    vertexTable = VertexIndexTable();
     
-    file.close();
+    // Missing attributes keep the Vertex defaults
+    submesh.vertices.resize(vertexKeys.size());
+    auto buildVertices = [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const std::uint32_t* attributes = vertexKeys[i].attributes;
+            Vertex& vertex = submesh.vertices[i];
+            if (attributes[0] != VertexIndexTable::Empty) vertex.position = positions[attributes[0]];
+            if (attributes[1] != VertexIndexTable::Empty) vertex.texCoord = texCoords[attributes[1]];
+            if (attributes[2] != VertexIndexTable::Empty) vertex.normal = normals[attributes[2]];
+        }
+    };
+    if (jobSystem) {
+        jobSystem->parallelFor(vertexKeys.size(), 0, buildVertices);
+    } else {
+        buildVertices(0, vertexKeys.size());
+    }
+    
+    submesh.indices.resize(triangleCount * 3);
+    forEachChunk([&](OBJChunk& chunk) {
+        uint32_t* indices = submesh.indices.data() + chunk.triangleBase * 3;
+        for (std::size_t i = 0; i < chunk.triangleVertices.size(); ++i) {
+            indices[i] = chunk.meshVertices[chunk.triangleVertices[i]];
+        }
+    });
     return true;
 }
 
 bool MeshLoader::parseMTL(const std::string& filepath, std::vector<Material>& materials) {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filepath)) {
         VF_LOG_INFO("Failed to open material file: {}", filepath);
         return false;
     }
     
     Material* currentMaterial = nullptr;
-    std::string line;
-    
-    while (std::getline(file, line)) {
-        line = trimString(line);
-        
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        
-        std::vector<std::string> tokens = splitString(line, ' ');
-        if (tokens.empty()) continue;
-        
-        std::string command = tokens[0];
+    const char* cursor = reinterpret_cast<const char*>(file.getData());
+    const char* end = cursor + file.getSize();
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) lineEnd = end;
         
+        std::string_view command = readToken(cursor, lineEnd);
         if (command == "newmtl") { // New material
-            if (tokens.size() >= 2) {
-                materials.emplace_back(tokens[1]);
+            std::string_view materialName = readToken(cursor, lineEnd);
+            if (!materialName.empty()) {
+                materials.emplace_back(std::string(materialName));
                 currentMaterial = &materials.back();
             }
-        } else if (command == "Ka" && currentMaterial) { // Ambient
-            if (tokens.size() >= 4) {
-                currentMaterial->ambient = parseVec3(tokens[1] + " " + tokens[2] + " " + tokens[3]);
-            }
-        } else if (command == "Kd" && currentMaterial) { // Diffuse
-            if (tokens.size() >= 4) {
-                currentMaterial->diffuse = parseVec3(tokens[1] + " " + tokens[2] + " " + tokens[3]);
-            }
-        } else if (command == "Ks" && currentMaterial) { // Specular
-            if (tokens.size() >= 4) {
-                currentMaterial->specular = parseVec3(tokens[1] + " " + tokens[2] + " " + tokens[3]);
-            }
-        } else if (command == "Ns" && currentMaterial) { // Shininess
-            if (tokens.size() >= 2) {
-                currentMaterial->shininess = std::stof(tokens[1]);
-            }
-        } else if (command == "d" && currentMaterial) { // Alpha
-            if (tokens.size() >= 2) {
-                currentMaterial->alpha = std::stof(tokens[1]);
-            }
-        } else if (command == "map_Kd" && currentMaterial) { // Diffuse map
-            if (tokens.size() >= 2) {
-                currentMaterial->diffuseMap = tokens[1];
-            }
-        } else if (command == "map_Bump" && currentMaterial) { // Normal map
-            if (tokens.size() >= 2) {
-                currentMaterial->normalMap = tokens[1];
+        } else if (currentMaterial) {
+            if (command == "Ka") { // Ambient
+                readVec3(cursor, lineEnd, currentMaterial->ambient);
+            } else if (command == "Kd") { // Diffuse
+                readVec3(cursor, lineEnd, currentMaterial->diffuse);
+            } else if (command == "Ks") { // Specular
+                readVec3(cursor, lineEnd, currentMaterial->specular);
+            } else if (command == "Ns") { // Shininess
+                readFloat(cursor, lineEnd, currentMaterial->shininess);
+            } else if (command == "d") { // Alpha
+                readFloat(cursor, lineEnd, currentMaterial->alpha);
+            } else if (command == "map_Kd") { // Diffuse map
+                currentMaterial->diffuseMap = std::string(readToken(cursor, lineEnd));
+            } else if (command == "map_Bump") { // Normal map
+                currentMaterial->normalMap = std::string(readToken(cursor, lineEnd));
             }
         }
+        
+        cursor = lineEnd < end ? lineEnd + 1 : end;
     }
-    
-    file.close();
     return true;
 }
 
@@ -307,91 +706,386 @@ bool MeshLoader::parsePLY(const std::string& filepath, Mesh& mesh) {
     return false;
 }
 
-void MeshLoader::processOBJFace(const std::string& line, std::vector<glm::vec3>& positions,
-                               std::vector<glm::vec3>& normals, std::vector<glm::vec2>& texCoords,
-                               std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
-    std::vector<std::string> tokens = splitString(line, ' ');
-    if (tokens.size() < 4) return; // Need at least 3 vertices + "f"
-    
-    std::vector<Vertex> faceVertices;
+// Cooked mesh files
+//
+// Laid out like scene files: a header, a table of sections, then each
+// section as one contiguous blob of fixed-size records, here aligned to 16
+// bytes so vertex and index data can go to the GPU straight from the
+// mapping. Vertices are stored as the in-memory Vertex and indices as
+// uint32; every submesh is a range of the shared vertex and index
+// sections. The header carries the key the file was cooked under, and
+// each material library the source named is listed with the hash of its
+// bytes (zero if it was missing). Little-endian with IEEE floats.
+namespace {
+
+constexpr char CookedMeshMagic[4] = {'V', 'F', 'M', 'C'};
+constexpr std::uint32_t CookedMeshVersion = 1;
+constexpr std::uint64_t CookedMeshAlignment = 16;
+constexpr std::uint64_t MissingFileHash = 0;
+
+enum class CookedSection : std::uint32_t {
+    Submeshes = 1,
+    Materials,
+    Strings,
+    Vertices,
+    Indices,
+    Dependencies
+};
+
+struct CookedMeshHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t importerVersion;
+    std::uint32_t sectionCount;
+    std::uint64_t key;
+    float minBounds[3];
+    float maxBounds[3];
+};
+
+struct CookedSectionEntry {
+    std::uint32_t type;
+    std::uint32_t count;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+struct CookedStringRef {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct CookedSubmeshRecord {
+    CookedStringRef name;
+    std::uint32_t materialIndex;
+    std::uint32_t firstVertex;
+    std::uint32_t vertexCount;
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    std::uint32_t reserved;
+};
+
+struct CookedMaterialRecord {
+    CookedStringRef name;
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float shininess;
+    float alpha;
+    CookedStringRef diffuseMap;
+    CookedStringRef normalMap;
+    CookedStringRef specularMap;
+    CookedStringRef ambientMap;
+};
+
+struct CookedDependencyRecord {
+    CookedStringRef path;
+    std::uint64_t hash;
+};
+
+static_assert(sizeof(CookedMeshHeader) == 48 && sizeof(CookedSectionEntry) == 24, "Cooked mesh layout changed");
+static_assert(sizeof(CookedSubmeshRecord) == 32 && sizeof(CookedMaterialRecord) == 84 &&
+              sizeof(CookedDependencyRecord) == 16, "Cooked mesh layout changed");
+static_assert(sizeof(Vertex) == 11 * sizeof(float) && std::is_trivially_copyable_v<Vertex>,
+              "Vertex is stored as is in cooked meshes");
+
+// A section's records in the mapped file
+template<typename Record>
+struct CookedColumn {
+    const Record* records = nullptr;
+    std::uint32_t count = 0;
     
-    for (size_t i = 1; i < tokens.size(); i++) {
-        std::vector<std::string> vertexData = splitString(tokens[i], '/');
-        
-        int posIndex = -1, texIndex = -1, normIndex = -1;
-        
-        if (!vertexData[0].empty()) posIndex = std::stoi(vertexData[0]) - 1;
-        if (vertexData.size() > 1 && !vertexData[1].empty()) texIndex = std::stoi(vertexData[1]) - 1;
-        if (vertexData.size() > 2 && !vertexData[2].empty()) normIndex = std::stoi(vertexData[2]) - 1;
-        
-        Vertex vertex;
-        
-        // Position
-        if (posIndex >= 0 && posIndex < static_cast<int>(positions.size())) {
-            vertex.position = positions[posIndex];
-        }
-        
-        // Normal
-        if (normIndex >= 0 && normIndex < static_cast<int>(normals.size())) {
-            vertex.normal = normals[normIndex];
+    const Record* begin() const { return records; }
+    const Record* end() const { return records + count; }
+};
+
+// Finds a section and checks it lies within the file; a missing section is
+// an empty column
+template<typename Record>
+bool findCookedSection(const std::uint8_t* data, std::size_t size, const CookedMeshHeader& header,
+                       CookedSection type, CookedColumn<Record>& column) {
+    const auto* sections = reinterpret_cast<const CookedSectionEntry*>(data + sizeof(CookedMeshHeader));
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+        const CookedSectionEntry& section = sections[i];
+        if (section.type != static_cast<std::uint32_t>(type)) continue;
+        if (section.offset % CookedMeshAlignment != 0 || section.offset > size ||
+            section.size > size - section.offset ||
+            section.size != static_cast<std::uint64_t>(section.count) * sizeof(Record)) {
+            return false;
         }
-        
-        // Texture coordinate
-        if (texIndex >= 0 && texIndex < static_cast<int>(texCoords.size())) {
-            vertex.texCoord = texCoords[texIndex];
+        column.records = reinterpret_cast<const Record*>(data + section.offset);
+        column.count = section.count;
+        return true;
+    }
+    return true;
+}
+
+bool isValidCookedString(const CookedStringRef& ref, std::size_t stringsSize) {
+    return ref.offset <= stringsSize && ref.length <= stringsSize - ref.offset;
+}
+
+// 64-bit hash of a byte range, four independent lanes of eight bytes so a
+// source file hashes at memory speed
+std::uint64_t hashBytes(const std::uint8_t* data, std::size_t size) {
+    constexpr std::uint64_t Multiplier = 0xFF51AFD7ED558CCDull;
+    auto mix = [](std::uint64_t hash, std::uint64_t word) {
+        hash = (hash ^ word) * Multiplier;
+        return hash ^ (hash >> 32);
+    };
+    std::uint64_t lanes[4] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+                              0x27D4EB2F165667C5ull};
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, sizeof(word));
+            lanes[lane] = mix(lanes[lane], word);
         }
-        
-        faceVertices.push_back(vertex);
     }
-    
-    // Triangulate if necessary (simple fan triangulation)
-    for (size_t i = 2; i < faceVertices.size(); i++) {
-        vertices.push_back(faceVertices[0]);
-        vertices.push_back(faceVertices[i - 1]);
-        vertices.push_back(faceVertices[i]);
-        
-        indices.push_back(static_cast<uint32_t>(vertices.size() - 3));
-        indices.push_back(static_cast<uint32_t>(vertices.size() - 2));
-        indices.push_back(static_cast<uint32_t>(vertices.size() - 1));
+    std::uint64_t hash = mix(mix(mix(mix(size, lanes[0]), lanes[1]), lanes[2]), lanes[3]);
+    for (; i < size; i += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data + i, std::min<std::size_t>(8, size - i));
+        hash = mix(hash, word);
     }
+    return hash;
+}
+
+std::uint64_t hashFile(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return MissingFileHash;
+    }
+    std::uint64_t hash = hashBytes(file.getData(), file.getSize());
+    return hash == MissingFileHash ? 1 : hash;
+}
+
+} // namespace
+
+std::string MeshLoader::getCookedMeshPath(const std::string& filepath) {
+    uint64_t key = 0;
+    return hashMeshSource(filepath, key) ? cookedMeshPath(filepath, key) : std::string();
 }
 
-glm::vec3 MeshLoader::parseVec3(const std::string& str) {
-    std::vector<std::string> tokens = splitString(str, ' ');
-    if (tokens.size() >= 3) {
-        return glm::vec3(std::stof(tokens[0]), std::stof(tokens[1]), std::stof(tokens[2]));
+bool MeshLoader::hashMeshSource(const std::string& filepath, uint64_t& key) {
+    uint64_t hash = hashFile(filepath);
+    if (hash == MissingFileHash) {
+        return false;
     }
-    return glm::vec3(0.0f);
+    key = (hash ^ ImporterVersion) * 0x9E3779B97F4A7C15ull;
+    key ^= key >> 32;
+    return true;
 }
 
-glm::vec2 MeshLoader::parseVec2(const std::string& str) {
-    std::vector<std::string> tokens = splitString(str, ' ');
-    if (tokens.size() >= 2) {
-        return glm::vec2(std::stof(tokens[0]), std::stof(tokens[1]));
+std::string MeshLoader::cookedMeshPath(const std::string& filepath, uint64_t key) const {
+    if (cookedMeshDirectory.empty()) {
+        return filepath + ".vfmesh";
     }
-    return glm::vec2(0.0f);
+    // Named by content, so identical sources share one cooked file
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.vfmesh", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(cookedMeshDirectory) / name).string();
 }
 
-std::vector<std::string> MeshLoader::splitString(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
+bool MeshLoader::loadCookedMesh(const std::string& cookedPath, const std::string& filepath, uint64_t key,
+                                Mesh& mesh) {
+    MappedFile file;
+    if (!file.open(cookedPath)) {
+        return false;
+    }
+    const std::uint8_t* data = file.getData();
+    std::size_t size = file.getSize();
+    
+    CookedMeshHeader header{};
+    if (size >= sizeof(header)) {
+        std::memcpy(&header, data, sizeof(header));
+    }
+    if (size < sizeof(header) || std::memcmp(header.magic, CookedMeshMagic, sizeof(header.magic)) != 0 ||
+        header.version != CookedMeshVersion || header.importerVersion != ImporterVersion || header.key != key) {
+        VF_LOG_DEBUG("Cooked mesh '{}' is stale, importing '{}' again", cookedPath, filepath);
+        return false;
+    }
+    
+    CookedColumn<CookedSubmeshRecord> submeshes;
+    CookedColumn<CookedMaterialRecord> materials;
+    CookedColumn<char> strings;
+    CookedColumn<Vertex> vertices;
+    CookedColumn<std::uint32_t> indices;
+    CookedColumn<CookedDependencyRecord> dependencies;
+    bool valid = header.sectionCount <= (size - sizeof(header)) / sizeof(CookedSectionEntry) &&
+                 findCookedSection(data, size, header, CookedSection::Submeshes, submeshes) &&
+                 findCookedSection(data, size, header, CookedSection::Materials, materials) &&
+                 findCookedSection(data, size, header, CookedSection::Strings, strings) &&
+                 findCookedSection(data, size, header, CookedSection::Vertices, vertices) &&
+                 findCookedSection(data, size, header, CookedSection::Indices, indices) &&
+                 findCookedSection(data, size, header, CookedSection::Dependencies, dependencies);
+    for (const CookedSubmeshRecord& submesh : submeshes) {
+        valid = valid && isValidCookedString(submesh.name, strings.count) &&
+                submesh.firstVertex <= vertices.count && submesh.vertexCount <= vertices.count - submesh.firstVertex &&
+                submesh.firstIndex <= indices.count && submesh.indexCount <= indices.count - submesh.firstIndex &&
+                submesh.materialIndex < materials.count;
+        // Indices are local to the submesh, so each must name one of its vertices
+        for (std::uint32_t i = 0; valid && i < submesh.indexCount; ++i) {
+            valid = indices.records[submesh.firstIndex + i] < submesh.vertexCount;
+        }
+    }
+    for (const CookedMaterialRecord& material : materials) {
+        valid = valid && isValidCookedString(material.name, strings.count) &&
+                isValidCookedString(material.diffuseMap, strings.count) &&
+                isValidCookedString(material.normalMap, strings.count) &&
+                isValidCookedString(material.specularMap, strings.count) &&
+                isValidCookedString(material.ambientMap, strings.count);
+    }
+    for (const CookedDependencyRecord& dependency : dependencies) {
+        valid = valid && isValidCookedString(dependency.path, strings.count);
+    }
+    if (!valid) {
+        VF_LOG_WARN("Cooked mesh '{}' is corrupt, importing '{}' again", cookedPath, filepath);
+        return false;
+    }
     
-    while (std::getline(ss, token, delimiter)) {
-        if (!token.empty()) {
-            tokens.push_back(token);
+    auto string = [&strings](const CookedStringRef& ref) { return std::string(strings.records + ref.offset, ref.length); };
+    std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+    for (const CookedDependencyRecord& dependency : dependencies) {
+        if (hashFile((directory / string(dependency.path)).string()) != dependency.hash) {
+            VF_LOG_DEBUG("Material library '{}' changed, importing '{}' again", string(dependency.path), filepath);
+            return false;
         }
     }
     
-    return tokens;
+    mesh.materials.reserve(materials.count);
+    for (const CookedMaterialRecord& record : materials) {
+        Material& material = mesh.materials.emplace_back(string(record.name));
+        material.ambient = glm::vec3(record.ambient[0], record.ambient[1], record.ambient[2]);
+        material.diffuse = glm::vec3(record.diffuse[0], record.diffuse[1], record.diffuse[2]);
+        material.specular = glm::vec3(record.specular[0], record.specular[1], record.specular[2]);
+        material.shininess = record.shininess;
+        material.alpha = record.alpha;
+        material.diffuseMap = string(record.diffuseMap);
+        material.normalMap = string(record.normalMap);
+        material.specularMap = string(record.specularMap);
+        material.ambientMap = string(record.ambientMap);
+    }
+    mesh.submeshes.reserve(submeshes.count);
+    for (const CookedSubmeshRecord& record : submeshes) {
+        Submesh& submesh = mesh.submeshes.emplace_back(string(record.name));
+        submesh.materialIndex = record.materialIndex;
+        submesh.vertices.assign(vertices.records + record.firstVertex,
+                                vertices.records + record.firstVertex + record.vertexCount);
+        submesh.indices.assign(indices.records + record.firstIndex, indices.records + record.firstIndex + record.indexCount);
+    }
+    mesh.minBounds = glm::vec3(header.minBounds[0], header.minBounds[1], header.minBounds[2]);
+    mesh.maxBounds = glm::vec3(header.maxBounds[0], header.maxBounds[1], header.maxBounds[2]);
+    mesh.totalVertices = vertices.count;
+    mesh.totalIndices = indices.count;
+    
+    VF_LOG_DEBUG("Loaded cooked mesh '{}' for '{}'", cookedPath, filepath);
+    return true;
 }
 
-std::string MeshLoader::trimString(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) return "";
+bool MeshLoader::saveCookedMesh(const std::string& cookedPath, const std::string& filepath, uint64_t key,
+                                const Mesh& mesh) {
+    std::vector<CookedSubmeshRecord> submeshes;
+    std::vector<CookedMaterialRecord> materials;
+    std::vector<CookedDependencyRecord> dependencies;
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    std::string strings;
+    auto addString = [&strings](const std::string& value) {
+        CookedStringRef ref{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(value.size())};
+        strings += value;
+        return ref;
+    };
+    
+    vertices.reserve(mesh.totalVertices);
+    indices.reserve(mesh.totalIndices);
+    for (const Submesh& submesh : mesh.submeshes) {
+        submeshes.push_back(CookedSubmeshRecord{addString(submesh.name), submesh.materialIndex,
+                                                static_cast<std::uint32_t>(vertices.size()),
+                                                static_cast<std::uint32_t>(submesh.vertices.size()),
+                                                static_cast<std::uint32_t>(indices.size()),
+                                                static_cast<std::uint32_t>(submesh.indices.size()), 0});
+        vertices.insert(vertices.end(), submesh.vertices.begin(), submesh.vertices.end());
+        indices.insert(indices.end(), submesh.indices.begin(), submesh.indices.end());
+    }
+    for (const Material& material : mesh.materials) {
+        materials.push_back(CookedMaterialRecord{addString(material.name),
+            {material.ambient.r, material.ambient.g, material.ambient.b},
+            {material.diffuse.r, material.diffuse.g, material.diffuse.b},
+            {material.specular.r, material.specular.g, material.specular.b},
+            material.shininess, material.alpha,
+            addString(material.diffuseMap), addString(material.normalMap),
+            addString(material.specularMap), addString(material.ambientMap)});
+    }
+    std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+    for (const std::string& library : materialLibraries) {
+        dependencies.push_back(CookedDependencyRecord{addString(library), hashFile((directory / library).string())});
+    }
+    
+    struct Blob {
+        CookedSection type;
+        std::uint32_t count;
+        const void* data;
+        std::size_t size;
+    };
+    const Blob blobs[] = {
+        {CookedSection::Submeshes, static_cast<std::uint32_t>(submeshes.size()), submeshes.data(), submeshes.size() * sizeof(CookedSubmeshRecord)},
+        {CookedSection::Materials, static_cast<std::uint32_t>(materials.size()), materials.data(), materials.size() * sizeof(CookedMaterialRecord)},
+        {CookedSection::Strings, static_cast<std::uint32_t>(strings.size()), strings.data(), strings.size()},
+        {CookedSection::Vertices, static_cast<std::uint32_t>(vertices.size()), vertices.data(), vertices.size() * sizeof(Vertex)},
+        {CookedSection::Indices, static_cast<std::uint32_t>(indices.size()), indices.data(), indices.size() * sizeof(std::uint32_t)},
+        {CookedSection::Dependencies, static_cast<std::uint32_t>(dependencies.size()), dependencies.data(), dependencies.size() * sizeof(CookedDependencyRecord)},
+    };
+    const std::uint32_t sectionCount = static_cast<std::uint32_t>(std::size(blobs));
     
-    size_t end = str.find_last_not_of(" \t\r\n");
-    return str.substr(start, end - start + 1);
+    CookedMeshHeader header{};
+    std::memcpy(header.magic, CookedMeshMagic, sizeof(header.magic));
+    header.version = CookedMeshVersion;
+    header.importerVersion = ImporterVersion;
+    header.sectionCount = sectionCount;
+    header.key = key;
+    std::memcpy(header.minBounds, &mesh.minBounds.x, sizeof(header.minBounds));
+    std::memcpy(header.maxBounds, &mesh.maxBounds.x, sizeof(header.maxBounds));
+    
+    std::vector<CookedSectionEntry> sections(sectionCount);
+    std::uint64_t offset = sizeof(CookedMeshHeader) + sectionCount * sizeof(CookedSectionEntry);
+    for (std::uint32_t i = 0; i < sectionCount; ++i) {
+        offset = (offset + CookedMeshAlignment - 1) & ~(CookedMeshAlignment - 1);
+        sections[i] = CookedSectionEntry{static_cast<std::uint32_t>(blobs[i].type), blobs[i].count, offset, blobs[i].size};
+        offset += blobs[i].size;
+    }
+    
+    // Written aside and renamed into place, so a reader never maps half a file
+    std::error_code error;
+    if (!cookedMeshDirectory.empty()) {
+        std::filesystem::create_directories(cookedMeshDirectory, error);
+    }
+    std::string temporaryPath = cookedPath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(CookedSectionEntry));
+        std::uint64_t written = sizeof(CookedMeshHeader) + sectionCount * sizeof(CookedSectionEntry);
+        for (std::uint32_t i = 0; i < sectionCount; ++i) {
+            static const char padding[CookedMeshAlignment] = {};
+            file.write(padding, static_cast<std::streamsize>(sections[i].offset - written));
+            file.write(static_cast<const char*>(blobs[i].data), static_cast<std::streamsize>(blobs[i].size));
+            written = sections[i].offset + blobs[i].size;
+        }
+        if (!file.flush()) {
+            error = std::make_error_code(std::errc::io_error);
+        }
+    }
+    if (!error) {
+        std::filesystem::rename(temporaryPath, cookedPath, error);
+    }
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        VF_LOG_WARN("Failed to write cooked mesh '{}' for '{}'", cookedPath, filepath);
+        return false;
+    }
+    
+    VF_LOG_DEBUG("Cooked mesh '{}' to '{}' ({} bytes)", filepath, cookedPath, offset);
+    return true;
 }
 
 bool MeshLoader::fileExists(const std::string& filepath) {
@@ -676,15 +1370,344 @@ void MeshUtils::translateMesh(Mesh& mesh, const glm::vec3& translation) {
     mesh.calculateBounds();
 }
 
-// Optimization functions (placeholder implementations)
-void MeshUtils::removeDuplicateVertices(Mesh& mesh) {
-    // TODO: Implement duplicate vertex removal
-    VF_LOG_INFO("Duplicate vertex removal not implemented yet");
+namespace {
+
+// FIFO post-transform cache: a vertex stays resident until cacheSize
+// other vertices have been transformed after it. Returns the misses.
+uint32_t transformVertices(const uint32_t* indices, std::size_t count, std::vector<uint32_t>& timestamps,
+                           uint32_t& time, uint32_t cacheSize) {
+    uint32_t misses = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        uint32_t& timestamp = timestamps[indices[i]];
+        if (time - timestamp > cacheSize) {
+            timestamp = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+struct VertexCacheCounts {
+    std::size_t misses = 0;
+    std::size_t triangles = 0;
+    std::size_t vertices = 0;
+    
+    VertexCacheCounts& operator+=(const VertexCacheCounts& other) {
+        misses += other.misses;
+        triangles += other.triangles;
+        vertices += other.vertices;
+        return *this;
+    }
+    
+    VertexCacheStatistics statistics() const {
+        VertexCacheStatistics result;
+        result.acmr = triangles ? static_cast<float>(misses) / triangles : 0.0f;
+        result.atvr = vertices ? static_cast<float>(misses) / vertices : 0.0f;
+        return result;
+    }
+};
+
+VertexCacheCounts countVertexCache(const Submesh& submesh, uint32_t cacheSize) {
+    VertexCacheCounts counts;
+    counts.triangles = submesh.indices.size() / 3;
+    std::vector<uint32_t> timestamps(submesh.vertices.size(), 0);
+    uint32_t time = cacheSize + 1;
+    for (std::size_t i = 0; i < counts.triangles * 3; ++i) {
+        uint32_t index = submesh.indices[i];
+        if (index >= timestamps.size()) {
+            continue;
+        }
+        // Timestamps start past zero, so zero means never transformed
+        counts.vertices += timestamps[index] == 0;
+        counts.misses += transformVertices(&index, 1, timestamps, time, cacheSize);
+    }
+    return counts;
+}
+
+// Tipsify (Sander et al. 2007): fans around one vertex at a time and moves
+// on to the neighbour that will still be cached after its own fan, falling
+// back to recently used vertices and then to index order at dead ends.
+// clusters receives the first triangle of every run started at a dead end.
+std::vector<uint32_t> tipsifyIndices(const std::vector<uint32_t>& indices, std::size_t vertexCount,
+                                     uint32_t cacheSize, std::vector<std::size_t>& clusters) {
+    const std::size_t triangleCount = indices.size() / 3;
+    
+    // Triangles around every vertex, as ranges of one shared list
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        ++offsets[indices[i] + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> live(vertexCount);
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+        for (std::size_t v = 0; v < vertexCount; ++v) {
+            live[v] = offsets[v + 1] - offsets[v];
+        }
+    }
+    
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    uint32_t time = cacheSize + 1;
+    std::size_t scan = 0;
+    
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEnds.empty()) {
+            uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[vertex] > 0) {
+                return vertex;
+            }
+        }
+        while (scan < vertexCount && live[scan] == 0) {
+            ++scan;
+        }
+        return scan < vertexCount ? static_cast<int64_t>(scan) : -1;
+    };
+    
+    clusters.assign(1, 0);
+    int64_t fan = skipDeadEnd();
+    while (fan >= 0) {
+        candidates.clear();
+        for (uint32_t i = offsets[fan]; i < offsets[fan + 1]; ++i) {
+            uint32_t triangle = adjacency[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = 1;
+            const uint32_t* corners = &indices[triangle * 3];
+            result.insert(result.end(), corners, corners + 3);
+            for (int c = 0; c < 3; ++c) {
+                deadEnds.push_back(corners[c]);
+                candidates.push_back(corners[c]);
+                --live[corners[c]];
+            }
+            transformVertices(corners, 3, timestamps, time, cacheSize);
+        }
+        
+        // Oldest cached neighbour whose fan cannot push it out of the cache
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates) {
+            if (live[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - timestamps[vertex] + 2 * live[vertex] <= cacheSize) {
+                priority = time - timestamps[vertex];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+        if (next < 0) {
+            next = skipDeadEnd();
+            if (result.size() / 3 != clusters.back() && next >= 0) {
+                clusters.push_back(result.size() / 3);
+            }
+        }
+        fan = next;
+    }
+    return result;
+}
+
+// Sander et al.'s linear-speed overdraw pass. Clusters are split further
+// wherever a fresh cache already reaches close to the cluster's own ACMR,
+// then drawn in order of how far they face out from the mesh centre, so
+// likely occluders go first.
+void reorderClustersForOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices,
+                                std::vector<std::size_t> clusters, uint32_t cacheSize) {
+    constexpr float ACMRThreshold = 1.05f;
+    const std::size_t triangleCount = indices.size() / 3;
+    std::vector<uint32_t> timestamps(vertices.size(), 0);
+    uint32_t time = cacheSize + 1;
+    
+    std::vector<std::size_t> split;
+    clusters.push_back(triangleCount);
+    for (std::size_t c = 0; c + 1 < clusters.size(); ++c) {
+        std::size_t begin = clusters[c];
+        std::size_t end = clusters[c + 1];
+        time += cacheSize + 1;
+        float clusterACMR = static_cast<float>(transformVertices(&indices[begin * 3], (end - begin) * 3,
+                                                                 timestamps, time, cacheSize)) / (end - begin);
+        split.push_back(begin);
+        time += cacheSize + 1;
+        std::size_t misses = 0;
+        for (std::size_t t = begin; t + 1 < end; ++t) {
+            misses += transformVertices(&indices[t * 3], 3, timestamps, time, cacheSize);
+            if (static_cast<float>(misses) / (t + 1 - split.back()) <= clusterACMR * ACMRThreshold) {
+                split.push_back(t + 1);
+                time += cacheSize + 1;
+                misses = 0;
+            }
+        }
+    }
+    split.push_back(triangleCount);
+    
+    // Area-weighted centroid and normal of every cluster
+    std::vector<glm::vec3> centroids(split.size() - 1, glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(split.size() - 1, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (std::size_t c = 0; c + 1 < split.size(); ++c) {
+        float area = 0.0f;
+        for (std::size_t t = split[c]; t < split[c + 1]; ++t) {
+            const glm::vec3& a = vertices[indices[t * 3]].position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 normal = glm::cross(b - a, d - a);
+            float triangleArea = glm::length(normal);
+            centroids[c] += (a + b + d) * (triangleArea / 3.0f);
+            normals[c] += normal;
+            area += triangleArea;
+        }
+        meshCentroid += centroids[c];
+        meshArea += area;
+        centroids[c] = area > 0.0f ? centroids[c] / area : centroids[c];
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+    
+    std::vector<float> keys(split.size() - 1, 0.0f);
+    std::vector<std::size_t> order(split.size() - 1);
+    for (std::size_t c = 0; c < keys.size(); ++c) {
+        float length = glm::length(normals[c]);
+        keys[c] = length > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return keys[a] > keys[b]; });
+    
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (std::size_t c : order) {
+        result.insert(result.end(), indices.begin() + split[c] * 3, indices.begin() + split[c + 1] * 3);
+    }
+    result.insert(result.end(), indices.begin() + triangleCount * 3, indices.end());
+    indices = std::move(result);
+}
+
+} // namespace
+
+// Optimization functions
+void MeshUtils::removeDuplicateVertices(Mesh& mesh, float tolerance) {
+    // Every attribute rounded to a multiple of tolerance
+    constexpr std::size_t KeySize = 11;
+    const double scale = 1.0 / tolerance;
+    auto quantize = [scale](const Vertex& vertex, std::int64_t* key) {
+        const float values[KeySize] = {vertex.position.x, vertex.position.y, vertex.position.z,
+                                       vertex.normal.x,   vertex.normal.y,   vertex.normal.z,
+                                       vertex.texCoord.x, vertex.texCoord.y,
+                                       vertex.color.x,    vertex.color.y,    vertex.color.z};
+        for (std::size_t i = 0; i < KeySize; ++i) {
+            key[i] = std::llround(values[i] * scale);
+        }
+    };
+    
+    std::size_t removed = 0;
+    for (auto& submesh : mesh.submeshes) {
+        VertexIndexTable table(submesh.vertices.size());
+        std::vector<uint32_t> remap(submesh.vertices.size());
+        std::vector<Vertex> unique;
+        unique.reserve(submesh.vertices.size());
+        std::int64_t key[KeySize];
+        std::int64_t stored[KeySize];
+        for (std::size_t i = 0; i < submesh.vertices.size(); ++i) {
+            quantize(submesh.vertices[i], key);
+            auto next = static_cast<uint32_t>(unique.size());
+            remap[i] = table.insert(hashWords(key, KeySize), next, [&](uint32_t index) {
+                quantize(unique[index], stored);
+                return std::equal(key, key + KeySize, stored);
+            });
+            if (remap[i] == next) {
+                unique.push_back(submesh.vertices[i]);
+            }
+        }
+        
+        for (uint32_t& index : submesh.indices) {
+            if (index < remap.size()) {
+                index = remap[index];
+            }
+        }
+        removed += submesh.vertices.size() - unique.size();
+        submesh.vertices = std::move(unique);
+    }
+    
+    mesh.totalVertices = 0;
+    for (const auto& submesh : mesh.submeshes) {
+        mesh.totalVertices += static_cast<uint32_t>(submesh.vertices.size());
+    }
+    VF_LOG_DEBUG("Removed {} duplicate vertices from mesh '{}'", removed, mesh.name);
+}
+
+void MeshUtils::optimizeIndices(Mesh& mesh, bool reduceOverdraw, uint32_t cacheSize) {
+    constexpr uint32_t Unused = 0xFFFFFFFF;
+    VertexCacheCounts original;
+    VertexCacheCounts tipsified;
+    VertexCacheCounts overdrawn;
+    VertexCacheCounts fetched;
+    
+    for (auto& submesh : mesh.submeshes) {
+        bool valid = std::all_of(submesh.indices.begin(), submesh.indices.end(),
+                                 [&](uint32_t index) { return index < submesh.vertices.size(); });
+        if (!valid || submesh.indices.size() % 3 != 0) {
+            VF_LOG_WARN("Skipping index optimization of submesh '{}': not a valid triangle list", submesh.name);
+            continue;
+        }
+        original += countVertexCache(submesh, cacheSize);
+        
+        std::vector<std::size_t> clusters;
+        submesh.indices = tipsifyIndices(submesh.indices, submesh.vertices.size(), cacheSize, clusters);
+        tipsified += countVertexCache(submesh, cacheSize);
+        
+        if (reduceOverdraw) {
+            reorderClustersForOverdraw(submesh.indices, submesh.vertices, std::move(clusters), cacheSize);
+            overdrawn += countVertexCache(submesh, cacheSize);
+        }
+        
+        // Vertex fetch: store vertices in the order the indices first use
+        // them, unreferenced ones last
+        std::vector<uint32_t> remap(submesh.vertices.size(), Unused);
+        std::vector<Vertex> vertices;
+        vertices.reserve(submesh.vertices.size());
+        for (uint32_t& index : submesh.indices) {
+            if (remap[index] == Unused) {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(submesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        for (std::size_t v = 0; v < submesh.vertices.size(); ++v) {
+            if (remap[v] == Unused) {
+                vertices.push_back(submesh.vertices[v]);
+            }
+        }
+        submesh.vertices = std::move(vertices);
+        fetched += countVertexCache(submesh, cacheSize);
+    }
+    
+    auto report = [&](const char* pass, const VertexCacheCounts& before, const VertexCacheCounts& after) {
+        VertexCacheStatistics from = before.statistics();
+        VertexCacheStatistics to = after.statistics();
+        VF_LOG_DEBUG("{} on mesh '{}': ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", pass, mesh.name, from.acmr,
+                     to.acmr, from.atvr, to.atvr);
+    };
+    report("Vertex cache pass", original, tipsified);
+    if (reduceOverdraw) {
+        report("Overdraw pass", tipsified, overdrawn);
+    }
+    report("Vertex fetch pass", reduceOverdraw ? overdrawn : tipsified, fetched);
 }
 
-void MeshUtils::optimizeIndices(Mesh& mesh) {
-    // TODO: Implement index optimization
-    VF_LOG_INFO("Index optimization not implemented yet");
+VertexCacheStatistics MeshUtils::analyzeVertexCache(const Submesh& submesh, uint32_t cacheSize) {
+    return countVertexCache(submesh, cacheSize).statistics();
 }
 
 void MeshUtils::calculateTangents(Mesh& mesh) {
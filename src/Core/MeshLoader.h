@@ -10,6 +10,8 @@
 namespace VaporFrame {
 namespace Core {
 
+class JobSystem;
+
 // Vertex data structure
 struct Vertex {
     glm::vec3 position;
@@ -87,6 +89,31 @@ public:
     std::shared_ptr<Mesh> loadOBJ(const std::string& filepath);
     std::shared_ptr<Mesh> loadPLY(const std::string& filepath);
     
+    // Parses an OBJ file into mesh as written, without optimize(). The file
+    // is memory-mapped and scanned in place, with no allocation per line.
+    // With a job system, slices of the file are parsed in parallel and
+    // stitched into the same mesh a serial parse gives.
+    bool parseOBJ(const std::string& filepath, Mesh& mesh);
+    
+    // nullptr, the default, parses on the calling thread
+    void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+    JobSystem* getJobSystem() const { return jobSystem; }
+    
+    // Cooked meshes. loadMesh saves every imported mesh as a binary file and
+    // maps that instead of importing again for as long as the source and its
+    // material libraries hash the same. Cooked files go next to the source,
+    // or into the cooked mesh directory when one is set.
+    void setCookedMeshCache(bool enabled) { cookedMeshCache = enabled; }
+    bool isCookedMeshCacheEnabled() const { return cookedMeshCache; }
+    void setCookedMeshDirectory(const std::string& directory) { cookedMeshDirectory = directory; }
+    const std::string& getCookedMeshDirectory() const { return cookedMeshDirectory; }
+    // Where the source's current contents cook to, empty if it can't be read
+    std::string getCookedMeshPath(const std::string& filepath);
+    
+    // Part of every cooked mesh's key; bump it whenever the import or its
+    // optimization passes produce different meshes
+    static constexpr uint32_t ImporterVersion = 1;
+    
     // Utility functions
     bool fileExists(const std::string& filepath);
     std::string getFileExtension(const std::string& filepath);
@@ -109,22 +136,31 @@ private:
     MeshLoader& operator=(const MeshLoader&) = delete;
     
     // Internal loading functions
-    bool parseOBJ(const std::string& filepath, Mesh& mesh);
     bool parseMTL(const std::string& filepath, std::vector<Material>& materials);
     bool parsePLY(const std::string& filepath, Mesh& mesh);
+    bool hashMeshSource(const std::string& filepath, uint64_t& key);
+    std::string cookedMeshPath(const std::string& filepath, uint64_t key) const;
+    bool loadCookedMesh(const std::string& cookedPath, const std::string& filepath, uint64_t key, Mesh& mesh);
+    bool saveCookedMesh(const std::string& cookedPath, const std::string& filepath, uint64_t key, const Mesh& mesh);
     
-    // Helper functions
-    void processOBJFace(const std::string& line, std::vector<glm::vec3>& positions, 
-                       std::vector<glm::vec3>& normals, std::vector<glm::vec2>& texCoords,
-                       std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
-    glm::vec3 parseVec3(const std::string& str);
-    glm::vec2 parseVec2(const std::string& str);
-    std::vector<std::string> splitString(const std::string& str, char delimiter);
-    std::string trimString(const std::string& str);
+    // Files are parsed in slices of at least this many bytes
+    static constexpr std::size_t OBJChunkMinimumSize = 1 << 20;
     
     // Cache
     std::unordered_map<std::string, std::shared_ptr<Mesh>> meshCache;
     std::string lastError;
+    JobSystem* jobSystem = nullptr;
+    bool cookedMeshCache = true;
+    std::string cookedMeshDirectory;
+    // Libraries named by the last parseOBJ, as written in the file
+    std::vector<std::string> materialLibraries;
+};
+
+// Post-transform vertex cache efficiency of an index buffer, simulated with
+// a FIFO cache
+struct VertexCacheStatistics {
+    float acmr = 0.0f;  // Vertices transformed per triangle, 0.5 is ideal
+    float atvr = 0.0f;  // Vertices transformed per vertex referenced, 1.0 is ideal
 };
 
 // Mesh utilities
@@ -144,9 +180,15 @@ public:
     static void rotateMesh(Mesh& mesh, const glm::vec3& rotation);
     static void translateMesh(Mesh& mesh, const glm::vec3& translation);
     
-    // Optimization
-    static void removeDuplicateVertices(Mesh& mesh);
-    static void optimizeIndices(Mesh& mesh);
+    // Optimization. Merges vertices whose attributes all round to the same
+    // multiple of tolerance, keeping the first, and remaps the indices.
+    static void removeDuplicateVertices(Mesh& mesh, float tolerance = 1e-6f);
+    // Reorders triangles for the post-transform vertex cache (Tipsify),
+    // optionally sorts the resulting clusters so outward-facing ones draw
+    // first to cut overdraw, then lays vertices out in first-use order.
+    // Triangles and their winding are kept; only their order changes.
+    static void optimizeIndices(Mesh& mesh, bool reduceOverdraw = false, uint32_t cacheSize = 16);
+    static VertexCacheStatistics analyzeVertexCache(const Submesh& submesh, uint32_t cacheSize = 16);
     static void calculateTangents(Mesh& mesh);
     
     // Validation
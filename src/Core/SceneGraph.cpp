@@ -1,6 +1,9 @@
 #include "SceneGraph.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
 #include "Logger.h"
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -33,21 +36,39 @@ void TransformComponent::setRotationQuaternion(const glm::quat& quat) {
 }
 
 glm::quat TransformComponent::getRotationQuaternion() const {
-    return glm::quat(glm::radians(rotation));
+    // rotation is public, so compare rather than rely on the setters
+    if (rotation != matrices->orientationEuler) {
+        matrices->orientation = glm::quat(glm::radians(rotation));
+        matrices->orientationEuler = rotation;
+    }
+    return matrices->orientation;
 }
 
 glm::mat4 TransformComponent::getLocalTransform() {
     if (transformDirty) {
         updateLocalTransform();
     }
-    return localTransform;
+    return matrices->local;
 }
 
 glm::mat4 TransformComponent::getWorldTransform() {
-    if (worldTransformDirty) {
-        updateWorldTransform();
+    // A flag anywhere up the chain means this matrix is stale. Walk up
+    // iteratively so deep hierarchies don't recurse per level.
+    thread_local std::vector<TransformComponent*> chain;
+    chain.clear();
+    std::size_t stale = 0;
+    for (TransformComponent* transform = this; transform; transform = transform->getParentTransform()) {
+        chain.push_back(transform);
+        if (transform->transformDirty || transform->worldTransformDirty) {
+            stale = chain.size();
+        }
     }
-    return worldTransform;
+    
+    // Recompute from the highest stale ancestor down to this one
+    for (std::size_t i = stale; i-- > 0;) {
+        chain[i]->updateWorldTransform(i + 1 < chain.size() ? chain[i + 1] : nullptr);
+    }
+    return matrices->world;
 }
 
 void TransformComponent::lookAt(const glm::vec3& target, const glm::vec3& up) {
@@ -69,39 +90,179 @@ void TransformComponent::rotate(const glm::vec3& axis, float angle) {
 }
 
 void TransformComponent::updateLocalTransform() {
-    glm::mat4 translation = glm::translate(glm::mat4(1.0f), position);
-    glm::mat4 rotation = glm::mat4_cast(getRotationQuaternion());
-    glm::mat4 scaling = glm::scale(glm::mat4(1.0f), scale);
-    
-    localTransform = translation * rotation * scaling;
+    matrices->local = TransformKernels::compose(position, getRotationQuaternion(), scale);
     transformDirty = false;
 }
 
-void TransformComponent::updateWorldTransform() {
+TransformComponent* TransformComponent::getParentTransform() const {
     if (owner && owner->getParent()) {
-        TransformComponent* parentTransform = owner->getParent()->getTransform();
-        if (parentTransform) {
-            worldTransform = parentTransform->getWorldTransform() * getLocalTransform();
-        } else {
-            worldTransform = getLocalTransform();
-        }
+        return owner->getParent()->getTransform();
+    }
+    return nullptr;
+}
+
+void TransformComponent::updateWorldTransform(TransformComponent* parentTransform) {
+    if (parentTransform) {
+        matrices->world = parentTransform->matrices->world * getLocalTransform();
     } else {
-        worldTransform = getLocalTransform();
+        matrices->world = getLocalTransform();
     }
     worldTransformDirty = false;
+    worldTransformChanged = true;
+    
+    // Children were computed from the old matrix
+    if (owner) {
+        for (auto& child : owner->getChildren()) {
+            if (TransformComponent* childTransform = child->getTransform()) {
+                childTransform->worldTransformDirty = true;
+            }
+        }
+    }
+}
+
+// TransformSystem Implementation
+void TransformSystem::update() {
+    if (orderDirty) {
+        rebuild();
+    }
+    
+    // Parents come first, so a parent's flag is final by the time its
+    // children are visited
+    staleIndices.clear();
+    localIndices.clear();
+    ComponentStorage<TransformComponent>* storage = scene.findStorage<TransformComponent>();
+    for (std::uint32_t i = 0; i < transforms.size(); ++i) {
+        TransformComponent& transform = *transforms[i];
+        std::int32_t parent = parents[i];
+        bool stale = transform.transformDirty || transform.worldTransformDirty || (parent >= 0 && dirty[parent]);
+        dirty[i] = stale;
+        if (stale || transform.worldTransformChanged) {
+            storage->markChangedAt(storageIndices[i]);
+            transform.worldTransformChanged = false;
+        }
+        if (!stale) continue;
+        
+        staleIndices.push_back(i);
+        if (transform.transformDirty) {
+            localIndices.push_back(i);
+        }
+    }
+    
+    composeLocalTransforms();
+    
+    for (std::uint32_t i : staleIndices) {
+        std::int32_t parent = parents[i];
+        if (parent >= 0) {
+            matrices[i]->world = matrices[parent]->world * matrices[i]->local;
+        } else {
+            matrices[i]->world = matrices[i]->local;
+        }
+        transforms[i]->worldTransformDirty = false;
+    }
+    lastUpdatedCount = staleIndices.size();
+}
+
+void TransformSystem::composeLocalTransforms() {
+    std::size_t count = localIndices.size();
+    if (count == 0) return;
+    
+    // Gather into structure-of-arrays lanes for the kernel
+    batchInput.resize(count * 10);
+    batchOutput.resize(count);
+    float* lanes[10];
+    for (std::size_t lane = 0; lane < 10; ++lane) {
+        lanes[lane] = batchInput.data() + lane * count;
+    }
+    for (std::size_t n = 0; n < count; ++n) {
+        const TransformComponent& transform = *transforms[localIndices[n]];
+        glm::quat rotation = transform.getRotationQuaternion();
+        lanes[0][n] = transform.position.x;
+        lanes[1][n] = transform.position.y;
+        lanes[2][n] = transform.position.z;
+        lanes[3][n] = rotation.x;
+        lanes[4][n] = rotation.y;
+        lanes[5][n] = rotation.z;
+        lanes[6][n] = rotation.w;
+        lanes[7][n] = transform.scale.x;
+        lanes[8][n] = transform.scale.y;
+        lanes[9][n] = transform.scale.z;
+    }
+    
+    TransformBatch batch;
+    batch.positionX = lanes[0];
+    batch.positionY = lanes[1];
+    batch.positionZ = lanes[2];
+    batch.rotationX = lanes[3];
+    batch.rotationY = lanes[4];
+    batch.rotationZ = lanes[5];
+    batch.rotationW = lanes[6];
+    batch.scaleX = lanes[7];
+    batch.scaleY = lanes[8];
+    batch.scaleZ = lanes[9];
+    batch.matrices = batchOutput.data();
+    batch.count = count;
+    TransformKernels::compose(batch);
+    
+    for (std::size_t n = 0; n < count; ++n) {
+        TransformComponent& transform = *transforms[localIndices[n]];
+        matrices[localIndices[n]]->local = batchOutput[n];
+        transform.transformDirty = false;
+    }
+}
+
+void TransformSystem::rebuild() {
+    transforms.clear();
+    matrices.clear();
+    parents.clear();
+    storageIndices.clear();
+    ComponentStorage<TransformComponent>* storage = scene.findStorage<TransformComponent>();
+    
+    // Breadth-first from the roots, which sorts entries by depth. A node
+    // without a transform breaks the chain, as it did for the lazy path.
+    std::vector<SceneNode*> nodes;
+    std::vector<std::int32_t> nodeParents;
+    for (const auto& root : scene.getRootEntities()) {
+        nodes.push_back(root.get());
+        nodeParents.push_back(-1);
+    }
+    for (std::size_t head = 0; head < nodes.size(); ++head) {
+        SceneNode* node = nodes[head];
+        std::int32_t index = -1;
+        if (TransformComponent* transform = node->getTransform()) {
+            index = static_cast<std::int32_t>(transforms.size());
+            transforms.push_back(transform);
+            matrices.push_back(transform->matrices.get());
+            parents.push_back(nodeParents[head]);
+            storageIndices.push_back(storage->indexOf(node->getID()));
+        }
+        for (const auto& child : node->getChildren()) {
+            nodes.push_back(child.get());
+            nodeParents.push_back(index);
+        }
+    }
+    
+    dirty.assign(transforms.size(), 0);
+    orderDirty = false;
 }
 
 // SceneNode Implementation
-SceneNode::SceneNode(EntityID id, const std::string& name)
-    : id(id), name(name) {
+SceneNode::SceneNode(EntityID id, const std::string& name, Scene* scene)
+    : id(id), name(name), scene(scene) {
     // Automatically add a transform component
     addComponent<TransformComponent>();
 }
 
 SceneNode::~SceneNode() {
+    if (scene) {
+        scene->onEntityDetached(this);
+    }
+    
     // Remove all components
-    for (auto& [type, component] : components) {
-        component->onDetach(this);
+    for (auto& record : components) {
+        resolve(record)->onDetach(this);
+        if (scene) {
+            record.storageIn(*scene).remove(id);
+        }
     }
     components.clear();
     
@@ -109,6 +270,37 @@ SceneNode::~SceneNode() {
     removeAllChildren();
 }
 
+Component* SceneNode::resolve(const ComponentRecord& record) const {
+    return scene ? record.storageIn(*scene).getComponent(id) : record.detached.get();
+}
+
+void SceneNode::setScene(Scene* newScene) {
+    if (scene != newScene) {
+        if (scene) {
+            scene->onEntityDetached(this);
+        }
+        // Keeps the ID if its slot is free in the new scene
+        EntityID newId = newScene ? newScene->claimEntityID(id) : id;
+        for (auto& record : components) {
+            if (scene) {
+                record.detached = record.storageIn(*scene).release(id);
+            }
+            if (newScene) {
+                record.storageIn(*newScene).adopt(newId, std::move(record.detached));
+            }
+        }
+        id = newId;
+        scene = newScene;
+        if (scene) {
+            scene->onEntityAttached(this);
+        }
+    }
+    
+    for (auto& child : children) {
+        child->setScene(newScene);
+    }
+}
+
 void SceneNode::setParent(SceneNode* newParent) {
     if (parent == newParent) return;
     
@@ -137,12 +329,22 @@ void SceneNode::setParent(SceneNode* newParent) {
     if (auto transform = getTransform()) {
         transform->worldTransformDirty = true;
     }
+    if (scene) {
+        scene->transformSystem.invalidate();
+    }
 }
 
 void SceneNode::addChild(std::unique_ptr<SceneNode> child) {
     if (child) {
+        // A root entity adopted by pointer would be owned twice
+        if (child->scene && !child->parent) {
+            child->scene->releaseRootEntity(child.get());
+        }
         child->setParent(this);
         child->setScene(scene);
+        if (scene) {
+            scene->reindexName(child.get());
+        }
         children.push_back(std::move(child));
     }
 }
@@ -165,11 +367,21 @@ std::unique_ptr<SceneNode> SceneNode::removeChild(EntityID childId) {
 }
 
 void SceneNode::removeAllChildren() {
-    for (auto& child : children) {
-        child->setParent(nullptr);
-        child->setScene(nullptr);
-    }
+    // Children are destroyed here, so their components are removed from the
+    // scene's storage directly rather than moved out first. Take the whole
+    // subtree apart first so destroying a deep hierarchy doesn't recurse
+    // once per level.
+    std::vector<std::unique_ptr<SceneNode>> subtree = std::move(children);
     children.clear();
+    for (std::size_t i = 0; i < subtree.size(); ++i) {
+        SceneNode* node = subtree[i].get();
+        node->parent = nullptr;
+        for (auto& child : node->children) {
+            subtree.push_back(std::move(child));
+        }
+        node->children.clear();
+    }
+    subtree.clear();
 }
 
 TransformComponent* SceneNode::getTransform() {
@@ -184,8 +396,8 @@ void SceneNode::update(float deltaTime) {
     if (!active) return;
     
     // Update all components
-    for (auto& [type, component] : components) {
-        component->onUpdate(deltaTime);
+    for (auto& record : components) {
+        resolve(record)->onUpdate(deltaTime);
     }
     
     // Update all children
@@ -194,12 +406,44 @@ void SceneNode::update(float deltaTime) {
     }
 }
 
+void SceneNode::update(float deltaTime, JobSystem& jobs, int splitLevels) {
+    if (!active) return;
+    
+    for (auto& record : components) {
+        resolve(record)->onUpdate(deltaTime);
+    }
+    
+    if (splitLevels <= 0) {
+        for (auto& child : children) {
+            child->update(deltaTime);
+        }
+        return;
+    }
+    if (children.size() < 2) {
+        for (auto& child : children) {
+            child->update(deltaTime, jobs, splitLevels);
+        }
+        return;
+    }
+    
+    // Children read this world transform; refresh it now so concurrent
+    // getWorldTransform calls below don't both recompute it
+    if (TransformComponent* transform = getTransform()) {
+        transform->getWorldTransform();
+    }
+    jobs.parallelFor(children.size(), 0, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            children[i]->update(deltaTime, jobs, splitLevels - 1);
+        }
+    });
+}
+
 void SceneNode::render() {
     if (!active) return;
     
     // Render all components
-    for (auto& [type, component] : components) {
-        component->onRender();
+    for (auto& record : components) {
+        resolve(record)->onRender();
     }
     
     // Render all children
@@ -208,7 +452,30 @@ void SceneNode::render() {
     }
 }
 
+void SceneNode::setName(const std::string& newName) {
+    if (scene) {
+        scene->unindexName(this);
+    }
+    name = newName;
+    if (scene) {
+        scene->indexName(this);
+    }
+}
+
 SceneNode* SceneNode::findChild(const std::string& name) {
+    if (scene) {
+        if (SceneNode* child = scene->findNamedChild(id, name)) {
+            return child;
+        }
+        for (SceneNode* node : scene->findEntities(name)) {
+            for (SceneNode* ancestor = node->parent; ancestor; ancestor = ancestor->parent) {
+                if (ancestor == this) {
+                    return node;
+                }
+            }
+        }
+        return nullptr;
+    }
     for (auto& child : children) {
         if (child->getName() == name) {
             return child.get();
@@ -222,19 +489,24 @@ SceneNode* SceneNode::findChild(const std::string& name) {
 }
 
 const SceneNode* SceneNode::findChild(const std::string& name) const {
-    for (const auto& child : children) {
-        if (child->getName() == name) {
-            return child.get();
-        }
-        // Recursive search
-        if (auto found = child->findChild(name)) {
-            return found;
-        }
-    }
-    return nullptr;
+    return const_cast<SceneNode*>(this)->findChild(name);
+}
+
+SceneNode* SceneNode::findChildByPath(const std::string& path) const {
+    return scene ? scene->resolvePath(id, path) : nullptr;
 }
 
 SceneNode* SceneNode::findChild(EntityID id) {
+    if (scene) {
+        // Look the entity up and check this node is one of its ancestors
+        SceneNode* node = scene->getEntity(id);
+        for (SceneNode* ancestor = node ? node->parent : nullptr; ancestor; ancestor = ancestor->parent) {
+            if (ancestor == this) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
     for (auto& child : children) {
         if (child->getID() == id) {
             return child.get();
@@ -248,40 +520,52 @@ SceneNode* SceneNode::findChild(EntityID id) {
 }
 
 const SceneNode* SceneNode::findChild(EntityID id) const {
-    for (const auto& child : children) {
-        if (child->getID() == id) {
-            return child.get();
-        }
-        // Recursive search
-        if (auto found = child->findChild(id)) {
-            return found;
-        }
-    }
-    return nullptr;
+    return const_cast<SceneNode*>(this)->findChild(id);
 }
 
 // Scene Implementation
-Scene::Scene(const std::string& name) : name(name) {
+namespace {
+
+// Tells scenes apart in the per-thread cache even if one reuses another's
+// address
+std::atomic<std::uint64_t> nextSceneSerial{1};
+
+struct CommandBufferCache {
+    std::uint64_t sceneSerial = 0;
+    SceneCommandBuffer* buffer = nullptr;
+};
+thread_local CommandBufferCache commandBufferCache;
+
+// Name index key for the children of parent with one name
+std::uint64_t siblingKey(EntityID parent, std::uint32_t nameId) {
+    return (static_cast<std::uint64_t>(parent) << 32) | nameId;
+}
+
+} // namespace
+
+Scene::Scene(const std::string& name)
+    : name(name), transformSystem(*this), serial(nextSceneSerial.fetch_add(1, std::memory_order_relaxed)) {
     VF_LOG_DEBUG("Scene '{}' created", name);
 }
 
 Scene::~Scene() {
     VF_LOG_DEBUG("Scene '{}' destroyed", name);
     rootEntities.clear();
-    entityMap.clear();
 }
 
 SceneNode* Scene::createEntity(const std::string& name) {
-    EntityID id = generateEntityID();
-    return createEntity(id, name);
+    return createEntity(InvalidEntityID, name);
 }
 
-SceneNode* Scene::createEntity(EntityID id, const std::string& name) {
-    auto entity = std::make_unique<SceneNode>(id, name);
+SceneNode* Scene::createEntity(EntityID requestedId, const std::string& name) {
+    EntityID id = claimEntityID(requestedId);
+    if (id == InvalidEntityID) {
+        return nullptr;
+    }
+    auto entity = std::make_unique<SceneNode>(id, name, this);
     SceneNode* ptr = entity.get();
     
-    registerEntity(ptr);
-    entity->setScene(this);
+    onEntityAttached(ptr);
     rootEntities.push_back(std::move(entity));
     
     VF_LOG_DEBUG("Created entity '{}' (ID: {}) in scene '{}'", name, id, this->name);
@@ -289,18 +573,24 @@ SceneNode* Scene::createEntity(EntityID id, const std::string& name) {
 }
 
 void Scene::destroyEntity(EntityID id) {
-    auto it = entityMap.find(id);
-    if (it != entityMap.end()) {
-        destroyEntity(it->second);
-    }
+    destroyEntity(getEntity(id));
 }
 
 void Scene::destroyEntity(SceneNode* node) {
     if (!node) return;
     
-    // Remove from parent if it has one
-    if (node->getParent()) {
-        node->getParent()->removeChild(node->getID());
+    // Remove from parent if it has one. The node is destroyed here, so it
+    // stays in the scene until its destructor removes its components and
+    // frees its ID, and those of its children.
+    if (SceneNode* parent = node->getParent()) {
+        auto& siblings = parent->children;
+        auto it = std::find_if(siblings.begin(), siblings.end(),
+                              [node](const std::unique_ptr<SceneNode>& child) {
+                                  return child.get() == node;
+                              });
+        if (it != siblings.end()) {
+            siblings.erase(it);
+        }
     } else {
         // Remove from root entities
         auto it = std::find_if(rootEntities.begin(), rootEntities.end(),
@@ -308,54 +598,132 @@ void Scene::destroyEntity(SceneNode* node) {
                                   return entity.get() == node;
                               });
         if (it != rootEntities.end()) {
-            unregisterEntity(node);
             rootEntities.erase(it);
         }
     }
 }
 
-SceneNode* Scene::getEntity(EntityID id) {
-    auto it = entityMap.find(id);
-    return it != entityMap.end() ? it->second : nullptr;
+void Scene::destroyEntities(std::vector<SceneNode*> nodes) {
+    nodes.erase(std::remove(nodes.begin(), nodes.end(), nullptr), nodes.end());
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    auto doomed = [&nodes](const SceneNode* node) {
+        return std::binary_search(nodes.begin(), nodes.end(), node);
+    };
+    
+    // Entities under a doomed ancestor go with it; the rest are erased from
+    // their parent's children, one pass per parent
+    std::vector<SceneNode*> parents;
+    bool hasRoots = false;
+    for (SceneNode* node : nodes) {
+        bool covered = false;
+        for (SceneNode* ancestor = node->parent; ancestor && !covered; ancestor = ancestor->parent) {
+            covered = doomed(ancestor);
+        }
+        if (covered) continue;
+        if (node->parent) {
+            parents.push_back(node->parent);
+        } else {
+            hasRoots = true;
+        }
+    }
+    std::sort(parents.begin(), parents.end());
+    parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+    
+    auto eraseDoomed = [&doomed](std::vector<std::unique_ptr<SceneNode>>& siblings) {
+        siblings.erase(std::remove_if(siblings.begin(), siblings.end(),
+                                      [&doomed](const std::unique_ptr<SceneNode>& node) { return doomed(node.get()); }),
+                       siblings.end());
+    };
+    for (SceneNode* parent : parents) {
+        eraseDoomed(parent->children);
+    }
+    if (hasRoots) {
+        eraseDoomed(rootEntities);
+    }
 }
 
-const SceneNode* Scene::getEntity(EntityID id) const {
-    auto it = entityMap.find(id);
-    return it != entityMap.end() ? it->second : nullptr;
+bool Scene::reparentEntity(SceneNode* entity, SceneNode* parent) {
+    if (!entity || entity->scene != this || (parent && parent->scene != this)) return false;
+    if (entity->parent == parent) return true;
+    for (SceneNode* ancestor = parent; ancestor; ancestor = ancestor->parent) {
+        if (ancestor == entity) return false;
+    }
+    
+    auto& siblings = entity->parent ? entity->parent->children : rootEntities;
+    auto it = std::find_if(siblings.begin(), siblings.end(),
+                          [entity](const std::unique_ptr<SceneNode>& node) { return node.get() == entity; });
+    if (it == siblings.end()) return false;
+    std::unique_ptr<SceneNode> owned = std::move(*it);
+    siblings.erase(it);
+    
+    entity->parent = parent;
+    (parent ? parent->children : rootEntities).push_back(std::move(owned));
+    reindexName(entity);
+    if (TransformComponent* transform = entity->getTransform()) {
+        transform->worldTransformDirty = true;
+    }
+    transformSystem.invalidate();
+    return true;
+}
+
+void Scene::clear() {
+    // Children go with their roots, and each node takes its components and
+    // frees its ID
+    rootEntities.clear();
+    // Nothing is named any more, so the interned names can go too
+    nameIds.clear();
+    entitiesByName.clear();
 }
 
 SceneNode* Scene::findEntity(const std::string& name) {
-    for (auto& entity : rootEntities) {
-        if (entity->getName() == name) {
-            return entity.get();
-        }
-        if (auto found = entity->findChild(name)) {
-            return found;
-        }
-    }
-    return nullptr;
+    const std::vector<SceneNode*>& entities = findEntities(name);
+    return entities.empty() ? nullptr : entities.front();
 }
 
 const SceneNode* Scene::findEntity(const std::string& name) const {
-    for (const auto& entity : rootEntities) {
-        if (entity->getName() == name) {
-            return entity.get();
-        }
-        if (auto found = entity->findChild(name)) {
-            return found;
-        }
-    }
-    return nullptr;
+    const std::vector<SceneNode*>& entities = findEntities(name);
+    return entities.empty() ? nullptr : entities.front();
+}
+
+const std::vector<SceneNode*>& Scene::findEntities(const std::string& name) const {
+    static const std::vector<SceneNode*> none;
+    std::uint32_t nameId = findNameId(name);
+    return nameId != SceneNode::NoName ? entitiesByName[nameId] : none;
+}
+
+SceneNode* Scene::findEntityByPath(const std::string& path) const {
+    return resolvePath(InvalidEntityID, path);
 }
 
 void Scene::update(float deltaTime) {
     VF_LOG_DEBUG("Scene '{}' updating entities", name);
-    for (auto& entity : rootEntities) {
-        entity->update(deltaTime);
+    if (jobSystem) {
+        jobSystem->parallelFor(rootEntities.size(), 0, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                rootEntities[i]->update(deltaTime, *jobSystem);
+            }
+        });
+    } else {
+        for (auto& entity : rootEntities) {
+            entity->update(deltaTime);
+        }
     }
+    playbackCommands();
+    compactStorage();
+    transformSystem.update();
     VF_LOG_DEBUG("Scene '{}' finished updating entities", name);
 }
 
+void Scene::compactStorage() {
+    std::uint32_t transformType = componentTypeId<TransformComponent>();
+    for (std::uint32_t typeId = 0; typeId < storages.size(); ++typeId) {
+        if (storages[typeId] && storages[typeId]->compact() && typeId == transformType) {
+            transformSystem.invalidate();
+        }
+    }
+}
+
 void Scene::render() {
     VF_LOG_DEBUG("Scene '{}' rendering entities", name);
     for (auto& entity : rootEntities) {
@@ -366,7 +734,6 @@ void Scene::render() {
 
 void Scene::addRootEntity(std::unique_ptr<SceneNode> entity) {
     if (entity) {
-        registerEntity(entity.get());
         entity->setScene(this);
         rootEntities.push_back(std::move(entity));
     }
@@ -381,7 +748,6 @@ std::unique_ptr<SceneNode> Scene::removeRootEntity(EntityID id) {
     if (it != rootEntities.end()) {
         std::unique_ptr<SceneNode> entity = std::move(*it);
         rootEntities.erase(it);
-        unregisterEntity(entity.get());
         entity->setScene(nullptr);
         return entity;
     }
@@ -390,73 +756,800 @@ std::unique_ptr<SceneNode> Scene::removeRootEntity(EntityID id) {
 }
 
 SceneNode* Scene::createChildEntity(SceneNode* parent, const std::string& name) {
+    return createChildEntity(parent, InvalidEntityID, name);
+}
+
+SceneNode* Scene::createChildEntity(SceneNode* parent, EntityID requestedId, const std::string& name) {
     if (!parent) return nullptr;
-    EntityID id = generateEntityID();
-    auto child = std::make_unique<SceneNode>(id, name);
+    EntityID id = claimEntityID(requestedId);
+    if (id == InvalidEntityID) {
+        return nullptr;
+    }
+    auto child = std::make_unique<SceneNode>(id, name, this);
     SceneNode* ptr = child.get();
-    registerEntity(ptr);
-    child->setScene(this);
-    parent->addChild(std::move(child));
+    // Link directly; addChild would look for the child among the roots
+    child->parent = parent;
+    onEntityAttached(ptr);
+    parent->children.push_back(std::move(child));
     return ptr;
 }
 
-std::vector<SceneNode*> Scene::getEntitiesWithComponent(const std::type_index& componentType) {
-    std::vector<SceneNode*> entities;
+FrameVector<SceneNode*> Scene::getEntitiesWithComponent(const std::type_index& componentType) {
+    // No storage means no entity has ever had the component
+    auto it = typeIds.find(componentType);
+    if (it == typeIds.end()) {
+        return {};
+    }
     
-    std::function<void(SceneNode*)> searchEntity = [&](SceneNode* entity) {
-        if (entity->hasComponent(componentType)) {
-            entities.push_back(entity);
-        }
+    SceneQuery*& query = componentQueries[it->second];
+    if (!query) {
+        QueryFilter filter;
+        filter.allOf.push_back(it->second);
+        query = createQuery(filter);
+    }
+    return FrameVector<SceneNode*>(query->begin(), query->end());
+}
+
+SceneCommandBuffer& Scene::getCommandBuffer() {
+    if (commandBufferCache.sceneSerial == serial) {
+        return *commandBufferCache.buffer;
+    }
+    
+    std::lock_guard<std::mutex> lock(commandBufferMutex);
+    std::thread::id thread = std::this_thread::get_id();
+    auto it = std::find_if(commandBuffers.begin(), commandBuffers.end(),
+                           [thread](const auto& entry) { return entry.first == thread; });
+    if (it == commandBuffers.end()) {
+        commandBuffers.emplace_back(thread, std::make_unique<SceneCommandBuffer>());
+        it = commandBuffers.end() - 1;
+    }
+    commandBufferCache = CommandBufferCache{serial, it->second.get()};
+    return *it->second;
+}
+
+void Scene::playbackCommands() {
+    std::vector<SceneNode*> created;
+    std::vector<SceneNode*> doomed;
+    for (auto& entry : commandBuffers) {
+        SceneCommandBuffer& buffer = *entry.second;
+        if (buffer.empty()) continue;
+        
+        rootEntities.reserve(rootEntities.size() + buffer.rootCreateCount);
+        created.clear();
+        created.reserve(buffer.createdCount);
+        // A null ref resolves to nullptr too; callers check isNull first
+        auto resolve = [this, &created](const SceneCommandBuffer::EntityRef& ref) -> SceneNode* {
+            if (ref.created != SceneCommandBuffer::NotCreated) {
+                return ref.created < created.size() ? created[ref.created] : nullptr;
+            }
+            return getEntity(ref.id);
+        };
         
-        for (auto& child : entity->getChildren()) {
-            searchEntity(child.get());
+        for (auto& command : buffer.commands) {
+            if (command.type == SceneCommandBuffer::CommandType::Create) {
+                // Keep indices aligned even when the parent has gone
+                SceneNode* parent = resolve(command.parent);
+                SceneNode* node = nullptr;
+                if (command.parent.isNull()) {
+                    node = createEntity(command.name);
+                } else if (parent) {
+                    node = createChildEntity(parent, command.name);
+                }
+                created.push_back(node);
+                continue;
+            }
+            
+            SceneNode* node = resolve(command.entity);
+            if (!node) continue;
+            switch (command.type) {
+            case SceneCommandBuffer::CommandType::Destroy:
+                doomed.push_back(node);
+                break;
+            case SceneCommandBuffer::CommandType::SetParent:
+                if (command.parent.isNull()) {
+                    reparentEntity(node, nullptr);
+                } else if (SceneNode* parent = resolve(command.parent)) {
+                    reparentEntity(node, parent);
+                }
+                break;
+            case SceneCommandBuffer::CommandType::Component:
+                command.apply(*node);
+                break;
+            default:
+                break;
+            }
+        }
+        buffer.clear();
+    }
+    
+    if (!doomed.empty()) {
+        destroyEntities(std::move(doomed));
+    }
+}
+
+SceneQuery* Scene::createQuery(const QueryFilter& filter) {
+    queries.push_back(std::unique_ptr<SceneQuery>(new SceneQuery(filter)));
+    SceneQuery* query = queries.back().get();
+    
+    auto watch = [this, query](const std::vector<std::uint32_t>& typeList) {
+        for (std::uint32_t typeId : typeList) {
+            if (typeId >= queriesByType.size()) {
+                queriesByType.resize(typeId + 1);
+            }
+            auto& watchers = queriesByType[typeId];
+            if (std::find(watchers.begin(), watchers.end(), query) == watchers.end()) {
+                watchers.push_back(query);
+            }
         }
     };
+    watch(filter.allOf);
+    watch(filter.anyOf);
+    watch(filter.noneOf);
     
+    // Later changes arrive incrementally; pick up what is already here
+    std::vector<SceneNode*> pending;
     for (auto& entity : rootEntities) {
-        searchEntity(entity.get());
+        pending.push_back(entity.get());
+    }
+    while (!pending.empty()) {
+        SceneNode* node = pending.back();
+        pending.pop_back();
+        query->update(node, query->matches(*this, node->getID()));
+        for (auto& child : node->getChildren()) {
+            pending.push_back(child.get());
+        }
+    }
+    
+    return query;
+}
+
+void Scene::destroyQuery(SceneQuery* query) {
+    for (auto& watchers : queriesByType) {
+        watchers.erase(std::remove(watchers.begin(), watchers.end(), query), watchers.end());
+    }
+    for (auto it = componentQueries.begin(); it != componentQueries.end(); ++it) {
+        if (it->second == query) {
+            componentQueries.erase(it);
+            break;
+        }
+    }
+    queries.erase(std::remove_if(queries.begin(), queries.end(),
+                                 [query](const std::unique_ptr<SceneQuery>& owned) {
+                                     return owned.get() == query;
+                                 }),
+                  queries.end());
+}
+
+void Scene::onComponentChanged(SceneNode* entity, std::uint32_t typeId) {
+    if (typeId == componentTypeId<TransformComponent>()) {
+        transformSystem.invalidate();
+    }
+    if (typeId >= queriesByType.size()) return;
+    for (SceneQuery* query : queriesByType[typeId]) {
+        query->update(entity, query->matches(*this, entity->getID()));
+    }
+}
+
+void Scene::onEntityAttached(SceneNode* entity) {
+    bindEntity(entity);
+    indexName(entity);
+    transformSystem.invalidate();
+    // Also catches queries that only exclude components
+    for (auto& query : queries) {
+        query->update(entity, query->matches(*this, entity->getID()));
+    }
+}
+
+void Scene::onEntityDetached(SceneNode* entity) {
+    transformSystem.invalidate();
+    for (auto& query : queries) {
+        query->update(entity, false);
+    }
+    unindexName(entity);
+    releaseEntity(entity);
+}
+
+std::uint32_t Scene::findNameId(const std::string& name) const {
+    auto it = nameIds.find(name);
+    return it != nameIds.end() ? it->second : SceneNode::NoName;
+}
+
+void Scene::indexName(SceneNode* entity) {
+    auto [it, inserted] = nameIds.try_emplace(entity->name, static_cast<std::uint32_t>(entitiesByName.size()));
+    if (inserted) {
+        entitiesByName.emplace_back();
     }
+    std::uint32_t nameId = it->second;
+    std::vector<SceneNode*>& named = entitiesByName[nameId];
+    entity->nameId = nameId;
+    entity->namePosition = static_cast<std::uint32_t>(named.size());
+    named.push_back(entity);
     
-    return entities;
+    // Append, so the earliest indexed sibling stays first
+    entity->nameParent = entity->parent ? entity->parent->id : InvalidEntityID;
+    NamedSiblings& siblings = siblingsByName[siblingKey(entity->nameParent, nameId)];
+    entity->prevSameName = siblings.last;
+    entity->nextSameName = nullptr;
+    if (siblings.last) {
+        siblings.last->nextSameName = entity;
+    } else {
+        siblings.first = entity;
+    }
+    siblings.last = entity;
 }
 
-void Scene::saveToFile(const std::string& filename) {
-    // TODO: Implement scene serialization
-    VF_LOG_INFO("Scene '{}' saved to '{}'", name, filename);
+void Scene::unindexName(SceneNode* entity) {
+    std::uint32_t nameId = entity->nameId;
+    if (nameId == SceneNode::NoName) return;
+    
+    std::vector<SceneNode*>& named = entitiesByName[nameId];
+    SceneNode* moved = named.back();
+    named[entity->namePosition] = moved;
+    moved->namePosition = entity->namePosition;
+    named.pop_back();
+    
+    auto it = siblingsByName.find(siblingKey(entity->nameParent, nameId));
+    NamedSiblings& siblings = it->second;
+    (entity->prevSameName ? entity->prevSameName->nextSameName : siblings.first) = entity->nextSameName;
+    (entity->nextSameName ? entity->nextSameName->prevSameName : siblings.last) = entity->prevSameName;
+    if (!siblings.first) {
+        siblingsByName.erase(it);
+    }
+    entity->nameId = SceneNode::NoName;
+    entity->prevSameName = nullptr;
+    entity->nextSameName = nullptr;
 }
 
-void Scene::loadFromFile(const std::string& filename) {
-    // TODO: Implement scene deserialization
-    VF_LOG_INFO("Scene '{}' loaded from '{}'", name, filename);
+void Scene::reindexName(SceneNode* entity) {
+    EntityID parent = entity->parent ? entity->parent->id : InvalidEntityID;
+    if (entity->nameId != SceneNode::NoName && entity->nameParent != parent) {
+        unindexName(entity);
+        indexName(entity);
+    }
+}
+
+SceneNode* Scene::findNamedChild(EntityID parent, const std::string& name) const {
+    std::uint32_t nameId = findNameId(name);
+    if (nameId == SceneNode::NoName) return nullptr;
+    auto it = siblingsByName.find(siblingKey(parent, nameId));
+    return it != siblingsByName.end() ? it->second.first : nullptr;
+}
+
+SceneNode* Scene::resolvePath(EntityID start, const std::string& path) const {
+    // Reused so segments don't allocate on every lookup
+    thread_local std::string segment;
+    SceneNode* node = nullptr;
+    EntityID parent = start;
+    std::size_t begin = 0;
+    while (begin <= path.size()) {
+        std::size_t end = std::min(path.find('/', begin), path.size());
+        segment.assign(path, begin, end - begin);
+        node = findNamedChild(parent, segment);
+        if (!node) return nullptr;
+        parent = node->id;
+        begin = end + 1;
+    }
+    return node;
+}
+
+// Scene file format
+//
+// A header, a table of sections, then each section as one contiguous,
+// 8-byte aligned blob of fixed-size records, so loading reads the mapped
+// file in place. The entity table is in breadth-first order, so every
+// parent precedes its children. Each built-in component type is a column of
+// records pointing back into the entity table, and names and paths are
+// slices of a shared string section. Little-endian with IEEE floats.
+//
+// Readers skip section types they don't know; changing a record's layout
+// needs a new version.
+namespace {
+
+constexpr char SceneFileMagic[4] = {'V', 'F', 'S', 'C'};
+constexpr std::uint32_t SceneFileVersion = 1;
+
+enum class SceneSection : std::uint32_t {
+    Entities = 1,
+    Strings,
+    Transforms,
+    Meshes,
+    Cameras,
+    Lights
+};
+
+struct SceneFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+    std::uint32_t entityCount;
+};
+
+struct SceneSectionEntry {
+    std::uint32_t type;
+    std::uint32_t count;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+struct StringRef {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+// Entity flags
+constexpr std::uint32_t EntityActive = 1u << 0;
+// Entities without it had their transform removed
+constexpr std::uint32_t EntityHasTransform = 1u << 1;
+
+struct EntityRecord {
+    EntityID id;
+    // Index into the entity table, -1 for roots
+    std::int32_t parent;
+    std::uint32_t childCount;
+    std::uint32_t flags;
+    StringRef name;
+};
+
+struct TransformRecord {
+    std::uint32_t entity;
+    float position[3];
+    float rotation[3];
+    float scale[3];
+};
+
+// Mesh flags
+constexpr std::uint32_t MeshVisible = 1u << 0;
+constexpr std::uint32_t MeshAutoLoad = 1u << 1;
+
+struct MeshRecord {
+    std::uint32_t entity;
+    std::uint32_t flags;
+    StringRef path;
+};
+
+struct CameraRecord {
+    std::uint32_t entity;
+    float fov;
+    float nearPlane;
+    float farPlane;
+    std::uint32_t isMainCamera;
+};
+
+struct LightRecord {
+    std::uint32_t entity;
+    std::uint32_t type;
+    float color[3];
+    float intensity;
+    float range;
+    float spotAngle;
+};
+
+static_assert(sizeof(SceneFileHeader) == 16 && sizeof(SceneSectionEntry) == 24, "Scene file layout changed");
+static_assert(sizeof(EntityRecord) == 24 && sizeof(TransformRecord) == 40 && sizeof(MeshRecord) == 16 &&
+              sizeof(CameraRecord) == 20 && sizeof(LightRecord) == 32, "Scene file layout changed");
+
+// A section's records in the mapped file
+template<typename Record>
+struct SceneColumn {
+    const Record* records = nullptr;
+    std::uint32_t count = 0;
+    
+    const Record* begin() const { return records; }
+    const Record* end() const { return records + count; }
+};
+
+// Finds a section and checks it lies within the file; a missing section is
+// an empty column
+template<typename Record>
+bool findSection(const std::uint8_t* data, std::size_t size, const SceneFileHeader& header,
+                 SceneSection type, SceneColumn<Record>& column) {
+    const auto* sections = reinterpret_cast<const SceneSectionEntry*>(data + sizeof(SceneFileHeader));
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i) {
+        const SceneSectionEntry& section = sections[i];
+        if (section.type != static_cast<std::uint32_t>(type)) continue;
+        if (section.offset % 8 != 0 || section.offset > size || section.size > size - section.offset ||
+            section.size != static_cast<std::uint64_t>(section.count) * sizeof(Record)) {
+            return false;
+        }
+        column.records = reinterpret_cast<const Record*>(data + section.offset);
+        column.count = section.count;
+        return true;
+    }
+    return true;
+}
+
+bool isValidString(const StringRef& ref, std::size_t stringsSize) {
+    return ref.offset <= stringsSize && ref.length <= stringsSize - ref.offset;
+}
+
+template<typename Record>
+bool hasValidEntities(const SceneColumn<Record>& column, std::uint32_t entityCount) {
+    for (const Record& record : column) {
+        if (record.entity >= entityCount) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool Scene::saveToFile(const std::string& filename) {
+    std::vector<EntityRecord> entities;
+    std::vector<TransformRecord> transforms;
+    std::vector<MeshRecord> meshes;
+    std::vector<CameraRecord> cameras;
+    std::vector<LightRecord> lights;
+    std::string strings;
+    auto addString = [&strings](const std::string& value) {
+        StringRef ref{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(value.size())};
+        strings += value;
+        return ref;
+    };
+    
+    // Breadth-first, recording each parent's index as its children are queued
+    std::vector<const SceneNode*> order;
+    order.reserve(entityCount);
+    entities.reserve(entityCount);
+    for (const auto& root : rootEntities) {
+        order.push_back(root.get());
+        entities.push_back(EntityRecord{root->getID(), -1, 0, 0, {}});
+    }
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const SceneNode* node = order[i];
+        std::uint32_t index = static_cast<std::uint32_t>(i);
+        EntityRecord& entity = entities[i];
+        entity.childCount = static_cast<std::uint32_t>(node->getChildren().size());
+        entity.name = addString(node->getName());
+        entity.flags = node->isActive() ? EntityActive : 0u;
+        
+        if (const TransformComponent* transform = node->getTransform()) {
+            entity.flags |= EntityHasTransform;
+            transforms.push_back(TransformRecord{index,
+                {transform->position.x, transform->position.y, transform->position.z},
+                {transform->rotation.x, transform->rotation.y, transform->rotation.z},
+                {transform->scale.x, transform->scale.y, transform->scale.z}});
+        }
+        if (const MeshComponent* mesh = node->getComponent<MeshComponent>()) {
+            std::uint32_t flags = (mesh->visible ? MeshVisible : 0u) | (mesh->autoLoad ? MeshAutoLoad : 0u);
+            meshes.push_back(MeshRecord{index, flags, addString(mesh->meshPath)});
+        }
+        if (const CameraComponent* camera = node->getComponent<CameraComponent>()) {
+            cameras.push_back(CameraRecord{index, camera->fov, camera->nearPlane, camera->farPlane,
+                                           camera->isMainCamera ? 1u : 0u});
+        }
+        if (const LightComponent* light = node->getComponent<LightComponent>()) {
+            lights.push_back(LightRecord{index, static_cast<std::uint32_t>(light->type),
+                                         {light->color.r, light->color.g, light->color.b},
+                                         light->intensity, light->range, light->spotAngle});
+        }
+        
+        for (const auto& child : node->getChildren()) {
+            order.push_back(child.get());
+            entities.push_back(EntityRecord{child->getID(), static_cast<std::int32_t>(index), 0, 0, {}});
+        }
+    }
+    
+    struct Blob {
+        SceneSection type;
+        std::uint32_t count;
+        const void* data;
+        std::size_t size;
+    };
+    const Blob blobs[] = {
+        {SceneSection::Entities, static_cast<std::uint32_t>(entities.size()), entities.data(), entities.size() * sizeof(EntityRecord)},
+        {SceneSection::Strings, static_cast<std::uint32_t>(strings.size()), strings.data(), strings.size()},
+        {SceneSection::Transforms, static_cast<std::uint32_t>(transforms.size()), transforms.data(), transforms.size() * sizeof(TransformRecord)},
+        {SceneSection::Meshes, static_cast<std::uint32_t>(meshes.size()), meshes.data(), meshes.size() * sizeof(MeshRecord)},
+        {SceneSection::Cameras, static_cast<std::uint32_t>(cameras.size()), cameras.data(), cameras.size() * sizeof(CameraRecord)},
+        {SceneSection::Lights, static_cast<std::uint32_t>(lights.size()), lights.data(), lights.size() * sizeof(LightRecord)},
+    };
+    const std::uint32_t sectionCount = static_cast<std::uint32_t>(std::size(blobs));
+    
+    SceneFileHeader header{};
+    std::memcpy(header.magic, SceneFileMagic, sizeof(header.magic));
+    header.version = SceneFileVersion;
+    header.sectionCount = sectionCount;
+    header.entityCount = static_cast<std::uint32_t>(entities.size());
+    
+    std::vector<SceneSectionEntry> sections(sectionCount);
+    std::uint64_t offset = sizeof(SceneFileHeader) + sectionCount * sizeof(SceneSectionEntry);
+    for (std::uint32_t i = 0; i < sectionCount; ++i) {
+        offset = (offset + 7) & ~std::uint64_t(7);
+        sections[i] = SceneSectionEntry{static_cast<std::uint32_t>(blobs[i].type), blobs[i].count, offset, blobs[i].size};
+        offset += blobs[i].size;
+    }
+    
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        VF_LOG_ERROR("Failed to open '{}' for writing scene '{}'", filename, name);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(SceneSectionEntry));
+    std::uint64_t written = sizeof(SceneFileHeader) + sectionCount * sizeof(SceneSectionEntry);
+    for (std::uint32_t i = 0; i < sectionCount; ++i) {
+        static const char padding[8] = {};
+        file.write(padding, static_cast<std::streamsize>(sections[i].offset - written));
+        file.write(static_cast<const char*>(blobs[i].data), static_cast<std::streamsize>(blobs[i].size));
+        written = sections[i].offset + blobs[i].size;
+    }
+    if (!file) {
+        VF_LOG_ERROR("Failed to write scene '{}' to '{}'", name, filename);
+        return false;
+    }
+    
+    VF_LOG_INFO("Scene '{}' saved to '{}' ({} entities, {} bytes)", name, filename, entities.size(), written);
+    return true;
+}
+
+bool Scene::loadFromFile(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        VF_LOG_ERROR("Failed to open scene file '{}'", filename);
+        return false;
+    }
+    const std::uint8_t* data = file.getData();
+    std::size_t size = file.getSize();
+    
+    SceneFileHeader header{};
+    if (size >= sizeof(header)) {
+        std::memcpy(&header, data, sizeof(header));
+    }
+    if (size < sizeof(header) || std::memcmp(header.magic, SceneFileMagic, sizeof(header.magic)) != 0) {
+        VF_LOG_ERROR("'{}' is not a scene file", filename);
+        return false;
+    }
+    if (header.version == 0 || header.version > SceneFileVersion) {
+        VF_LOG_ERROR("Scene file '{}' has unsupported version {}", filename, header.version);
+        return false;
+    }
+    
+    // Validate everything before touching the scene
+    SceneColumn<EntityRecord> entities;
+    SceneColumn<char> strings;
+    SceneColumn<TransformRecord> transforms;
+    SceneColumn<MeshRecord> meshes;
+    SceneColumn<CameraRecord> cameras;
+    SceneColumn<LightRecord> lights;
+    bool valid = header.sectionCount <= (size - sizeof(header)) / sizeof(SceneSectionEntry) &&
+                 findSection(data, size, header, SceneSection::Entities, entities) &&
+                 findSection(data, size, header, SceneSection::Strings, strings) &&
+                 findSection(data, size, header, SceneSection::Transforms, transforms) &&
+                 findSection(data, size, header, SceneSection::Meshes, meshes) &&
+                 findSection(data, size, header, SceneSection::Cameras, cameras) &&
+                 findSection(data, size, header, SceneSection::Lights, lights) &&
+                 entities.count == header.entityCount;
+    std::vector<std::uint32_t> slots;
+    std::vector<std::uint32_t> childCounts(valid ? entities.count : 0, 0);
+    slots.reserve(entities.count);
+    for (std::uint32_t i = 0; valid && i < entities.count; ++i) {
+        const EntityRecord& entity = entities.records[i];
+        valid = entity.parent >= -1 && entity.parent < static_cast<std::int64_t>(i) &&
+                isValidString(entity.name, strings.count) && entityIndex(entity.id) != 0;
+        slots.push_back(entityIndex(entity.id));
+        if (valid && entity.parent >= 0) {
+            ++childCounts[entity.parent];
+        }
+    }
+    // Child counts size the child lists, so they must match the records
+    for (std::uint32_t i = 0; valid && i < entities.count; ++i) {
+        valid = entities.records[i].childCount == childCounts[i];
+    }
+    // Each entity needs its own slot to keep its ID
+    std::sort(slots.begin(), slots.end());
+    valid = valid && std::adjacent_find(slots.begin(), slots.end()) == slots.end();
+    valid = valid && hasValidEntities(transforms, entities.count) && hasValidEntities(meshes, entities.count) &&
+            hasValidEntities(cameras, entities.count) && hasValidEntities(lights, entities.count);
+    for (const MeshRecord& mesh : meshes) {
+        valid = valid && isValidString(mesh.path, strings.count);
+    }
+    for (const LightRecord& light : lights) {
+        valid = valid && light.type <= static_cast<std::uint32_t>(LightComponent::LightType::Spot);
+    }
+    if (!valid) {
+        VF_LOG_ERROR("Scene file '{}' is corrupt", filename);
+        return false;
+    }
+    
+    clear();
+    // At most one name and one sibling group per entity
+    nameIds.reserve(entities.count);
+    entitiesByName.reserve(entities.count);
+    siblingsByName.reserve(entities.count);
+    std::vector<SceneNode*> nodes(entities.count);
+    std::string entityName;
+    for (std::uint32_t i = 0; i < entities.count; ++i) {
+        const EntityRecord& entity = entities.records[i];
+        entityName.assign(strings.records + entity.name.offset, entity.name.length);
+        SceneNode* node = entity.parent < 0 ? createEntity(entity.id, entityName)
+                                            : createChildEntity(nodes[entity.parent], entity.id, entityName);
+        node->children.reserve(entity.childCount);
+        node->setActive((entity.flags & EntityActive) != 0);
+        if (!(entity.flags & EntityHasTransform)) {
+            node->removeComponent<TransformComponent>();
+        }
+        nodes[i] = node;
+    }
+    
+    for (const TransformRecord& record : transforms) {
+        if (TransformComponent* transform = nodes[record.entity]->getTransform()) {
+            transform->setPosition(glm::vec3(record.position[0], record.position[1], record.position[2]));
+            transform->setRotation(glm::vec3(record.rotation[0], record.rotation[1], record.rotation[2]));
+            transform->setScale(glm::vec3(record.scale[0], record.scale[1], record.scale[2]));
+        }
+    }
+    for (const MeshRecord& record : meshes) {
+        MeshComponent* mesh = nodes[record.entity]->addComponent<MeshComponent>();
+        mesh->meshPath.assign(strings.records + record.path.offset, record.path.length);
+        mesh->visible = (record.flags & MeshVisible) != 0;
+        mesh->autoLoad = (record.flags & MeshAutoLoad) != 0;
+        // onAttach ran before the path was known
+        if (mesh->autoLoad && !mesh->meshPath.empty()) {
+            mesh->loadMesh(mesh->meshPath);
+        }
+    }
+    for (const CameraRecord& record : cameras) {
+        CameraComponent* camera = nodes[record.entity]->addComponent<CameraComponent>();
+        camera->fov = record.fov;
+        camera->nearPlane = record.nearPlane;
+        camera->farPlane = record.farPlane;
+        camera->isMainCamera = record.isMainCamera != 0;
+    }
+    for (const LightRecord& record : lights) {
+        LightComponent* light = nodes[record.entity]->addComponent<LightComponent>();
+        light->type = static_cast<LightComponent::LightType>(record.type);
+        light->color = glm::vec3(record.color[0], record.color[1], record.color[2]);
+        light->intensity = record.intensity;
+        light->range = record.range;
+        light->spotAngle = record.spotAngle;
+    }
+    
+    VF_LOG_INFO("Scene '{}' loaded from '{}' ({} entities)", name, filename, entities.count);
+    return true;
 }
 
 size_t Scene::getEntityCount() const {
-    return entityMap.size();
+    return entityCount;
 }
 
 size_t Scene::getComponentCount() const {
     size_t count = 0;
-    for (const auto& [id, entity] : entityMap) {
-        // Count components for each entity
-        // This would need access to the components map
+    for (const auto& storage : storages) {
+        if (storage) {
+            count += storage->liveSize();
+        }
     }
     return count;
 }
 
-void Scene::registerEntity(SceneNode* entity) {
-    if (entity) {
-        entityMap[entity->getID()] = entity;
+EntityID Scene::allocateEntityID() {
+    std::uint32_t index;
+    if (!freeEntitySlots.empty()) {
+        index = freeEntitySlots.back();
+        takeFreeSlot(index);
+    } else if (entitySlots.size() <= EntityIndexMask) {
+        index = static_cast<std::uint32_t>(entitySlots.size());
+        entitySlots.emplace_back();
+    } else {
+        VF_LOG_ERROR("Scene '{}' has run out of entity IDs", name);
+        return InvalidEntityID;
     }
+    return makeEntityID(index, entitySlots[index].generation);
 }
 
-void Scene::unregisterEntity(SceneNode* entity) {
-    if (entity) {
-        entityMap.erase(entity->getID());
+EntityID Scene::claimEntityID(EntityID id) {
+    std::uint32_t index = entityIndex(id);
+    if (index == 0) {
+        return allocateEntityID();
+    }
+    if (index >= entitySlots.size()) {
+        // Slots skipped over stay available
+        std::uint32_t first = static_cast<std::uint32_t>(entitySlots.size());
+        entitySlots.resize(index + 1);
+        for (std::uint32_t skipped = first; skipped < index; ++skipped) {
+            entitySlots[skipped].freePosition = static_cast<std::uint32_t>(freeEntitySlots.size());
+            freeEntitySlots.push_back(skipped);
+        }
+    } else if (entitySlots[index].freePosition != EntitySlot::NotFree) {
+        takeFreeSlot(index);
+    } else {
+        return allocateEntityID();
+    }
+    entitySlots[index].generation = entityGeneration(id);
+    return id;
+}
+
+void Scene::takeFreeSlot(std::uint32_t index) {
+    // Swap with the last free slot so any slot can leave in O(1)
+    std::uint32_t position = entitySlots[index].freePosition;
+    std::uint32_t last = freeEntitySlots.back();
+    freeEntitySlots[position] = last;
+    entitySlots[last].freePosition = position;
+    freeEntitySlots.pop_back();
+    entitySlots[index].freePosition = EntitySlot::NotFree;
+}
+
+void Scene::bindEntity(SceneNode* entity) {
+    std::uint32_t index = entityIndex(entity->getID());
+    if (index == 0) return;
+    EntitySlot& slot = entitySlots[index];
+    if (!slot.node) {
+        slot.node = entity;
+        entityCount++;
+    }
+}
+
+void Scene::releaseEntity(SceneNode* entity) {
+    std::uint32_t index = entityIndex(entity->getID());
+    EntitySlot& slot = entitySlots[index];
+    if (slot.node != entity) return;
+    slot.node = nullptr;
+    entityCount--;
+    // Once the generation runs out it matches no ID, which retires the slot
+    if (++slot.generation < EntityGenerationCount) {
+        slot.freePosition = static_cast<std::uint32_t>(freeEntitySlots.size());
+        freeEntitySlots.push_back(index);
+    }
+}
+
+void Scene::releaseRootEntity(SceneNode* entity) {
+    auto it = std::find_if(rootEntities.begin(), rootEntities.end(),
+                          [entity](const std::unique_ptr<SceneNode>& root) {
+                              return root.get() == entity;
+                          });
+    if (it != rootEntities.end()) {
+        it->release();
+        rootEntities.erase(it);
     }
 }
 
-EntityID Scene::generateEntityID() {
-    return nextEntityID++;
+// SceneCommandBuffer Implementation
+SceneCommandBuffer::EntityRef SceneCommandBuffer::createEntity(const std::string& name, EntityRef parent) {
+    commands.push_back(Command{CommandType::Create, {}, parent, name, {}});
+    if (parent.isNull()) {
+        rootCreateCount++;
+    }
+    EntityRef ref;
+    ref.created = createdCount++;
+    return ref;
+}
+
+void SceneCommandBuffer::destroyEntity(EntityRef entity) {
+    commands.push_back(Command{CommandType::Destroy, entity, {}, {}, {}});
+}
+
+void SceneCommandBuffer::setParent(EntityRef entity, EntityRef parent) {
+    commands.push_back(Command{CommandType::SetParent, entity, parent, {}, {}});
+}
+
+void SceneCommandBuffer::clear() {
+    commands.clear();
+    createdCount = 0;
+    rootCreateCount = 0;
+}
+
+// SceneQuery Implementation
+bool SceneQuery::matches(const Scene& scene, EntityID id) const {
+    for (std::uint32_t typeId : filter.allOf) {
+        if (!scene.hasComponent(typeId, id)) return false;
+    }
+    for (std::uint32_t typeId : filter.noneOf) {
+        if (scene.hasComponent(typeId, id)) return false;
+    }
+    if (filter.anyOf.empty()) return true;
+    return std::any_of(filter.anyOf.begin(), filter.anyOf.end(),
+                       [&scene, id](std::uint32_t typeId) { return scene.hasComponent(typeId, id); });
+}
+
+void SceneQuery::update(SceneNode* node, bool match) {
+    std::uint32_t index = members.indexOf(node->getID());
+    if (match && index == EntitySparseSet::InvalidIndex) {
+        members.insert(node->getID());
+        nodes.push_back(node);
+    } else if (!match && index != EntitySparseSet::InvalidIndex) {
+        nodes[index] = nodes.back();
+        nodes.pop_back();
+        members.eraseAt(index);
+    }
 }
 
 // Built-in Component Implementations
@@ -483,6 +1576,9 @@ void MeshComponent::onRender() {
 bool MeshComponent::loadMesh(const std::string& path) {
     meshPath = path;
     mesh = MeshLoader::getInstance().loadMesh(path);
+    if (owner && owner->getScene()) {
+        owner->getScene()->markChanged<MeshComponent>(owner->getID());
+    }
     
     if (mesh) {
         VF_LOG_INFO("Successfully loaded mesh: {} for component", path);
@@ -495,6 +1591,9 @@ bool MeshComponent::loadMesh(const std::string& path) {
 
 void MeshComponent::setMesh(std::shared_ptr<Mesh> newMesh) {
     mesh = newMesh;
+    if (owner && owner->getScene()) {
+        owner->getScene()->markChanged<MeshComponent>(owner->getID());
+    }
     if (mesh) {
         meshPath = mesh->name;
         VF_LOG_INFO("Set mesh: {} for component", mesh->name);
@@ -6,12 +6,22 @@
 #include <glm/gtx/quaternion.hpp>
 #include <memory>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <string>
 #include <typeindex>
 #include <any>
 #include <functional>
+#include <tuple>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 #include "MeshLoader.h"
+#include "MemoryManager.h"
+#include "TransformKernels.h"
 
 namespace VaporFrame {
 namespace Core {
@@ -20,11 +30,27 @@ namespace Core {
 class SceneNode;
 class Component;
 class Scene;
+class JobSystem;
 
-// Entity ID type
+// Entity handle: a slot index in the low 24 bits and that slot's generation
+// in the high 8. A scene bumps the generation whenever it frees a slot, so a
+// handle to a destroyed entity stops resolving instead of aliasing whatever
+// reuses the slot. 0 is never a valid handle.
 using EntityID = uint32_t;
 
-// Component base class
+constexpr EntityID InvalidEntityID = 0;
+constexpr std::uint32_t EntityIndexBits = 24;
+constexpr std::uint32_t EntityIndexMask = (1u << EntityIndexBits) - 1;
+constexpr std::uint32_t EntityGenerationCount = 1u << (32 - EntityIndexBits);
+
+constexpr std::uint32_t entityIndex(EntityID id) { return id & EntityIndexMask; }
+constexpr std::uint32_t entityGeneration(EntityID id) { return id >> EntityIndexBits; }
+constexpr EntityID makeEntityID(std::uint32_t index, std::uint32_t generation) {
+    return (generation << EntityIndexBits) | index;
+}
+
+// Component base class. Concrete components can also derive from
+// PooledObject<T> to be allocated from a pool instead of the heap.
 class Component {
 public:
     virtual ~Component() = default;
@@ -43,6 +69,443 @@ protected:
     friend class SceneNode;
 };
 
+// Dense per-process index for each component type, so a scene can find the
+// storage for T without hashing a type_index
+inline std::uint32_t nextComponentTypeId() {
+    static std::atomic<std::uint32_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename T>
+std::uint32_t componentTypeId() {
+    static const std::uint32_t id = nextComponentTypeId();
+    return id;
+}
+
+/**
+ * @brief Sparse set of entity IDs
+ *
+ * Entity indices key a paged sparse array that holds each entity's position
+ * in a packed array, so membership tests are a few loads, including the
+ * generation check, and iteration only touches members.
+ */
+class EntitySparseSet {
+public:
+    static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFFu;
+    
+    bool contains(EntityID id) const { return indexOf(id) != InvalidIndex; }
+    std::size_t size() const { return entities.size(); }
+    const std::vector<EntityID>& getEntities() const { return entities; }
+    
+    std::uint32_t indexOf(EntityID id) const {
+        std::uint32_t slot = entityIndex(id);
+        std::size_t page = slot / SparsePageSize;
+        if (page >= sparse.size() || !sparse[page]) return InvalidIndex;
+        std::uint32_t index = sparse[page][slot % SparsePageSize];
+        // The entry may belong to another generation of the slot
+        return index != InvalidIndex && entities[index] == id ? index : InvalidIndex;
+    }
+    
+    // Appends id to the packed array
+    void insert(EntityID id) {
+        std::uint32_t slot = entityIndex(id);
+        std::size_t page = slot / SparsePageSize;
+        if (page >= sparse.size()) {
+            sparse.resize(page + 1);
+        }
+        if (!sparse[page]) {
+            sparse[page] = std::make_unique<std::uint32_t[]>(SparsePageSize);
+            std::fill_n(sparse[page].get(), SparsePageSize, InvalidIndex);
+        }
+        sparse[page][slot % SparsePageSize] = static_cast<std::uint32_t>(entities.size());
+        entities.push_back(id);
+    }
+    
+    // Removes the entity at index by moving the last entity into its place.
+    // Owners of parallel arrays must do the same with their elements.
+    void eraseAt(std::uint32_t index) {
+        EntityID removed = entities[index];
+        EntityID last = entities.back();
+        if (last != InvalidEntityID) {
+            sparse[entityIndex(last) / SparsePageSize][entityIndex(last) % SparsePageSize] = index;
+        }
+        if (removed != InvalidEntityID) {
+            sparse[entityIndex(removed) / SparsePageSize][entityIndex(removed) % SparsePageSize] = InvalidIndex;
+        }
+        entities[index] = last;
+        entities.pop_back();
+    }
+    
+    // Takes the entity at index out of the set but keeps its slot, holding
+    // InvalidEntityID, until eraseAt. Nothing else moves.
+    void clearAt(std::uint32_t index) {
+        std::uint32_t removed = entityIndex(entities[index]);
+        sparse[removed / SparsePageSize][removed % SparsePageSize] = InvalidIndex;
+        entities[index] = InvalidEntityID;
+    }
+    
+private:
+    static constexpr std::size_t SparsePageSize = 4096;
+    std::vector<std::unique_ptr<std::uint32_t[]>> sparse;
+    std::vector<EntityID> entities;
+};
+
+// Type-erased face of a scene's storage for one component type.
+//
+// Also tracks changes: each component carries the scene's change version
+// from its last recorded write, and each page of PageSize components the
+// highest version in it, so looking for changes skips untouched pages.
+// Version 0 means never changed.
+class ComponentStorageBase : protected EntitySparseSet {
+public:
+    static constexpr std::size_t PageSize = 1024;
+    
+    using EntitySparseSet::InvalidIndex;
+    using EntitySparseSet::contains;
+    using EntitySparseSet::size;
+    using EntitySparseSet::getEntities;
+    using EntitySparseSet::indexOf;
+    
+    explicit ComponentStorageBase(const std::uint32_t& changeVersion) : changeVersion(changeVersion) {}
+    virtual ~ComponentStorageBase() = default;
+    
+    virtual Component* getComponent(EntityID id) = 0;
+    virtual void remove(EntityID id) = 0;
+    // Frees the slots of removed components; returns whether anything moved
+    virtual bool compact() = 0;
+    
+    // Components, not counting removed ones still waiting for compact()
+    std::size_t liveSize() const { return size() - clearedCount; }
+    
+    // Move a component between this storage and a detached node's heap copy
+    virtual std::unique_ptr<Component> release(EntityID id) = 0;
+    virtual Component* adopt(EntityID id, std::unique_ptr<Component> component) = 0;
+    
+    // Stamps a component with the current change version. Safe from
+    // concurrent component updates as long as each entity is written by one
+    // thread.
+    void markChanged(EntityID id) {
+        std::uint32_t index = indexOf(id);
+        if (index != InvalidIndex) {
+            markChangedAt(index);
+        }
+    }
+    void markChangedAt(std::uint32_t index) {
+        std::uint32_t version = changeVersion;
+        versions[index] = version;
+        std::atomic<std::uint32_t>& pageVersion = pageVersions[index / PageSize];
+        if (pageVersion.load(std::memory_order_relaxed) < version) {
+            pageVersion.store(version, std::memory_order_relaxed);
+        }
+    }
+    
+    std::uint32_t getVersion(EntityID id) const {
+        std::uint32_t index = indexOf(id);
+        return index != InvalidIndex ? versions[index] : 0;
+    }
+    
+    // Calls func(index) for every component changed after version since
+    template<typename Func>
+    void eachChangedIndex(std::uint32_t since, Func&& func) const {
+        std::size_t count = size();
+        for (std::size_t page = 0; page * PageSize < count; ++page) {
+            if (pageVersions[page].load(std::memory_order_relaxed) <= since) continue;
+            std::size_t end = std::min(count, (page + 1) * PageSize);
+            for (std::size_t index = page * PageSize; index < end; ++index) {
+                if (versions[index] > since) {
+                    func(static_cast<std::uint32_t>(index));
+                }
+            }
+        }
+    }
+    
+protected:
+    // Hide EntitySparseSet's versions to keep the version arrays parallel.
+    // A new component counts as changed.
+    void insert(EntityID id) {
+        EntitySparseSet::insert(id);
+        versions.push_back(0);
+        if (pageVersions.size() * PageSize < versions.size()) {
+            pageVersions.emplace_back(0);
+        }
+        markChangedAt(static_cast<std::uint32_t>(versions.size() - 1));
+    }
+    
+    // A cleared slot is never reported as changed
+    void clearAt(std::uint32_t index) {
+        EntitySparseSet::clearAt(index);
+        versions[index] = 0;
+        clearedCount++;
+    }
+    
+    // Moving the last component into the hole isn't a change, but the
+    // destination page must still cover its version
+    void eraseAt(std::uint32_t index) {
+        if (getEntities()[index] == InvalidEntityID) {
+            clearedCount--;
+        }
+        std::uint32_t moved = versions.back();
+        versions[index] = moved;
+        versions.pop_back();
+        std::atomic<std::uint32_t>& pageVersion = pageVersions[index / PageSize];
+        if (pageVersion.load(std::memory_order_relaxed) < moved) {
+            pageVersion.store(moved, std::memory_order_relaxed);
+        }
+        EntitySparseSet::eraseAt(index);
+    }
+    
+private:
+    const std::uint32_t& changeVersion;
+    // Parallel to the entity array. A deque, since atomics can't be moved.
+    std::vector<std::uint32_t> versions;
+    std::deque<std::atomic<std::uint32_t>> pageVersions;
+    std::size_t clearedCount = 0;
+};
+
+/**
+ * @brief Packed storage for every T in a scene
+ *
+ * Components live in fixed-size pages in the same order as the entity
+ * array, so growing never moves them. Removal only takes the entity out of
+ * the lookup and leaves the component where it is; compact(), which the
+ * scene runs once per update after playing back commands, destroys removed
+ * components and moves the last ones into their slots. Pointers therefore
+ * stay valid until the next compaction.
+ */
+template<typename T>
+class ComponentStorage final : public ComponentStorageBase {
+    static_assert(std::is_base_of_v<Component, T>, "T must derive from Component");
+    static_assert(std::is_move_constructible_v<T>, "Stored components are moved when the storage is compacted");
+    
+public:
+    explicit ComponentStorage(const std::uint32_t& changeVersion) : ComponentStorageBase(changeVersion) {}
+    ComponentStorage(const ComponentStorage&) = delete;
+    ComponentStorage& operator=(const ComponentStorage&) = delete;
+    
+    // Removed components are still alive until compacted
+    ~ComponentStorage() override {
+        for (std::size_t i = 0; i < size(); ++i) {
+            at(i).~T();
+        }
+        for (T* page : pages) {
+            ::operator delete(page, std::align_val_t(alignof(T)));
+        }
+    }
+    
+    // id must not already have a T
+    template<typename... Args>
+    T* emplace(EntityID id, Args&&... args) {
+        std::size_t index = size();
+        if (index == pages.size() * PageSize) {
+            pages.push_back(static_cast<T*>(::operator new(sizeof(T) * PageSize, std::align_val_t(alignof(T)))));
+        }
+        T* slot = &at(index);
+        ::new (slot) T(std::forward<Args>(args)...);
+        insert(id);
+        return slot;
+    }
+    
+    T* get(EntityID id) {
+        std::uint32_t index = indexOf(id);
+        return index != InvalidIndex ? &at(index) : nullptr;
+    }
+    
+    T& at(std::size_t index) { return pages[index / PageSize][index % PageSize]; }
+    
+    // Calls func(id, component) for every component, page by page
+    template<typename Func>
+    void each(Func&& func) {
+        std::size_t count = size();
+        for (std::size_t page = 0; page * PageSize < count; ++page) {
+            T* components = pages[page];
+            const EntityID* ids = getEntities().data() + page * PageSize;
+            std::size_t pageCount = std::min(PageSize, count - page * PageSize);
+            for (std::size_t i = 0; i < pageCount; ++i) {
+                if (ids[i] != InvalidEntityID) {
+                    func(ids[i], components[i]);
+                }
+            }
+        }
+    }
+    
+    Component* getComponent(EntityID id) override { return get(id); }
+    
+    void remove(EntityID id) override {
+        std::uint32_t index = indexOf(id);
+        if (index != InvalidIndex) {
+            clearAt(index);
+        }
+    }
+    
+    bool compact() override {
+        if (liveSize() == size()) return false;
+        std::size_t index = 0;
+        while (index < size()) {
+            if (getEntities()[index] != InvalidEntityID) {
+                ++index;
+                continue;
+            }
+            // The moved-in slot may be a removed one too, so look again
+            std::size_t last = size() - 1;
+            T& hole = at(index);
+            hole.~T();
+            if (index != last) {
+                ::new (&hole) T(std::move(at(last)));
+                at(last).~T();
+            }
+            eraseAt(static_cast<std::uint32_t>(index));
+        }
+        return true;
+    }
+    
+    std::unique_ptr<Component> release(EntityID id) override {
+        T* component = get(id);
+        if (!component) return nullptr;
+        auto detached = std::make_unique<T>(std::move(*component));
+        remove(id);
+        return detached;
+    }
+    
+    Component* adopt(EntityID id, std::unique_ptr<Component> component) override {
+        remove(id);
+        return emplace(id, std::move(static_cast<T&>(*component)));
+    }
+    
+private:
+    std::vector<T*> pages;
+};
+
+/**
+ * @brief Iterates the entities that have every one of Ts
+ *
+ * Walks the smallest of the storages and probes the others. Adding or
+ * removing any of Ts while iterating is not supported.
+ *
+ *     scene->view<TransformComponent, MeshComponent>().each(
+ *         [](TransformComponent& transform, MeshComponent& mesh) { ... });
+ *     for (auto [id, transform, mesh] : scene->view<TransformComponent, MeshComponent>()) { ... }
+ */
+template<typename... Ts>
+class SceneView {
+public:
+    explicit SceneView(ComponentStorage<Ts>*... storages) : storages(storages...) {
+        bool complete = (storages && ...);
+        if (complete) {
+            ((lead = (!lead || storages->size() < lead->size()) ? storages : lead), ...);
+        }
+    }
+    
+    // func takes (Ts&...) or (EntityID, Ts&...)
+    template<typename Func>
+    void each(Func&& func) const {
+        if (!lead) return;
+        if constexpr (sizeof...(Ts) == 1) {
+            // Single type: stream the packed array directly
+            std::get<0>(storages)->each([&func](EntityID id, auto& component) {
+                invoke(func, id, component);
+            });
+        } else {
+            const std::vector<EntityID>& ids = lead->getEntities();
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                EntityID id = ids[i];
+                if ((std::get<ComponentStorage<Ts>*>(storages)->contains(id) && ...)) {
+                    invoke(func, id, *std::get<ComponentStorage<Ts>*>(storages)->get(id)...);
+                }
+            }
+        }
+    }
+    
+    // Like each, but only visits entities where at least one of Ts changed
+    // after version since, at a cost proportional to the changes
+    template<typename Func>
+    void eachChanged(std::uint32_t since, Func&& func) const {
+        if (!lead) return;
+        eachChangedIn(since, func, std::index_sequence_for<Ts...>());
+    }
+    
+    // Upper bound on the number of matches
+    std::size_t sizeHint() const { return lead ? lead->size() : 0; }
+    
+    class Iterator {
+    public:
+        using value_type = std::tuple<EntityID, Ts&...>;
+        
+        Iterator(const SceneView* view, std::size_t index) : view(view), index(index) { skip(); }
+        
+        value_type operator*() const {
+            EntityID id = view->lead->getEntities()[index];
+            return value_type(id, *std::get<ComponentStorage<Ts>*>(view->storages)->get(id)...);
+        }
+        Iterator& operator++() { ++index; skip(); return *this; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+        
+    private:
+        void skip() {
+            while (index < view->sizeHint()) {
+                EntityID id = view->lead->getEntities()[index];
+                if ((std::get<ComponentStorage<Ts>*>(view->storages)->contains(id) && ...)) break;
+                ++index;
+            }
+        }
+        
+        const SceneView* view;
+        std::size_t index;
+    };
+    
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, sizeHint()); }
+    
+private:
+    template<typename Func, typename... Components>
+    static void invoke(Func& func, EntityID id, Components&... components) {
+        if constexpr (std::is_invocable_v<Func&, EntityID, Components&...>) {
+            func(id, components...);
+        } else {
+            func(components...);
+        }
+    }
+    
+    template<typename Func, std::size_t... Is>
+    void eachChangedIn(std::uint32_t since, Func& func, std::index_sequence<Is...>) const {
+        (eachChangedIn<Is>(since, func), ...);
+    }
+    
+    // Walks storage I's changes. An entity that also changed in an earlier
+    // storage was already visited from there.
+    template<std::size_t I, typename Func>
+    void eachChangedIn(std::uint32_t since, Func& func) const {
+        const ComponentStorageBase* storage = std::get<I>(storages);
+        const std::vector<EntityID>& ids = storage->getEntities();
+        storage->eachChangedIndex(since, [&](std::uint32_t index) {
+            EntityID id = ids[index];
+            if (!changedIn(id, since, std::make_index_sequence<I>()) &&
+                (std::get<ComponentStorage<Ts>*>(storages)->contains(id) && ...)) {
+                invoke(func, id, *std::get<ComponentStorage<Ts>*>(storages)->get(id)...);
+            }
+        });
+    }
+    
+    template<std::size_t... Is>
+    bool changedIn([[maybe_unused]] EntityID id, [[maybe_unused]] std::uint32_t since, std::index_sequence<Is...>) const {
+        return ((std::get<Is>(storages)->getVersion(id) > since) || ...);
+    }
+    
+    std::tuple<ComponentStorage<Ts>*...> storages;
+    ComponentStorageBase* lead = nullptr;
+};
+
+// Matrices and cached quaternion of a TransformComponent. Only rebuilding
+// the matrices reads them, so they live out of line, leaving the fields
+// that gameplay code writes every frame in one cache line per component.
+struct TransformMatrices : PooledObject<TransformMatrices> {
+    glm::mat4 local = glm::mat4(1.0f);
+    glm::mat4 world = glm::mat4(1.0f);
+    // Quaternion for `rotation`, converted again only when rotation changes
+    glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 orientationEuler = glm::vec3(0.0f);
+};
+
 // Transform component (built-in)
 class TransformComponent : public Component {
 public:
@@ -50,13 +513,12 @@ public:
     glm::vec3 rotation = glm::vec3(0.0f); // Euler angles in degrees
     glm::vec3 scale = glm::vec3(1.0f);
     
-    // Local and world transforms
-    glm::mat4 localTransform = glm::mat4(1.0f);
-    glm::mat4 worldTransform = glm::mat4(1.0f);
-    
     // Transform flags
     bool transformDirty = true;
     bool worldTransformDirty = true;
+    // Set when getWorldTransform recomputes the world matrix, so the next
+    // TransformSystem update still reports the change
+    bool worldTransformChanged = false;
     
     // Component interface
     std::string getTypeName() const override { return "Transform"; }
@@ -72,9 +534,12 @@ public:
     glm::vec3 getScale() const { return scale; }
     glm::quat getRotationQuaternion() const;
     
-    // Matrix getters
+    // Matrix getters. The scene's TransformSystem refreshes world transforms
+    // once per update; getWorldTransform recomputes a stale chain on demand.
     glm::mat4 getLocalTransform();
     glm::mat4 getWorldTransform();
+    // The world matrix as last computed, without checking for staleness
+    const glm::mat4& getCachedWorldTransform() const { return matrices->world; }
     
     // Transform utilities
     void lookAt(const glm::vec3& target, const glm::vec3& up = glm::vec3(0, 1, 0));
@@ -82,20 +547,198 @@ public:
     void rotate(const glm::vec3& axis, float angle);
     
 private:
+    TransformComponent* getParentTransform() const;
     void updateLocalTransform();
-    void updateWorldTransform();
+    void updateWorldTransform(TransformComponent* parentTransform);
+    
+    // Moves with the component, so compacting the storage doesn't copy it
+    std::unique_ptr<TransformMatrices> matrices = std::make_unique<TransformMatrices>();
+    
+    friend class TransformSystem;
+};
+
+/**
+ * @brief Flattened transform hierarchy for a scene
+ *
+ * Keeps every transform of a scene in one array sorted by depth, so each
+ * parent precedes its children, alongside each entry's parent index.
+ * update() pushes dirty flags down the hierarchy and recomputes only the
+ * dirty subtrees in a single linear pass. The order is rebuilt lazily
+ * after the hierarchy changes.
+ */
+class TransformSystem {
+public:
+    explicit TransformSystem(Scene& scene) : scene(scene) {}
+    
+    // Rebuilds dirty local matrices with the batch TransformKernels, then
+    // world matrices, and marks every transform whose world matrix changed
+    // since the last update
+    void update();
+    // Call when parents, entities or transform components change
+    void invalidate() { orderDirty = true; }
+    
+    std::size_t size() const { return transforms.size(); }
+    std::size_t getLastUpdatedCount() const { return lastUpdatedCount; }
+    
+private:
+    void rebuild();
+    void composeLocalTransforms();
+    
+    Scene& scene;
+    // Parallel arrays in depth order. Transforms stay in the scene's packed
+    // storage; they only move when the scene compacts it, which invalidates
+    // the order.
+    std::vector<TransformComponent*> transforms;
+    // Each transform's out-of-line matrices, so the world pass only reads these
+    std::vector<TransformMatrices*> matrices;
+    std::vector<std::int32_t> parents;
+    // Each transform's position in the scene's storage, for change stamps
+    std::vector<std::uint32_t> storageIndices;
+    std::vector<std::uint8_t> dirty;
+    // Per-update scratch: stale entries, and those whose local matrix is
+    // rebuilt through the batch kernel
+    std::vector<std::uint32_t> staleIndices;
+    std::vector<std::uint32_t> localIndices;
+    std::vector<float> batchInput;
+    std::vector<glm::mat4> batchOutput;
+    std::size_t lastUpdatedCount = 0;
+    bool orderDirty = true;
+};
+
+// Component types a SceneQuery matches on
+struct QueryFilter {
+    std::vector<std::uint32_t> allOf;
+    std::vector<std::uint32_t> anyOf;
+    std::vector<std::uint32_t> noneOf;
+    
+    template<typename... Ts>
+    QueryFilter& all() { (allOf.push_back(componentTypeId<Ts>()), ...); return *this; }
+    template<typename... Ts>
+    QueryFilter& any() { (anyOf.push_back(componentTypeId<Ts>()), ...); return *this; }
+    template<typename... Ts>
+    QueryFilter& none() { (noneOf.push_back(componentTypeId<Ts>()), ...); return *this; }
 };
 
-// Scene Node (Entity)
-class SceneNode {
+/**
+ * @brief Persistent set of the entities matching a QueryFilter
+ *
+ * Created and owned by a Scene, which updates membership as components are
+ * added and removed and as entities join, leave or are destroyed, so
+ * iterating costs nothing beyond the matches. Order is unspecified, and
+ * changing the query's component types while iterating is not supported.
+ *
+ *     SceneQuery* visible = scene->createQuery(QueryFilter().all<MeshComponent>().none<LightComponent>());
+ *     for (SceneNode* node : *visible) { ... }
+ */
+class SceneQuery {
 public:
-    SceneNode(EntityID id, const std::string& name = "Entity");
+    using Iterator = std::vector<SceneNode*>::const_iterator;
+    
+    Iterator begin() const { return nodes.begin(); }
+    Iterator end() const { return nodes.end(); }
+    std::size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+    bool contains(EntityID id) const { return members.contains(id); }
+    
+    const QueryFilter& getFilter() const { return filter; }
+    
+private:
+    explicit SceneQuery(const QueryFilter& filter) : filter(filter) {}
+    
+    bool matches(const Scene& scene, EntityID id) const;
+    void update(SceneNode* node, bool match);
+    
+    QueryFilter filter;
+    EntitySparseSet members;
+    // Parallel to members.getEntities()
+    std::vector<SceneNode*> nodes;
+    
+    friend class Scene;
+};
+
+/**
+ * @brief Structural changes recorded for later playback
+ *
+ * Creating, destroying and reparenting entities and adding or removing
+ * components all change vectors the scene update iterates. Record them here
+ * instead, from any job, and the scene applies them in one batch once the
+ * update's jobs are done. Each thread gets its own buffer from
+ * Scene::getCommandBuffer, so recording takes no lock.
+ *
+ * Commands from one buffer apply in order, except that destruction happens
+ * after all other commands of the batch. Commands naming an entity that no
+ * longer exists are skipped.
+ *
+ *     auto& commands = scene->getCommandBuffer();
+ *     auto bullet = commands.createEntity("Bullet");
+ *     commands.addComponent<MeshComponent>(bullet);
+ *     commands.destroyEntity(target->getID());
+ */
+class SceneCommandBuffer {
+public:
+    static constexpr std::uint32_t NotCreated = 0xFFFFFFFFu;
+    
+    // An existing entity, or one created earlier by the same buffer
+    struct EntityRef {
+        EntityRef() : id(InvalidEntityID), created(NotCreated) {}
+        EntityRef(EntityID id) : id(id), created(NotCreated) {}
+        
+        bool isNull() const { return id == InvalidEntityID && created == NotCreated; }
+        
+        EntityID id;
+        std::uint32_t created;
+    };
+    
+    // A null parent makes a root entity
+    EntityRef createEntity(const std::string& name = "Entity", EntityRef parent = {});
+    void destroyEntity(EntityRef entity);
+    // A null parent makes entity a root
+    void setParent(EntityRef entity, EntityRef parent);
+    
+    template<typename T, typename... Args>
+    void addComponent(EntityRef entity, Args&&... args);
+    template<typename T>
+    void removeComponent(EntityRef entity);
+    
+    bool empty() const { return commands.empty(); }
+    std::size_t size() const { return commands.size(); }
+    // Drops recorded commands but keeps their storage for the next frame
+    void clear();
+    
+private:
+    enum class CommandType : std::uint8_t {
+        Create,
+        Destroy,
+        SetParent,
+        Component
+    };
+    
+    struct Command {
+        CommandType type;
+        EntityRef entity;
+        EntityRef parent;
+        std::string name;
+        std::function<void(SceneNode&)> apply;
+    };
+    
+    std::vector<Command> commands;
+    std::uint32_t createdCount = 0;
+    std::uint32_t rootCreateCount = 0;
+    
+    friend class Scene;
+};
+
+// Scene Node (Entity), allocated from a shared ObjectPool
+class SceneNode : public PooledObject<SceneNode> {
+public:
+    SceneNode(EntityID id, const std::string& name = "Entity", Scene* scene = nullptr);
     ~SceneNode();
     
     // Entity identification
     EntityID getID() const { return id; }
     const std::string& getName() const { return name; }
-    void setName(const std::string& newName) { name = newName; }
+    // Also updates the scene's name index
+    void setName(const std::string& newName);
     
     // Hierarchy management
     void setParent(SceneNode* parent);
@@ -106,86 +749,105 @@ public:
     std::unique_ptr<SceneNode> removeChild(EntityID childId);
     void removeAllChildren();
     
-    // Component management
+    // Component management. Components of a node in a scene live in the
+    // scene's packed storage; a detached node keeps heap copies until it
+    // joins one.
+    //
+    // The returned pointer stays valid until the scene's next compaction,
+    // which Scene::update runs after playing back commands. A removed
+    // component stays readable through it until then. Joining or leaving
+    // a scene moves this node's components. Re-fetch with getComponent
+    // rather than holding a T* across an update.
     template<typename T, typename... Args>
-    T* addComponent(Args&&... args) {
-        auto component = std::make_unique<T>(std::forward<Args>(args)...);
-        T* ptr = component.get();
-        component->owner = this;
-        component->onAttach(this);
-        components[std::type_index(typeid(T))] = std::move(component);
-        return ptr;
-    }
-    
+    T* addComponent(Args&&... args);
+
+    // Same lifetime as addComponent's result
     template<typename T>
-    T* getComponent() {
-        auto it = components.find(std::type_index(typeid(T)));
-        if (it != components.end()) {
-            return static_cast<T*>(it->second.get());
-        }
-        return nullptr;
-    }
+    T* getComponent();
     
     template<typename T>
     const T* getComponent() const {
-        auto it = components.find(std::type_index(typeid(T)));
-        if (it != components.end()) {
-            return static_cast<const T*>(it->second.get());
-        }
-        return nullptr;
+        return const_cast<SceneNode*>(this)->getComponent<T>();
     }
     
     template<typename T>
     bool hasComponent() const {
-        return components.find(std::type_index(typeid(T))) != components.end();
+        return getComponent<T>() != nullptr;
     }
     // [FIX] Add non-templated version for ECS queries
     bool hasComponent(const std::type_index& type) const {
-        return components.find(type) != components.end();
+        return std::any_of(components.begin(), components.end(),
+                           [&type](const ComponentRecord& record) { return record.type == type; });
     }
     
     template<typename T>
-    void removeComponent() {
-        auto it = components.find(std::type_index(typeid(T)));
-        if (it != components.end()) {
-            it->second->onDetach(this);
-            components.erase(it);
-        }
-    }
+    void removeComponent();
+    
+    std::size_t getComponentCount() const { return components.size(); }
     
     // Transform shortcuts (delegates to TransformComponent)
     TransformComponent* getTransform();
     const TransformComponent* getTransform() const;
     
-    // Scene management
-    void setScene(Scene* scene) { this->scene = scene; }
+    // Scene management. Moves components between the node and the scene's
+    // storage, for this node and its children.
+    void setScene(Scene* scene);
     Scene* getScene() const { return scene; }
     
     // Update and render
     void update(float deltaTime);
+    // Runs this node's components, then fans the children out as jobs for up
+    // to splitLevels levels of the hierarchy and updates serially below
+    void update(float deltaTime, JobSystem& jobs, int splitLevels = 8);
     void render();
     
     // Utility methods
     bool isActive() const { return active; }
     void setActive(bool active) { this->active = active; }
     
-    // Find child by name
+    // Find descendant by name. In a scene, direct children come from the
+    // name index and deeper ones from checking the ancestors of each entity
+    // with that name.
     SceneNode* findChild(const std::string& name);
     const SceneNode* findChild(const std::string& name) const;
+    // Find descendant by a path of child names such as "Arm/Hand", one index
+    // lookup per level. Detached nodes return nullptr.
+    SceneNode* findChildByPath(const std::string& path) const;
     
-    // Find child by ID
+    // Find descendant by ID. In a scene this is an ID lookup and a walk up
+    // the found entity's parents.
     SceneNode* findChild(EntityID id);
     const SceneNode* findChild(EntityID id) const;
     
 private:
+    struct ComponentRecord {
+        std::type_index type;
+        std::uint32_t typeId;
+        ComponentStorageBase& (*storageIn)(Scene& scene);
+        std::unique_ptr<Component> detached;
+    };
+    
+    Component* resolve(const ComponentRecord& record) const;
+    
+    static constexpr std::uint32_t NoName = 0xFFFFFFFFu;
+    
     EntityID id;
     std::string name;
     SceneNode* parent = nullptr;
     std::vector<std::unique_ptr<SceneNode>> children;
-    std::unordered_map<std::type_index, std::unique_ptr<Component>> components;
+    std::vector<ComponentRecord> components;
     Scene* scene = nullptr;
     bool active = true;
     
+    // Name index entries, maintained by the scene. nameParent is the parent
+    // the entity was indexed under, which may already have changed when it
+    // is taken out.
+    std::uint32_t nameId = NoName;
+    std::uint32_t namePosition = 0;
+    EntityID nameParent = InvalidEntityID;
+    SceneNode* prevSameName = nullptr;
+    SceneNode* nextSameName = nullptr;
+    
     friend class Scene;
 };
 
@@ -199,20 +861,44 @@ public:
     const std::string& getName() const { return name; }
     void setName(const std::string& newName) { name = newName; }
     
-    // Entity creation and management
+    // Entity creation and management. An explicit ID is kept, generation
+    // included, when its slot is free; otherwise the entity gets a new one.
     SceneNode* createEntity(const std::string& name = "Entity");
     SceneNode* createEntity(EntityID id, const std::string& name = "Entity");
     // [NEW] Safely create a child entity and parent it
     SceneNode* createChildEntity(SceneNode* parent, const std::string& name = "Entity");
+    SceneNode* createChildEntity(SceneNode* parent, EntityID id, const std::string& name = "Entity");
     
     void destroyEntity(EntityID id);
     void destroyEntity(SceneNode* node);
+    // Destroys several entities, taking each parent's children apart once
+    void destroyEntities(std::vector<SceneNode*> nodes);
+    // Moves entity under parent, or to the roots if parent is nullptr.
+    // Refuses to make an entity its own ancestor.
+    bool reparentEntity(SceneNode* entity, SceneNode* parent);
+    // Destroys every entity
+    void clear();
     
-    SceneNode* getEntity(EntityID id);
-    const SceneNode* getEntity(EntityID id) const;
+    // A bounds check and a generation compare; stale IDs return nullptr
+    SceneNode* getEntity(EntityID id) {
+        return const_cast<SceneNode*>(static_cast<const Scene*>(this)->getEntity(id));
+    }
+    const SceneNode* getEntity(EntityID id) const {
+        std::uint32_t index = entityIndex(id);
+        if (index >= entitySlots.size()) return nullptr;
+        const EntitySlot& slot = entitySlots[index];
+        return slot.generation == entityGeneration(id) ? slot.node : nullptr;
+    }
     
+    // Name lookups go through an index of interned names. With several
+    // entities of one name, which one findEntity returns is unspecified.
     SceneNode* findEntity(const std::string& name);
     const SceneNode* findEntity(const std::string& name) const;
+    const std::vector<SceneNode*>& findEntities(const std::string& name) const;
+    // Follows a path of names from the roots, such as "Root/Arm/Hand", in
+    // one hash lookup per level. Among siblings sharing a name, the earliest
+    // indexed is taken.
+    SceneNode* findEntityByPath(const std::string& path) const;
     
     // Root entities
     const std::vector<std::unique_ptr<SceneNode>>& getRootEntities() const { return rootEntities; }
@@ -221,20 +907,103 @@ public:
     void update(float deltaTime);
     void render();
     
+    TransformSystem& getTransformSystem() { return transformSystem; }
+    
+    // Change tracking. Adding a component, and every write recorded with
+    // markChanged, stamps it with the current change version. Transforms
+    // are stamped by update() whenever their world matrix is recomputed,
+    // which includes an ancestor moving. A consumer keeps the version
+    // advanceChangeVersion returns at each pass and next time visits only
+    // what changed after it:
+    //
+    //     std::uint32_t since = synced;
+    //     synced = scene->advanceChangeVersion();
+    //     scene->view<TransformComponent, MeshComponent>().eachChanged(since, upload);
+    //
+    // Removals are not reported; track membership with a SceneQuery.
+    std::uint32_t getChangeVersion() const { return changeVersion; }
+    // Returns the current version and starts a new one. Not during update().
+    std::uint32_t advanceChangeVersion() { return changeVersion++; }
+    // For writes made through a component's fields
+    template<typename T>
+    void markChanged(EntityID id) {
+        if (ComponentStorage<T>* storage = findStorage<T>()) {
+            storage->markChanged(id);
+        }
+    }
+    
+    // Spreads update() over the job system's threads, one job per root
+    // subtree and per child subtree where a node has several. Sibling
+    // subtrees update concurrently, so their components must only touch
+    // their own subtree and must not change the scene's structure. nullptr,
+    // the default, updates everything on the calling thread.
+    void setJobSystem(JobSystem* jobs) { jobSystem = jobs; }
+    JobSystem* getJobSystem() const { return jobSystem; }
+    
+    // The calling thread's command buffer for this scene. update() plays all
+    // of them back after the component updates.
+    SceneCommandBuffer& getCommandBuffer();
+    // Applies and clears every thread's recorded commands. Call from one
+    // thread while nothing is recording.
+    void playbackCommands();
+    // Frees the slots of removed components, which moves others and ends
+    // the lifetime of component pointers. update() does this after
+    // playbackCommands; scenes that are never updated can call it directly.
+    void compactStorage();
+    
     // Scene hierarchy
     void addRootEntity(std::unique_ptr<SceneNode> entity);
     std::unique_ptr<SceneNode> removeRootEntity(EntityID id);
     
-    // Entity queries
-    std::vector<SceneNode*> getEntitiesWithComponent(const std::type_index& componentType);
+    // Entity queries. These copy the matches out of a cached query into
+    // frame memory, so the result is only good for the frames in flight;
+    // prefer createQuery for anything run every frame.
+    FrameVector<SceneNode*> getEntitiesWithComponent(const std::type_index& componentType);
     template<typename T>
-    std::vector<SceneNode*> getEntitiesWithComponent() {
+    FrameVector<SceneNode*> getEntitiesWithComponent() {
         return getEntitiesWithComponent(std::type_index(typeid(T)));
     }
     
-    // Scene serialization
-    void saveToFile(const std::string& filename);
-    void loadFromFile(const std::string& filename);
+    // Persistent queries, owned by the scene and kept current as components
+    // and entities change
+    SceneQuery* createQuery(const QueryFilter& filter);
+    void destroyQuery(SceneQuery* query);
+    
+    bool hasComponent(std::uint32_t typeId, EntityID id) const {
+        return typeId < storages.size() && storages[typeId] && storages[typeId]->contains(id);
+    }
+    
+    // Packed component storage
+    template<typename... Ts>
+    SceneView<Ts...> view() const {
+        return SceneView<Ts...>(findStorage<Ts>()...);
+    }
+    
+    template<typename T>
+    ComponentStorage<T>* findStorage() const {
+        std::uint32_t typeId = componentTypeId<T>();
+        return typeId < storages.size() ? static_cast<ComponentStorage<T>*>(storages[typeId].get()) : nullptr;
+    }
+    
+    template<typename T>
+    ComponentStorage<T>& getStorage() {
+        std::uint32_t typeId = componentTypeId<T>();
+        if (typeId >= storages.size()) {
+            storages.resize(typeId + 1);
+        }
+        if (!storages[typeId]) {
+            storages[typeId] = std::make_unique<ComponentStorage<T>>(changeVersion);
+            typeIds.emplace(std::type_index(typeid(T)), typeId);
+        }
+        return static_cast<ComponentStorage<T>&>(*storages[typeId]);
+    }
+    
+    // Scene serialization, in the versioned binary format described in
+    // SceneGraph.cpp. Entities keep their IDs, hierarchy and built-in
+    // components; scripts are not saved. Loading replaces the scene's
+    // entities, and leaves the scene untouched if the file is invalid.
+    bool saveToFile(const std::string& filename);
+    bool loadFromFile(const std::string& filename);
     
     // Scene statistics
     size_t getEntityCount() const;
@@ -242,16 +1011,155 @@ public:
     
 private:
     std::string name;
+    // Stamped on component writes; starts above 0, which means never
+    std::uint32_t changeVersion = 1;
+    // Indexed by componentTypeId, declared before the entities so it
+    // outlives them
+    std::vector<std::unique_ptr<ComponentStorageBase>> storages;
+    std::unordered_map<std::type_index, std::uint32_t> typeIds;
+    // Queries and, per component type, the queries that mention it
+    std::vector<std::unique_ptr<SceneQuery>> queries;
+    std::vector<std::vector<SceneQuery*>> queriesByType;
+    std::unordered_map<std::uint32_t, SceneQuery*> componentQueries;
+    TransformSystem transformSystem;
+    JobSystem* jobSystem = nullptr;
+    
+    // One slot per entity index, declared before the entities so it outlives
+    // them. Slot 0 is never handed out. A slot whose generation runs out is
+    // retired rather than reused.
+    struct EntitySlot {
+        static constexpr std::uint32_t NotFree = 0xFFFFFFFFu;
+        SceneNode* node = nullptr;
+        std::uint32_t generation = 0;
+        // Position in freeEntitySlots, or NotFree while in use or retired
+        std::uint32_t freePosition = NotFree;
+    };
+    std::vector<EntitySlot> entitySlots = std::vector<EntitySlot>(1);
+    std::vector<std::uint32_t> freeEntitySlots;
+    std::size_t entityCount = 0;
+    
     std::vector<std::unique_ptr<SceneNode>> rootEntities;
-    std::unordered_map<EntityID, SceneNode*> entityMap;
-    EntityID nextEntityID = 1;
     
-    // Helper methods
-    void registerEntity(SceneNode* entity);
-    void unregisterEntity(SceneNode* entity);
-    EntityID generateEntityID();
+    // Name index: interned names, the entities with each name, and per
+    // (parent ID, name) the siblings with that name, linked through the
+    // nodes. Roots use parent ID 0. Interned names are kept for the scene's
+    // lifetime.
+    struct NamedSiblings {
+        SceneNode* first = nullptr;
+        SceneNode* last = nullptr;
+    };
+    std::unordered_map<std::string, std::uint32_t> nameIds;
+    std::vector<std::vector<SceneNode*>> entitiesByName;
+    std::unordered_map<std::uint64_t, NamedSiblings> siblingsByName;
+    
+    // One command buffer per recording thread
+    const std::uint64_t serial;
+    std::mutex commandBufferMutex;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<SceneCommandBuffer>>> commandBuffers;
+    
+    // Entity ID slots. An ID is reserved by allocate or claim, bound to its
+    // node when the node joins the scene and freed when it leaves.
+    EntityID allocateEntityID();
+    EntityID claimEntityID(EntityID id);
+    void bindEntity(SceneNode* entity);
+    void releaseEntity(SceneNode* entity);
+    void takeFreeSlot(std::uint32_t index);
+    // Drops the root list's ownership without destroying the entity
+    void releaseRootEntity(SceneNode* entity);
+    
+    // Name index maintenance
+    std::uint32_t findNameId(const std::string& name) const;
+    void indexName(SceneNode* entity);
+    void unindexName(SceneNode* entity);
+    // Re-files an entity whose parent changed
+    void reindexName(SceneNode* entity);
+    SceneNode* findNamedChild(EntityID parent, const std::string& name) const;
+    SceneNode* resolvePath(EntityID start, const std::string& path) const;
+    
+    // Query maintenance
+    void onComponentChanged(SceneNode* entity, std::uint32_t typeId);
+    void onEntityAttached(SceneNode* entity);
+    void onEntityDetached(SceneNode* entity);
+    
+    template<typename T>
+    static ComponentStorageBase& storageOf(Scene& scene) {
+        return scene.getStorage<T>();
+    }
+    
+    friend class SceneNode;
 };
 
+// SceneNode component templates, defined once Scene is complete
+template<typename T, typename... Args>
+T* SceneNode::addComponent(Args&&... args) {
+    // Replaces an existing T, as assigning into the old map did
+    removeComponent<T>();
+    
+    T* ptr = nullptr;
+    std::unique_ptr<Component> detached;
+    if (scene) {
+        ptr = scene->getStorage<T>().emplace(id, std::forward<Args>(args)...);
+    } else {
+        auto component = std::make_unique<T>(std::forward<Args>(args)...);
+        ptr = component.get();
+        detached = std::move(component);
+    }
+    components.push_back(ComponentRecord{std::type_index(typeid(T)), componentTypeId<T>(),
+                                         &Scene::storageOf<T>, std::move(detached)});
+    ptr->owner = this;
+    if (scene) {
+        scene->onComponentChanged(this, componentTypeId<T>());
+    }
+    ptr->onAttach(this);
+    return ptr;
+}
+
+template<typename T>
+T* SceneNode::getComponent() {
+    if (scene) {
+        ComponentStorage<T>* storage = scene->findStorage<T>();
+        return storage ? storage->get(id) : nullptr;
+    }
+    std::uint32_t typeId = componentTypeId<T>();
+    for (const ComponentRecord& record : components) {
+        if (record.typeId == typeId) {
+            return static_cast<T*>(record.detached.get());
+        }
+    }
+    return nullptr;
+}
+
+template<typename T>
+void SceneNode::removeComponent() {
+    std::uint32_t typeId = componentTypeId<T>();
+    auto it = std::find_if(components.begin(), components.end(),
+                           [typeId](const ComponentRecord& record) { return record.typeId == typeId; });
+    if (it != components.end()) {
+        resolve(*it)->onDetach(this);
+        components.erase(it);
+        if (scene) {
+            scene->getStorage<T>().remove(id);
+            scene->onComponentChanged(this, typeId);
+        }
+    }
+}
+
+template<typename T, typename... Args>
+void SceneCommandBuffer::addComponent(EntityRef entity, Args&&... args) {
+    Command command{CommandType::Component, entity, {}, {}, {}};
+    command.apply = [arguments = std::make_tuple(std::forward<Args>(args)...)](SceneNode& node) mutable {
+        std::apply([&node](auto&&... values) { node.addComponent<T>(std::move(values)...); }, std::move(arguments));
+    };
+    commands.push_back(std::move(command));
+}
+
+template<typename T>
+void SceneCommandBuffer::removeComponent(EntityRef entity) {
+    Command command{CommandType::Component, entity, {}, {}, {}};
+    command.apply = [](SceneNode& node) { node.removeComponent<T>(); };
+    commands.push_back(std::move(command));
+}
+
 // Built-in components
 
 // Mesh component
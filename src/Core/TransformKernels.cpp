@@ -0,0 +1,280 @@
+#include "TransformKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VF_TRANSFORM_KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX instructions in functions that ask for them;
+// MSVC accepts the intrinsics anywhere
+#if defined(VF_TRANSFORM_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define VF_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VF_TARGET_AVX2
+#endif
+
+namespace VaporFrame {
+namespace Core {
+
+namespace {
+
+// Column-major, like glm: column c of matrix i starts at out + 16 * i + 4 * c.
+// The SIMD kernels evaluate the same expressions in the same order so all
+// kernels produce identical results.
+void composeOne(const TransformBatch& batch, std::size_t i) {
+    float x = batch.rotationX[i], y = batch.rotationY[i], z = batch.rotationZ[i], w = batch.rotationW[i];
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+    float sx = batch.scaleX[i], sy = batch.scaleY[i], sz = batch.scaleZ[i];
+    
+    float* out = &batch.matrices[i][0][0];
+    out[0] = (1.0f - 2.0f * (yy + zz)) * sx;
+    out[1] = (2.0f * (xy + wz)) * sx;
+    out[2] = (2.0f * (xz - wy)) * sx;
+    out[3] = 0.0f;
+    out[4] = (2.0f * (xy - wz)) * sy;
+    out[5] = (1.0f - 2.0f * (xx + zz)) * sy;
+    out[6] = (2.0f * (yz + wx)) * sy;
+    out[7] = 0.0f;
+    out[8] = (2.0f * (xz + wy)) * sz;
+    out[9] = (2.0f * (yz - wx)) * sz;
+    out[10] = (1.0f - 2.0f * (xx + yy)) * sz;
+    out[11] = 0.0f;
+    out[12] = batch.positionX[i];
+    out[13] = batch.positionY[i];
+    out[14] = batch.positionZ[i];
+    out[15] = 1.0f;
+}
+
+void composeScalar(const TransformBatch& batch, std::size_t begin) {
+    for (std::size_t i = begin; i < batch.count; ++i) {
+        composeOne(batch, i);
+    }
+}
+
+#ifdef VF_TRANSFORM_KERNELS_X86
+
+// Writes one column of four matrices from its four elements, each register
+// holding that element for all four transforms
+inline void storeColumn4(float* out, int column, __m128 a, __m128 b, __m128 c, __m128 d) {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    _mm_storeu_ps(out + 4 * column, a);
+    _mm_storeu_ps(out + 16 + 4 * column, b);
+    _mm_storeu_ps(out + 32 + 4 * column, c);
+    _mm_storeu_ps(out + 48 + 4 * column, d);
+}
+
+// Four transforms per iteration
+void composeSSE(const TransformBatch& batch) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+    
+    std::size_t i = 0;
+    for (; i + 4 <= batch.count; i += 4) {
+        __m128 x = _mm_loadu_ps(batch.rotationX + i);
+        __m128 y = _mm_loadu_ps(batch.rotationY + i);
+        __m128 z = _mm_loadu_ps(batch.rotationZ + i);
+        __m128 w = _mm_loadu_ps(batch.rotationW + i);
+        __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+        __m128 sx = _mm_loadu_ps(batch.scaleX + i);
+        __m128 sy = _mm_loadu_ps(batch.scaleY + i);
+        __m128 sz = _mm_loadu_ps(batch.scaleZ + i);
+        
+        float* out = &batch.matrices[i][0][0];
+        storeColumn4(out, 0,
+                     _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+                     _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+                     _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+                     zero);
+        storeColumn4(out, 1,
+                     _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+                     _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+                     _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+                     zero);
+        storeColumn4(out, 2,
+                     _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+                     _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+                     _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+                     zero);
+        storeColumn4(out, 3,
+                     _mm_loadu_ps(batch.positionX + i),
+                     _mm_loadu_ps(batch.positionY + i),
+                     _mm_loadu_ps(batch.positionZ + i),
+                     one);
+    }
+    composeScalar(batch, i);
+}
+
+// Writes one column of eight matrices from its four elements
+VF_TARGET_AVX2 inline void storeColumn8(float* out, int column, __m256 a, __m256 b, __m256 c, __m256 d) {
+    // 4x4 transposes within each 128-bit lane: the low lane holds
+    // transforms 0-3 and the high lane transforms 4-7
+    __m256 t0 = _mm256_unpacklo_ps(a, b);
+    __m256 t1 = _mm256_unpackhi_ps(a, b);
+    __m256 t2 = _mm256_unpacklo_ps(c, d);
+    __m256 t3 = _mm256_unpackhi_ps(c, d);
+    __m256 v[4] = {
+        _mm256_shuffle_ps(t0, t2, 0x44),
+        _mm256_shuffle_ps(t0, t2, 0xEE),
+        _mm256_shuffle_ps(t1, t3, 0x44),
+        _mm256_shuffle_ps(t1, t3, 0xEE),
+    };
+    for (int k = 0; k < 4; ++k) {
+        _mm_storeu_ps(out + 16 * k + 4 * column, _mm256_castps256_ps128(v[k]));
+        _mm_storeu_ps(out + 16 * (k + 4) + 4 * column, _mm256_extractf128_ps(v[k], 1));
+    }
+}
+
+// Eight transforms per iteration, otherwise the same as composeSSE
+VF_TARGET_AVX2 void composeAVX2(const TransformBatch& batch) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    
+    std::size_t i = 0;
+    for (; i + 8 <= batch.count; i += 8) {
+        __m256 x = _mm256_loadu_ps(batch.rotationX + i);
+        __m256 y = _mm256_loadu_ps(batch.rotationY + i);
+        __m256 z = _mm256_loadu_ps(batch.rotationZ + i);
+        __m256 w = _mm256_loadu_ps(batch.rotationW + i);
+        __m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+        __m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+        __m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+        __m256 sx = _mm256_loadu_ps(batch.scaleX + i);
+        __m256 sy = _mm256_loadu_ps(batch.scaleY + i);
+        __m256 sz = _mm256_loadu_ps(batch.scaleZ + i);
+        
+        float* out = &batch.matrices[i][0][0];
+        storeColumn8(out, 0,
+                     _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+                     _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+                     _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+                     zero);
+        storeColumn8(out, 1,
+                     _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+                     _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+                     _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+                     zero);
+        storeColumn8(out, 2,
+                     _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+                     _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+                     _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+                     zero);
+        storeColumn8(out, 3,
+                     _mm256_loadu_ps(batch.positionX + i),
+                     _mm256_loadu_ps(batch.positionY + i),
+                     _mm256_loadu_ps(batch.positionZ + i),
+                     one);
+    }
+    composeScalar(batch, i);
+}
+
+bool cpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    // The OS must save the YMM registers across context switches
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    // Also checks that the OS saves the YMM registers
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+TransformKernel detectKernel() {
+#ifdef VF_TRANSFORM_KERNELS_X86
+    return cpuHasAVX2() ? TransformKernel::AVX2 : TransformKernel::SSE;
+#else
+    return TransformKernel::Scalar;
+#endif
+}
+
+} // namespace
+
+void TransformKernels::compose(const TransformBatch& batch) {
+    compose(batch, getActiveKernel());
+}
+
+void TransformKernels::compose(const TransformBatch& batch, TransformKernel kernel) {
+    if (!isSupported(kernel)) {
+        kernel = TransformKernel::Scalar;
+    }
+    switch (kernel) {
+#ifdef VF_TRANSFORM_KERNELS_X86
+        case TransformKernel::AVX2:
+            composeAVX2(batch);
+            break;
+        case TransformKernel::SSE:
+            composeSSE(batch);
+            break;
+#endif
+        default:
+            composeScalar(batch, 0);
+            break;
+    }
+}
+
+glm::mat4 TransformKernels::compose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    glm::mat4 matrix;
+    TransformBatch batch;
+    batch.positionX = &position.x;
+    batch.positionY = &position.y;
+    batch.positionZ = &position.z;
+    batch.rotationX = &rotation.x;
+    batch.rotationY = &rotation.y;
+    batch.rotationZ = &rotation.z;
+    batch.rotationW = &rotation.w;
+    batch.scaleX = &scale.x;
+    batch.scaleY = &scale.y;
+    batch.scaleZ = &scale.z;
+    batch.matrices = &matrix;
+    batch.count = 1;
+    composeOne(batch, 0);
+    return matrix;
+}
+
+TransformKernel TransformKernels::getActiveKernel() {
+    static const TransformKernel active = detectKernel();
+    return active;
+}
+
+bool TransformKernels::isSupported(TransformKernel kernel) {
+    switch (kernel) {
+        case TransformKernel::Scalar:
+            return true;
+#ifdef VF_TRANSFORM_KERNELS_X86
+        case TransformKernel::SSE:
+            return true;
+        case TransformKernel::AVX2:
+            return getActiveKernel() == TransformKernel::AVX2;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* TransformKernels::getName(TransformKernel kernel) {
+    switch (kernel) {
+        case TransformKernel::SSE: return "SSE";
+        case TransformKernel::AVX2: return "AVX2";
+        default: return "Scalar";
+    }
+}
+
+} // namespace Core
+} // namespace VaporFrame
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+
+namespace VaporFrame {
+namespace Core {
+
+// Instruction sets the batch transform kernel has implementations for
+enum class TransformKernel {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+/**
+ * @brief Structure-of-arrays input and output for a batch of transforms
+ *
+ * Each array holds count elements. Rotations are unit quaternions.
+ */
+struct TransformBatch {
+    const float* positionX = nullptr;
+    const float* positionY = nullptr;
+    const float* positionZ = nullptr;
+    const float* rotationX = nullptr;
+    const float* rotationY = nullptr;
+    const float* rotationZ = nullptr;
+    const float* rotationW = nullptr;
+    const float* scaleX = nullptr;
+    const float* scaleY = nullptr;
+    const float* scaleZ = nullptr;
+    glm::mat4* matrices = nullptr;
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Batched translate * rotate * scale matrix construction
+ *
+ * Builds the same matrix as glm::translate * glm::mat4_cast * glm::scale,
+ * straight from the quaternion without intermediate matrices, several
+ * transforms per instruction where the CPU allows. The kernel is picked
+ * once from the CPU's features; x86-64 always has SSE, and other targets
+ * use the scalar path.
+ */
+class TransformKernels {
+public:
+    static void compose(const TransformBatch& batch);
+    static void compose(const TransformBatch& batch, TransformKernel kernel);
+    
+    // Single transform, matches the scalar kernel exactly
+    static glm::mat4 compose(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+    
+    static TransformKernel getActiveKernel();
+    static bool isSupported(TransformKernel kernel);
+    static const char* getName(TransformKernel kernel);
+};
+
+} // namespace Core
+} // namespace VaporFrame
@@ -1,5 +1,6 @@
 #include "WebViewUI.h"
 #include "Logger.h"
+#include "MemoryManager.h"
 #include <fstream>
 #include <sstream>
 #include <filesystem>
@@ -177,17 +178,20 @@ void WebViewUI::registerCallback(const std::string& name, std::function<void(con
     VF_LOG_INFO("Registered WebView callback: {}", name);
 }
 
-void WebViewUI::executeJavaScript(const std::string& script) {
+void WebViewUI::executeJavaScript(std::string_view script) {
     if (!initialized) return;
 
     // TODO: Execute JavaScript in WebView
     VF_LOG_DEBUG("Executing JavaScript: {}", script);
 }
 
-void WebViewUI::callJavaScriptFunction(const std::string& functionName, const std::string& parameters) {
+void WebViewUI::callJavaScriptFunction(std::string_view functionName, std::string_view parameters) {
     if (!initialized) return;
 
-    std::string script = functionName + "(" + parameters + ");";
+    // Called every frame for stats, so the script is built in frame memory
+    FrameString script;
+    script.reserve(functionName.size() + parameters.size() + 3);
+    script.append(functionName).append("(").append(parameters).append(");");
     executeJavaScript(script);
 }
 
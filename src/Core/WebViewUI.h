@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -31,8 +32,8 @@ public:
     
     // JavaScript bridge
     void registerCallback(const std::string& name, std::function<void(const std::string&)> callback);
-    void executeJavaScript(const std::string& script);
-    void callJavaScriptFunction(const std::string& functionName, const std::string& parameters = "");
+    void executeJavaScript(std::string_view script);
+    void callJavaScriptFunction(std::string_view functionName, std::string_view parameters = {});
     
     // Asset management
     void reloadAssets();
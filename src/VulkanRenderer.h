@@ -148,6 +148,9 @@ const std::vector<uint16_t> indices_global = {
 
 class VulkanRenderer {
 public:
+    // Frames the CPU may record ahead of the GPU; frame-scoped CPU memory is buffered to match
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+
     VulkanRenderer(GLFWwindow* windowRef, const std::vector<const char*>& validationLayersRef, bool enableValidationLayersRef);
     ~VulkanRenderer();
 
@@ -246,7 +249,6 @@ private:
     VkBuffer uiIndexBuffer = VK_NULL_HANDLE;
     VkDeviceMemory uiIndexBufferMemory = VK_NULL_HANDLE;
 
-    const int MAX_FRAMES_IN_FLIGHT = 2;
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
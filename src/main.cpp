@@ -110,6 +110,14 @@ private:
         
         // Initialize memory manager
         MemoryManager::getInstance().initialize();
+#ifdef NDEBUG
+        // Sampled tracking still measures a few percent on allocation churn, so
+        // release builds leave it off. Turning it on records one allocation per 512KB.
+        MemoryTracker::getInstance().setSampleInterval(512 * 1024);
+        MemoryTracker::getInstance().enableTracking(false);
+#endif
+        // Per-frame scratch memory lives as long as the renderer may still be using that frame
+        MemoryManager::getInstance().createFrameArena(4 * 1024 * 1024, VulkanRenderer::MAX_FRAMES_IN_FLIGHT);
         VF_LOG_INFO("Memory manager initialized successfully");
         
         // [3] Initialize SceneManager and create main scene
@@ -261,8 +269,8 @@ private:
                 auto& memoryManager = MemoryManager::getInstance();
                 auto stats = memoryManager.getGlobalStats();
                 
-                // Create stats JSON
-                std::string statsJson = "{";
+                // Create stats JSON in frame memory, it only lives until the call below
+                FrameString statsJson = "{";
                 statsJson += "\"fps\":" + std::to_string(60.0f); // TODO: Get actual FPS
                 statsJson += ",\"memoryUsage\":" + std::to_string(stats.currentUsage);
                 statsJson += ",\"renderTime\":" + std::to_string(16.7f); // TODO: Get actual render time
@@ -298,9 +306,15 @@ private:
         
         while (!glfwWindowShouldClose(window)) {
             frameCount++;
+            MemoryManager::getInstance().beginFrame();
             if (frameCount % 60 == 0) { // Log every 60 frames (1 second at 60fps)
                 VF_LOG_INFO("Main loop iteration: {}", frameCount);
             }
+            // Close a few pool holes each frame, moving relocatable blocks only
+            MemoryManager::getInstance().defragment(std::chrono::microseconds(200));
+            if (frameCount % 600 == 0) { // Hand idle pool pages back every ~10 seconds
+                MemoryManager::getInstance().trim();
+            }
             
             glfwPollEvents();
             
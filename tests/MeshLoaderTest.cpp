@@ -0,0 +1,432 @@
+#include "../src/Core/MeshLoader.h"
+#include "../src/Core/JobSystem.h"
+#include "../src/Core/Logger.h"
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+using namespace VaporFrame::Core;
+
+namespace {
+
+// Writes a size x size grid of quads with positions, texture coordinates
+// and normals, as an exporter would. Relative grids index back from the
+// last vertex and switch material every row.
+void writeGridOBJ(const std::string& path, int size, bool relative = false) {
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> height(-1.0f, 1.0f);
+    std::string text;
+    char line[128];
+    text += "# Generated grid\nmtllib mesh_test.mtl\no Grid\n";
+    for (int z = 0; z <= size; ++z) {
+        for (int x = 0; x <= size; ++x) {
+            text.append(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n",
+                                             x * 0.01f, height(rng), z * 0.01f));
+            text.append(line, std::snprintf(line, sizeof(line), "vt %.6f %.6f\n",
+                                             static_cast<float>(x) / size, static_cast<float>(z) / size));
+            text.append(line, std::snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", 0.0f, 1.0f, 0.0f));
+        }
+    }
+    text += "usemtl Ground\ns 1\n";
+    const int vertexCount = (size + 1) * (size + 1);
+    for (int z = 0; z < size; ++z) {
+        if (relative) {
+            text += "usemtl Row" + std::to_string(z % 7) + "\n";
+        }
+        for (int x = 0; x < size; ++x) {
+            int a = z * (size + 1) + x + 1 - (relative ? vertexCount + 1 : 0);
+            int b = a + 1;
+            int c = a + size + 1;
+            int d = c + 1;
+            text.append(line, std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                                             a, a, a, c, c, c, d, d, d, b, b, b));
+        }
+    }
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+}
+
+bool sameMesh(const Mesh& a, const Mesh& b) {
+    if (a.submeshes.size() != b.submeshes.size() || a.materials.size() != b.materials.size()) return false;
+    for (std::size_t i = 0; i < a.materials.size(); ++i) {
+        if (a.materials[i].name != b.materials[i].name || a.materials[i].diffuse != b.materials[i].diffuse) return false;
+    }
+    for (std::size_t i = 0; i < a.submeshes.size(); ++i) {
+        const Submesh& x = a.submeshes[i];
+        const Submesh& y = b.submeshes[i];
+        if (x.materialIndex != y.materialIndex || x.indices != y.indices || x.vertices.size() != y.vertices.size()) {
+            return false;
+        }
+        for (std::size_t v = 0; v < x.vertices.size(); ++v) {
+            if (x.vertices[v].position != y.vertices[v].position || x.vertices[v].normal != y.vertices[v].normal ||
+                x.vertices[v].texCoord != y.vertices[v].texCoord) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Triangles by their corners' attributes, each rotated to start at its
+// smallest corner and then sorted, so two index buffers compare equal
+// when they draw the same triangles with the same winding
+std::vector<std::array<float, 15>> triangleSet(const Submesh& submesh) {
+    std::vector<std::array<float, 15>> triangles;
+    for (std::size_t t = 0; t + 2 < submesh.indices.size(); t += 3) {
+        std::array<std::array<float, 5>, 3> corners;
+        for (int c = 0; c < 3; ++c) {
+            const Vertex& vertex = submesh.vertices[submesh.indices[t + c]];
+            corners[c] = {vertex.position.x, vertex.position.y, vertex.position.z, vertex.texCoord.x, vertex.texCoord.y};
+        }
+        int first = static_cast<int>(std::min_element(corners.begin(), corners.end()) - corners.begin());
+        std::array<float, 15> triangle;
+        for (int c = 0; c < 3; ++c) {
+            std::copy(corners[(first + c) % 3].begin(), corners[(first + c) % 3].end(), triangle.begin() + c * 5);
+        }
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// Shuffles the triangle order and the vertex layout, as an exporter that
+// ignores the vertex cache would leave them
+void shuffleSubmesh(Submesh& submesh, std::mt19937& rng) {
+    std::vector<uint32_t> order(submesh.indices.size() / 3);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<uint32_t> remap(submesh.vertices.size());
+    std::iota(remap.begin(), remap.end(), 0u);
+    std::shuffle(remap.begin(), remap.end(), rng);
+
+    std::vector<Vertex> vertices(submesh.vertices.size());
+    for (std::size_t v = 0; v < remap.size(); ++v) {
+        vertices[remap[v]] = submesh.vertices[v];
+    }
+    std::vector<uint32_t> indices;
+    for (uint32_t t : order) {
+        for (int c = 0; c < 3; ++c) {
+            indices.push_back(remap[submesh.indices[t * 3 + c]]);
+        }
+    }
+    submesh.vertices = std::move(vertices);
+    submesh.indices = std::move(indices);
+}
+
+} // namespace
+
+int main() {
+    // Initialize logger
+    VaporFrame::Logger::getInstance().initialize("meshloader_test.log");
+    VF_LOG_INFO("Starting Mesh Loader Test");
+
+    MeshLoader& loader = MeshLoader::getInstance();
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+
+    // Test 1: OBJ Parsing
+    VF_LOG_INFO("=== Test 1: OBJ Parsing ===");
+
+    {
+        // Comments, tabs, CRLF, a quad, relative indices, v//vn corners and
+        // a material library
+        std::ofstream("mesh_test.mtl", std::ios::binary | std::ios::trunc)
+            << "newmtl Red\nKd 1 0 0\nNs 64\n\nnewmtl Blue\r\nKd 0 0 1\r\nd 0.5\r\nmap_Kd blue.png\r\n";
+        std::ofstream("mesh_test.obj", std::ios::binary | std::ios::trunc)
+            << "# test\nmtllib mesh_test.mtl\n"
+               "v 0 0 0\nv 1 0 0\nv\t1 1 0\r\nv 0 1 0 1.0\n"
+               "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+               "vn 0 0 1\n"
+               "  usemtl Blue\n"
+               "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+               "f -4//-1 -2//-1 -1//-1\r\n"
+               "f 1 2\n"
+               "v 2 2 2\n"
+               "f 5 1 2\n";
+
+        Mesh mesh("mesh_test.obj");
+        bool parsed = loader.parseOBJ("mesh_test.obj", mesh);
+        bool correct = parsed && mesh.submeshes.size() == 1 && mesh.materials.size() == 3;
+        if (correct) {
+            const Submesh& submesh = mesh.submeshes[0];
+            const Material& blue = mesh.materials[submesh.materialIndex];
+            // Quad fans into two triangles, then one triangle each from the
+            // relative face and the late vertex; "f 1 2" is ignored
+            correct = submesh.indices.size() == 12 && blue.name == "Blue" && blue.diffuse == glm::vec3(0, 0, 1) &&
+                      blue.alpha == 0.5f && blue.diffuseMap == "blue.png" && mesh.materials[1].shininess == 64.0f;
+        }
+        if (correct) {
+            const Submesh& submesh = mesh.submeshes[0];
+            auto corner = [&](std::size_t n) { return submesh.vertices[submesh.indices[n]]; };
+            correct = corner(0).position == glm::vec3(0, 0, 0) && corner(1).position == glm::vec3(1, 0, 0) &&
+                      corner(2).position == glm::vec3(1, 1, 0) && corner(5).position == glm::vec3(0, 1, 0) &&
+                      corner(2).texCoord == glm::vec2(1, 1) && corner(0).normal == glm::vec3(0, 0, 1) &&
+                      corner(6).position == glm::vec3(0, 0, 0) && corner(7).position == glm::vec3(1, 1, 0) &&
+                      corner(6).texCoord == glm::vec2(0, 0) && corner(6).normal == glm::vec3(0, 0, 1) &&
+                      corner(9).position == glm::vec3(2, 2, 2);
+        }
+
+        Mesh missing;
+        correct = correct && !loader.parseOBJ("mesh_test_missing.obj", missing);
+
+        if (correct) {
+            VF_LOG_INFO("✓ OBJ records, materials and relative indices parsed");
+        } else {
+            VF_LOG_WARN("✗ OBJ parse produced the wrong mesh");
+        }
+    }
+
+    // Test 2: Parse Throughput
+    VF_LOG_INFO("=== Test 2: Parse Throughput ===");
+
+    {
+        writeGridOBJ("mesh_test_grid.obj", 600);
+        std::ifstream sizeProbe("mesh_test_grid.obj", std::ios::binary | std::ios::ate);
+        double megabytes = static_cast<double>(sizeProbe.tellg()) / (1024.0 * 1024.0);
+
+        Mesh mesh("mesh_test_grid.obj");
+        auto start = std::chrono::high_resolution_clock::now();
+        bool parsed = loader.parseOBJ("mesh_test_grid.obj", mesh);
+        auto done = std::chrono::high_resolution_clock::now();
+        VF_LOG_INFO("Parsed {:.1f} MB OBJ in {:.1f} ms ({:.0f} MB/s), {} vertices, {} indices", megabytes,
+                    ms(start, done), megabytes / (ms(start, done) / 1000.0),
+                    parsed ? mesh.submeshes[0].vertices.size() : 0, parsed ? mesh.submeshes[0].indices.size() : 0);
+
+        if (parsed && mesh.submeshes[0].indices.size() == 600u * 600u * 6u) {
+            VF_LOG_INFO("✓ Large OBJ parsed");
+        } else {
+            VF_LOG_WARN("✗ Large OBJ parse failed");
+        }
+    }
+
+    // Test 3: Parallel Parsing
+    VF_LOG_INFO("=== Test 3: Parallel Parsing ===");
+
+    {
+        // Relative indices and material switches spread over every slice
+        writeGridOBJ("mesh_test_relative.obj", 600, true);
+        Mesh serial("serial");
+        auto start = std::chrono::high_resolution_clock::now();
+        bool correct = loader.parseOBJ("mesh_test_relative.obj", serial);
+        double serialTime = ms(start, std::chrono::high_resolution_clock::now());
+        VF_LOG_INFO("OBJ parse, serial:     {:.1f} ms", serialTime);
+
+        for (std::size_t workers : {0, 1, 3, 7}) {
+            JobSystem jobs(workers);
+            loader.setJobSystem(&jobs);
+            Mesh parallel("parallel");
+            start = std::chrono::high_resolution_clock::now();
+            correct = loader.parseOBJ("mesh_test_relative.obj", parallel) && correct && sameMesh(serial, parallel);
+            double time = ms(start, std::chrono::high_resolution_clock::now());
+            VF_LOG_INFO("OBJ parse, {} threads: {:.1f} ms ({:.2f}x)", jobs.getThreadCount(), time, serialTime / time);
+        }
+        loader.setJobSystem(nullptr);
+        correct = correct && serial.submeshes[0].indices.size() == 600u * 600u * 6u && serial.materials.size() == 11 &&
+                  serial.submeshes[0].vertices[0].position.x == 0.0f;
+
+        if (correct) {
+            VF_LOG_INFO("✓ Parallel parse matches the serial one");
+        } else {
+            VF_LOG_WARN("✗ Parallel parse diverged from the serial one");
+        }
+    }
+
+    // Test 4: Vertex Deduplication
+    VF_LOG_INFO("=== Test 4: Vertex Deduplication ===");
+
+    {
+        // Unroll the cube into one vertex per corner, nudge every copy by
+        // less than the tolerance and merge them back
+        auto cube = MeshUtils::createCube();
+        Submesh& submesh = cube->submeshes[0];
+        std::vector<Vertex> original = submesh.vertices;
+        std::vector<Vertex> expanded;
+        for (uint32_t index : submesh.indices) {
+            expanded.push_back(submesh.vertices[index]);
+            expanded.back().position.x += (expanded.size() % 3) * 1e-7f;
+        }
+        std::vector<uint32_t> unrolled(expanded.size());
+        std::iota(unrolled.begin(), unrolled.end(), 0u);
+        std::vector<uint32_t> topology = submesh.indices;
+        submesh.vertices = expanded;
+        submesh.indices = unrolled;
+
+        MeshUtils::removeDuplicateVertices(*cube);
+        bool correct = submesh.vertices.size() == original.size() && cube->totalVertices == original.size() &&
+                       submesh.indices.size() == topology.size();
+        for (std::size_t i = 0; correct && i < topology.size(); ++i) {
+            glm::vec3 delta = submesh.vertices[submesh.indices[i]].position - original[topology[i]].position;
+            correct = glm::length(delta) < 1e-5f &&
+                      submesh.vertices[submesh.indices[i]].normal == original[topology[i]].normal;
+        }
+
+        // Already shared grid corners stay as they are
+        Mesh grid("grid");
+        writeGridOBJ("mesh_test_grid.obj", 64);
+        correct = correct && loader.parseOBJ("mesh_test_grid.obj", grid);
+        std::size_t gridVertices = correct ? grid.submeshes[0].vertices.size() : 0;
+        if (correct) {
+            MeshUtils::removeDuplicateVertices(grid);
+        }
+        correct = correct && gridVertices == 65u * 65u && grid.submeshes[0].vertices.size() == gridVertices;
+
+        if (correct) {
+            VF_LOG_INFO("✓ {} corners merged into {} vertices", expanded.size(), submesh.vertices.size());
+        } else {
+            VF_LOG_WARN("✗ Vertex deduplication changed the mesh");
+        }
+    }
+
+    // Test 5: Index Optimization
+    VF_LOG_INFO("=== Test 5: Index Optimization ===");
+
+    {
+        std::mt19937 rng(24);
+        bool correct = true;
+        for (bool reduceOverdraw : {false, true}) {
+            auto mesh = reduceOverdraw ? MeshUtils::createSphere(1.0f, 48) : MeshUtils::createPlane(1.0f, 1.0f, 64);
+            Submesh& submesh = mesh->submeshes[0];
+            shuffleSubmesh(submesh, rng);
+            auto topology = triangleSet(submesh);
+            VertexCacheStatistics before = MeshUtils::analyzeVertexCache(submesh);
+
+            MeshUtils::optimizeIndices(*mesh, reduceOverdraw);
+            VertexCacheStatistics after = MeshUtils::analyzeVertexCache(submesh);
+            VF_LOG_INFO("{}{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", mesh->name,
+                        reduceOverdraw ? " with overdraw pass" : "", before.acmr, after.acmr, before.atvr, after.atvr);
+
+            // Same triangles, better cache use, vertices in first-use order
+            uint32_t nextVertex = 0;
+            bool firstUse = true;
+            for (uint32_t index : submesh.indices) {
+                firstUse = firstUse && index <= nextVertex;
+                nextVertex = std::max(nextVertex, index + 1);
+            }
+            correct = correct && triangleSet(submesh) == topology && after.acmr < before.acmr * 0.5f &&
+                      after.acmr < 1.0f && firstUse && MeshUtils::validateMesh(*mesh);
+        }
+
+        if (correct) {
+            VF_LOG_INFO("✓ Index buffers reordered without changing topology");
+        } else {
+            VF_LOG_WARN("✗ Index optimization changed or failed to improve the mesh");
+        }
+    }
+
+    // Test 6: Cooked Mesh Cache
+    VF_LOG_INFO("=== Test 6: Cooked Mesh Cache ===");
+
+    {
+        // Cold load imports and cooks, the next process maps the cooked copy
+        writeGridOBJ("mesh_test_grid.obj", 600);
+        std::ofstream("mesh_test.mtl", std::ios::binary | std::ios::trunc) << "newmtl Ground\nKd 0 1 0\n";
+        auto start = std::chrono::high_resolution_clock::now();
+        auto imported = loader.loadMesh("mesh_test_grid.obj");
+        double importTime = ms(start, std::chrono::high_resolution_clock::now());
+        std::string cookedPath = loader.getCookedMeshPath("mesh_test_grid.obj");
+        bool correct = imported && std::filesystem::exists(cookedPath);
+
+        loader.clearCache();
+        start = std::chrono::high_resolution_clock::now();
+        auto cooked = loader.loadMesh("mesh_test_grid.obj");
+        double cookedTime = ms(start, std::chrono::high_resolution_clock::now());
+        VF_LOG_INFO("Grid load, importing: {:.1f} ms, cooked: {:.1f} ms ({:.1f}x)", importTime, cookedTime,
+                    importTime / cookedTime);
+        correct = correct && cooked && cooked != imported && sameMesh(*imported, *cooked) &&
+                  cooked->minBounds == imported->minBounds && cooked->maxBounds == imported->maxBounds &&
+                  cooked->totalIndices == imported->totalIndices && cooked->materials[1].diffuse == glm::vec3(0, 1, 0);
+
+        // Editing the material library re-imports
+        std::ofstream("mesh_test.mtl", std::ios::binary | std::ios::trunc) << "newmtl Ground\nKd 0 0 1\n";
+        loader.clearCache();
+        auto edited = loader.loadMesh("mesh_test_grid.obj");
+        correct = correct && edited && edited->materials[1].diffuse == glm::vec3(0, 0, 1);
+
+        // Cooked by content into a cache directory; another source with the
+        // same bytes shares the file, a changed one gets its own
+        loader.setCookedMeshDirectory("mesh_test_cache");
+        std::filesystem::copy_file("mesh_test_grid.obj", "mesh_test_copy.obj",
+                                   std::filesystem::copy_options::overwrite_existing);
+        loader.clearCache();
+        correct = correct && loader.loadMesh("mesh_test_grid.obj") && loader.loadMesh("mesh_test_copy.obj") &&
+                  loader.getCookedMeshPath("mesh_test_grid.obj") == loader.getCookedMeshPath("mesh_test_copy.obj") &&
+                  std::filesystem::exists(loader.getCookedMeshPath("mesh_test_grid.obj"));
+        std::ofstream("mesh_test_copy.obj", std::ios::binary | std::ios::app) << "v 9 9 9\nf 1 2 -1\n";
+        loader.clearCache();
+        auto changed = loader.loadMesh("mesh_test_copy.obj");
+        correct = correct && changed && changed->totalIndices == imported->totalIndices + 3 &&
+                  loader.getCookedMeshPath("mesh_test_copy.obj") != loader.getCookedMeshPath("mesh_test_grid.obj");
+
+        // So does one whose first index points past its submesh's vertices.
+        // The header is 48 bytes, then 24-byte {type, count, offset, size}
+        // section entries; indices are type 5.
+        {
+            std::fstream cookedFile(loader.getCookedMeshPath("mesh_test_copy.obj"),
+                                    std::ios::binary | std::ios::in | std::ios::out);
+            std::uint32_t sectionCount = 0;
+            cookedFile.seekg(12);
+            cookedFile.read(reinterpret_cast<char*>(&sectionCount), sizeof(sectionCount));
+            for (std::uint32_t i = 0; i < sectionCount; ++i) {
+                std::uint32_t type = 0;
+                std::uint64_t offset = 0;
+                cookedFile.seekg(48 + i * 24);
+                cookedFile.read(reinterpret_cast<char*>(&type), sizeof(type));
+                cookedFile.seekg(48 + i * 24 + 8);
+                cookedFile.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+                if (type == 5) {
+                    const std::uint32_t badIndex = 0xFFFFFFFFu;
+                    cookedFile.seekp(static_cast<std::streamoff>(offset));
+                    cookedFile.write(reinterpret_cast<const char*>(&badIndex), sizeof(badIndex));
+                }
+            }
+        }
+        loader.clearCache();
+        auto reindexed = loader.loadMesh("mesh_test_copy.obj");
+        correct = correct && reindexed && sameMesh(*changed, *reindexed);
+
+        // A corrupt cooked file falls back to importing
+        std::ofstream(loader.getCookedMeshPath("mesh_test_copy.obj"), std::ios::binary | std::ios::trunc) << "VFMC";
+        loader.clearCache();
+        auto recovered = loader.loadMesh("mesh_test_copy.obj");
+        correct = correct && recovered && sameMesh(*changed, *recovered);
+
+        loader.clearCache();
+        loader.setCookedMeshDirectory("");
+        std::filesystem::remove_all("mesh_test_cache");
+        std::filesystem::remove(cookedPath);
+        std::remove("mesh_test_copy.obj");
+
+        if (correct) {
+            VF_LOG_INFO("✓ Cooked meshes load like imported ones and follow their sources");
+        } else {
+            VF_LOG_WARN("✗ Cooked mesh cache returned the wrong mesh");
+        }
+    }
+
+    std::remove("mesh_test.obj");
+    std::remove("mesh_test.mtl");
+    std::remove("mesh_test_grid.obj");
+    std::remove("mesh_test_relative.obj");
+
+    // Test Results
+    VF_LOG_INFO("=== Mesh Loader Test Results ===");
+    VF_LOG_INFO("✓ OBJ parsing working");
+    VF_LOG_INFO("✓ Parallel OBJ parsing working");
+    VF_LOG_INFO("✓ Vertex deduplication working");
+    VF_LOG_INFO("✓ Index optimization working");
+    VF_LOG_INFO("✓ Cooked mesh cache working");
+
+    VF_LOG_INFO("Mesh Loader test completed successfully!");
+
+    // Keep console open
+    std::cout << "\nPress Enter to exit...";
+    std::cin.get();
+
+    return 0;
+}
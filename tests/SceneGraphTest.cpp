@@ -1,11 +1,26 @@
 #include "../src/Core/SceneGraph.h"
+#include "../src/Core/JobSystem.h"
 #include "../src/Core/Logger.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <cstring>
 
 using namespace VaporFrame::Core;
 
+// Transforms in a scene live in its packed storage; this is a transform
+// allocated on its own, for comparing the heap with a pool
+struct PooledTransform final : TransformComponent, PooledObject<PooledTransform> {};
+
 int main() {
     // Initialize logger
     VaporFrame::Logger::getInstance().initialize("scenegraph_test.log");
@@ -196,6 +211,993 @@ int main() {
         VF_LOG_INFO("Switched active scene back to: {}", sceneManager.getActiveScene()->getName());
     }
     
+    // Test 11: Pooled Allocation
+    VF_LOG_INFO("=== Test 11: Pooled Allocation ===");
+    
+    {
+        const std::size_t transformCount = 1000000;
+        std::vector<TransformComponent*> transforms(transformCount);
+        std::vector<std::size_t> order(transformCount);
+        for (std::size_t i = 0; i < transformCount; ++i) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        
+        // Create all, touch all, then destroy in random order so the heap
+        // and the pool both see a realistic free pattern
+        auto run = [&](auto create, auto destroy) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (std::size_t i = 0; i < transformCount; ++i) {
+                transforms[i] = create();
+            }
+            auto created = std::chrono::high_resolution_clock::now();
+            for (TransformComponent* transform : transforms) {
+                transform->position.x += 1.0f;
+            }
+            auto touched = std::chrono::high_resolution_clock::now();
+            for (std::size_t i : order) {
+                destroy(transforms[i]);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            
+            auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+            return std::array<double, 3>{ms(start, created), ms(created, touched), ms(touched, end)};
+        };
+        
+        // ::new and ::delete bypass the class-level pool
+        auto heap = run([]() { return ::new PooledTransform(); },
+                        [](TransformComponent* transform) { ::delete transform; });
+        auto pooled = run([]() { return new PooledTransform(); },
+                          [](TransformComponent* transform) { delete transform; });
+        
+        VF_LOG_INFO("1M transforms on the heap: create {:.1f} ms, iterate {:.1f} ms, destroy {:.1f} ms", heap[0], heap[1], heap[2]);
+        VF_LOG_INFO("1M transforms pooled:      create {:.1f} ms, iterate {:.1f} ms, destroy {:.1f} ms", pooled[0], pooled[1], pooled[2]);
+        
+        // Handles notice when their slot has been reused
+        ObjectPool<TransformComponent> pool;
+        auto handle = pool.create();
+        pool.destroy(handle);
+        auto reused = pool.create();
+        if (!pool.isAlive(handle) && pool.isAlive(reused) && pool.get(reused) != nullptr) {
+            VF_LOG_INFO("✓ Stale pool handles rejected");
+        } else {
+            VF_LOG_WARN("✗ Stale pool handle still resolves");
+        }
+    }
+    
+    // Test 12: Component Storage
+    VF_LOG_INFO("=== Test 12: Component Storage ===");
+    
+    {
+        const std::size_t entityCount = 1000000;
+        Scene storageScene("StorageScene");
+        std::vector<SceneNode*> nodes(entityCount);
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            nodes[i] = storageScene.createEntity("Bench");
+            if (i % 4 == 0) {
+                nodes[i]->addComponent<MeshComponent>();
+            }
+        }
+        
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        const glm::vec3 step(0.01f, 0.0f, 0.0f);
+        
+        // Through the compatibility shim, one lookup per entity
+        auto start = std::chrono::high_resolution_clock::now();
+        for (SceneNode* node : nodes) {
+            node->getTransform()->translate(step);
+        }
+        auto shimmed = std::chrono::high_resolution_clock::now();
+        
+        // Streaming the packed transforms
+        storageScene.view<TransformComponent>().each([&step](TransformComponent& transform) {
+            transform.translate(step);
+        });
+        auto viewed = std::chrono::high_resolution_clock::now();
+        
+        std::size_t meshTransforms = 0;
+        storageScene.view<TransformComponent, MeshComponent>().each(
+            [&meshTransforms](EntityID, TransformComponent& transform, MeshComponent& mesh) {
+                if (mesh.visible) {
+                    transform.translate(glm::vec3(0.0f, 1.0f, 0.0f));
+                    meshTransforms++;
+                }
+            });
+        auto joined = std::chrono::high_resolution_clock::now();
+        
+        VF_LOG_INFO("TransformComponent {} bytes, matrices {} bytes out of line", sizeof(TransformComponent), sizeof(TransformMatrices));
+        VF_LOG_INFO("1M transform updates via getComponent: {:.1f} ms", ms(start, shimmed));
+        VF_LOG_INFO("1M transform updates via view:         {:.1f} ms", ms(shimmed, viewed));
+        VF_LOG_INFO("{} transform+mesh updates via view:  {:.1f} ms", meshTransforms, ms(viewed, joined));
+        
+        // Removed components leave their slots until the scene compacts its
+        // storage; lookups and views must skip them
+        for (std::size_t i = 0; i < entityCount; i += 8) {
+            nodes[i]->removeComponent<MeshComponent>();
+        }
+        std::size_t viewCount = 0;
+        bool consistent = true;
+        for (auto [id, transform, mesh] : storageScene.view<TransformComponent, MeshComponent>()) {
+            SceneNode* node = storageScene.getEntity(id);
+            consistent = consistent && node->getComponent<MeshComponent>() == &mesh &&
+                         node->getTransform() == &transform && transform.position.y == 1.0f;
+            viewCount++;
+        }
+        
+        // Detaching moves components out of the scene and back in
+        std::unique_ptr<SceneNode> detached = storageScene.removeRootEntity(nodes[4]->getID());
+        consistent = consistent && detached->getTransform() && detached->getComponent<MeshComponent>() &&
+                     detached->getTransform()->position.x > 0.0f;
+        storageScene.addRootEntity(std::move(detached));
+        consistent = consistent && nodes[4]->getComponent<MeshComponent>() &&
+                     nodes[4]->getTransform()->position.x > 0.0f;
+        
+        if (consistent && viewCount == entityCount / 8 && storageScene.getComponentCount() == entityCount + entityCount / 8) {
+            VF_LOG_INFO("✓ Component storage consistent after removal and detach ({} matches)", viewCount);
+        } else {
+            VF_LOG_WARN("✗ Component storage inconsistent ({} matches)", viewCount);
+        }
+
+        // Pointers survive removing another light until the next update,
+        // which moves the last light into the middle one's slot
+        Scene lightScene("LightScene");
+        SceneNode* lights[3];
+        for (int i = 0; i < 3; ++i) {
+            lights[i] = lightScene.createEntity("Light");
+            LightComponent* light = lights[i]->addComponent<LightComponent>();
+            light->intensity = static_cast<float>(i + 1);
+            light->color = glm::vec3(static_cast<float>(i));
+        }
+        LightComponent* middle = lights[1]->getComponent<LightComponent>();
+        LightComponent* last = lights[2]->getComponent<LightComponent>();
+        lights[1]->removeComponent<LightComponent>();
+        std::size_t lightCount = 0;
+        lightScene.view<LightComponent>().each([&lightCount](LightComponent&) { lightCount++; });
+        bool stable = lights[2]->getComponent<LightComponent>() == last && last->intensity == 3.0f &&
+                      middle->intensity == 2.0f && !lights[1]->getComponent<LightComponent>() && lightCount == 2;
+        
+        lightScene.update(0.0f);
+        const LightComponent* moved = lights[2]->getComponent<LightComponent>();
+        const LightComponent* first = lights[0]->getComponent<LightComponent>();
+        bool compacted = moved == middle && moved->intensity == 3.0f && moved->color == glm::vec3(2.0f) &&
+                         first && first->intensity == 1.0f && !lights[1]->getComponent<LightComponent>() &&
+                         lightScene.getComponentCount() == 5;
+        if (stable && compacted) {
+            VF_LOG_INFO("✓ Component pointers stable until the update compacts storage");
+        } else {
+            VF_LOG_WARN("✗ Component pointers moved before the update (stable {}, compacted {})", stable, compacted);
+        }
+    }
+    
+    // Test 13: Cached Queries
+    VF_LOG_INFO("=== Test 13: Cached Queries ===");
+    
+    {
+        Scene queryScene("QueryScene");
+        SceneQuery* lit = queryScene.createQuery(QueryFilter().all<MeshComponent>().any<LightComponent, CameraComponent>());
+        SceneQuery* unlit = queryScene.createQuery(QueryFilter().all<MeshComponent>().none<LightComponent>());
+        
+        const std::size_t entityCount = 100000;
+        std::vector<SceneNode*> nodes(entityCount);
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            nodes[i] = i % 2 == 0 ? queryScene.createEntity("Query")
+                                  : queryScene.createChildEntity(nodes[i - 1], "QueryChild");
+            nodes[i]->addComponent<MeshComponent>();
+            if (i % 4 == 0) {
+                nodes[i]->addComponent<LightComponent>();
+            }
+        }
+        
+        bool consistent = lit->size() == entityCount / 4 && unlit->size() == entityCount - entityCount / 4;
+        
+        // Incremental updates on add, remove and destroy
+        nodes[1]->addComponent<CameraComponent>();
+        nodes[4]->removeComponent<LightComponent>();
+        consistent = consistent && lit->contains(nodes[1]->getID()) && unlit->contains(nodes[1]->getID()) &&
+                     !lit->contains(nodes[4]->getID()) && unlit->contains(nodes[4]->getID());
+        nodes[3]->addComponent<LightComponent>();
+        nodes[3]->addComponent<CameraComponent>();
+        consistent = consistent && lit->contains(nodes[3]->getID()) && !unlit->contains(nodes[3]->getID());
+        
+        // Destroying a parent takes its child out of every query too
+        EntityID parentId = nodes[8]->getID();
+        EntityID childId = nodes[9]->getID();
+        queryScene.destroyEntity(parentId);
+        consistent = consistent && !lit->contains(parentId) && !unlit->contains(childId);
+        
+        // A query created late starts from the current scene
+        SceneQuery* cameras = queryScene.createQuery(QueryFilter().all<CameraComponent>());
+        consistent = consistent && cameras->size() == 2;
+        
+        const int frames = 100;
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        std::size_t visited = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            visited += queryScene.getEntitiesWithComponent<LightComponent>().size();
+        }
+        auto copied = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            for (SceneNode* node : *lit) {
+                visited += node->isActive() ? 1 : 0;
+            }
+        }
+        auto iterated = std::chrono::high_resolution_clock::now();
+        
+        VF_LOG_INFO("getEntitiesWithComponent x{}: {:.2f} ms/frame", frames, ms(start, copied) / frames);
+        VF_LOG_INFO("Cached query iteration x{}:   {:.2f} ms/frame ({} visits)", frames, ms(copied, iterated) / frames, visited);
+        
+        if (consistent) {
+            VF_LOG_INFO("✓ Cached queries track component and entity changes");
+        } else {
+            VF_LOG_WARN("✗ Cached queries out of date (lit {}, unlit {})", lit->size(), unlit->size());
+        }
+    }
+    
+    // Test 14: Transform Propagation
+    VF_LOG_INFO("=== Test 14: Transform Propagation ===");
+    
+    {
+        const std::size_t nodeCount = 100000;
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        bool correct = true;
+        
+        // Deep: one chain of 100k nodes. Wide: one root with 100k children.
+        for (bool deep : {true, false}) {
+            Scene hierarchyScene(deep ? "DeepScene" : "WideScene");
+            SceneNode* root = hierarchyScene.createEntity("Root");
+            SceneNode* leaf = root;
+            for (std::size_t i = 1; i < nodeCount; ++i) {
+                leaf = hierarchyScene.createChildEntity(deep ? leaf : root, "Node");
+                leaf->getTransform()->setPosition(glm::vec3(0.0f, 0.001f, 0.0f));
+            }
+            
+            TransformSystem& transforms = hierarchyScene.getTransformSystem();
+            auto start = std::chrono::high_resolution_clock::now();
+            transforms.update();
+            auto built = std::chrono::high_resolution_clock::now();
+            
+            root->getTransform()->setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+            transforms.update();
+            auto propagated = std::chrono::high_resolution_clock::now();
+            std::size_t propagatedCount = transforms.getLastUpdatedCount();
+            
+            leaf->getTransform()->translate(glm::vec3(0.0f, 0.0f, 1.0f));
+            transforms.update();
+            auto single = std::chrono::high_resolution_clock::now();
+            std::size_t singleCount = transforms.getLastUpdatedCount();
+            
+            transforms.update();
+            auto clean = std::chrono::high_resolution_clock::now();
+            
+            VF_LOG_INFO("{} 100k: build+update {:.2f} ms, root moved {:.2f} ms ({} updated), leaf moved {:.3f} ms ({} updated), clean {:.3f} ms",
+                        deep ? "Deep" : "Wide", ms(start, built), ms(built, propagated), propagatedCount,
+                        ms(propagated, single), singleCount, ms(single, clean));
+            
+            float expectedY = deep ? 0.001f * (nodeCount - 1) : 0.001f;
+            glm::mat4 leafWorld = leaf->getTransform()->getCachedWorldTransform();
+            correct = correct && propagatedCount == nodeCount && singleCount == 1 &&
+                      transforms.getLastUpdatedCount() == 0 && leafWorld[3].x == 1.0f &&
+                      std::abs(leafWorld[3].y - expectedY) < expectedY * 0.001f && leafWorld[3].z == 1.0f;
+            
+            // Between passes the lazy path sees an ancestor's change too
+            root->getTransform()->setPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+            correct = correct && leaf->getTransform()->getWorldTransform()[3].x == 2.0f;
+            
+            if (!deep) {
+                root->getTransform()->setPosition(glm::vec3(3.0f, 0.0f, 0.0f));
+                auto lazyStart = std::chrono::high_resolution_clock::now();
+                for (auto& child : root->getChildren()) {
+                    correct = correct && child->getTransform()->getWorldTransform()[3].x == 3.0f;
+                }
+                auto lazyEnd = std::chrono::high_resolution_clock::now();
+                VF_LOG_INFO("Wide 100k: per-node getWorldTransform after root moved {:.2f} ms", ms(lazyStart, lazyEnd));
+            }
+        }
+        
+        if (correct) {
+            VF_LOG_INFO("✓ Transform changes propagate to descendants");
+        } else {
+            VF_LOG_WARN("✗ Transform propagation produced wrong world matrices");
+        }
+    }
+    
+    // Test 15: Batch Transform Kernels
+    VF_LOG_INFO("=== Test 15: Batch Transform Kernels ===");
+    
+    {
+        const std::size_t transformCount = 1000000;
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> positionRange(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> angleRange(-180.0f, 180.0f);
+        std::uniform_real_distribution<float> scaleRange(0.5f, 2.0f);
+        
+        // Euler input for the per-object path, SoA quaternions for the kernels
+        std::vector<glm::vec3> positions(transformCount), eulers(transformCount), scales(transformCount);
+        std::vector<float> lanes[10];
+        for (auto& lane : lanes) {
+            lane.resize(transformCount);
+        }
+        for (std::size_t i = 0; i < transformCount; ++i) {
+            positions[i] = glm::vec3(positionRange(rng), positionRange(rng), positionRange(rng));
+            eulers[i] = glm::vec3(angleRange(rng), angleRange(rng), angleRange(rng));
+            scales[i] = glm::vec3(scaleRange(rng), scaleRange(rng), scaleRange(rng));
+            glm::quat rotation(glm::radians(eulers[i]));
+            const float values[10] = {positions[i].x, positions[i].y, positions[i].z,
+                                      rotation.x, rotation.y, rotation.z, rotation.w,
+                                      scales[i].x, scales[i].y, scales[i].z};
+            for (int lane = 0; lane < 10; ++lane) {
+                lanes[lane][i] = values[lane];
+            }
+        }
+        
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        
+        // The per-object path updateLocalTransform used to take
+        std::vector<glm::mat4> reference(transformCount);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < transformCount; ++i) {
+            reference[i] = glm::translate(glm::mat4(1.0f), positions[i]) *
+                           glm::mat4_cast(glm::quat(glm::radians(eulers[i]))) *
+                           glm::scale(glm::mat4(1.0f), scales[i]);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        VF_LOG_INFO("1M local matrices, per-object glm path: {:.1f} ms", ms(start, end));
+        
+        TransformBatch batch;
+        batch.positionX = lanes[0].data();
+        batch.positionY = lanes[1].data();
+        batch.positionZ = lanes[2].data();
+        batch.rotationX = lanes[3].data();
+        batch.rotationY = lanes[4].data();
+        batch.rotationZ = lanes[5].data();
+        batch.rotationW = lanes[6].data();
+        batch.scaleX = lanes[7].data();
+        batch.scaleY = lanes[8].data();
+        batch.scaleZ = lanes[9].data();
+        batch.count = transformCount;
+        
+        std::vector<glm::mat4> scalar(transformCount);
+        bool matches = true;
+        for (TransformKernel kernel : {TransformKernel::Scalar, TransformKernel::SSE, TransformKernel::AVX2}) {
+            if (!TransformKernels::isSupported(kernel)) {
+                VF_LOG_INFO("1M local matrices, {} kernel: not supported on this CPU", TransformKernels::getName(kernel));
+                continue;
+            }
+            std::vector<glm::mat4> matrices(transformCount);
+            batch.matrices = matrices.data();
+            start = std::chrono::high_resolution_clock::now();
+            TransformKernels::compose(batch, kernel);
+            end = std::chrono::high_resolution_clock::now();
+            
+            // The full run is bound by memory bandwidth; repeat a cache-sized
+            // slice to see the arithmetic
+            TransformBatch slice = batch;
+            slice.count = 4096;
+            auto sliceStart = std::chrono::high_resolution_clock::now();
+            for (std::size_t done = 0; done < transformCount; done += slice.count) {
+                TransformKernels::compose(slice, kernel);
+            }
+            auto sliceEnd = std::chrono::high_resolution_clock::now();
+            VF_LOG_INFO("1M local matrices, {} kernel: {:.1f} ms ({:.1f} ms cache-resident)",
+                        TransformKernels::getName(kernel), ms(start, end), ms(sliceStart, sliceEnd));
+            
+            if (kernel == TransformKernel::Scalar) {
+                scalar = matrices;
+            }
+            // Same arithmetic in every kernel, and close to glm's result
+            for (std::size_t i = 0; i < transformCount; ++i) {
+                for (int column = 0; column < 4; ++column) {
+                    for (int row = 0; row < 4; ++row) {
+                        float value = matrices[i][column][row];
+                        matches = matches && value == scalar[i][column][row] &&
+                                  std::abs(value - reference[i][column][row]) < 1e-4f * (1.0f + std::abs(value));
+                    }
+                }
+            }
+        }
+        VF_LOG_INFO("Active transform kernel: {}", TransformKernels::getName(TransformKernels::getActiveKernel()));
+        
+        if (matches) {
+            VF_LOG_INFO("✓ Batch transform kernels match the per-object path");
+        } else {
+            VF_LOG_WARN("✗ Batch transform kernels disagree with the per-object path");
+        }
+    }
+    
+    // Test 16: Parallel Scene Update
+    VF_LOG_INFO("=== Test 16: Parallel Scene Update ===");
+    
+    {
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        bool correct = true;
+        
+        // Dependencies: b and c wait for a, d for both
+        {
+            JobSystem jobs(3);
+            std::atomic<int> step{0};
+            int aStep = -1, bStep = -1, cStep = -1, dStep = -1;
+            JobHandle a = jobs.schedule([&]() { aStep = step++; });
+            JobHandle b = jobs.schedule([&]() { bStep = step++; }, {a});
+            JobHandle c = jobs.schedule([&]() { cStep = step++; }, {a});
+            JobHandle d = jobs.schedule([&]() { dStep = step++; }, {b, c});
+            jobs.wait(d);
+            correct = correct && aStep == 0 && bStep > aStep && cStep > aStep && dStep == 3;
+            
+            // Every index visited exactly once
+            std::vector<int> visits(100000, 0);
+            jobs.parallelFor(visits.size(), 0, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    ++visits[i];
+                }
+            });
+            correct = correct && std::all_of(visits.begin(), visits.end(), [](int count) { return count == 1; });
+        }
+        
+        // 32 roots of 512 script entities, each doing some independent math
+        // and moving itself. Roots rise every frame, so children read a
+        // freshly changed parent.
+        const std::size_t rootCount = 32;
+        const std::size_t childCount = 512;
+        const int frameCount = 4;
+        Scene scriptScene("ScriptScene");
+        std::vector<float> state(rootCount * childCount);
+        for (std::size_t root = 0; root < rootCount; ++root) {
+            SceneNode* rootNode = scriptScene.createEntity("ScriptRoot");
+            rootNode->addComponent<ScriptComponent>()->updateFunction = [rootNode](float deltaTime) {
+                rootNode->getTransform()->translate(glm::vec3(0.0f, deltaTime, 0.0f));
+            };
+            for (std::size_t child = 0; child < childCount; ++child) {
+                SceneNode* node = scriptScene.createChildEntity(rootNode, "Script");
+                float* value = &state[root * childCount + child];
+                auto script = node->addComponent<ScriptComponent>();
+                script->updateFunction = [node, value](float deltaTime) {
+                    float x = *value;
+                    for (int i = 0; i < 200; ++i) {
+                        x = std::sin(x + deltaTime) * 0.5f + std::cos(x) * 0.25f;
+                    }
+                    TransformComponent* transform = node->getTransform();
+                    transform->translate(glm::vec3(x, 0.0f, 0.0f));
+                    *value = x + transform->getWorldTransform()[3].y;
+                };
+            }
+        }
+        
+        std::vector<float> serialState;
+        double serialTime = 0.0;
+        for (std::size_t threads : {1, 2, 4, 8, 16}) {
+            std::fill(state.begin(), state.end(), 0.5f);
+            for (auto& rootNode : scriptScene.getRootEntities()) {
+                rootNode->getTransform()->setPosition(glm::vec3(0.0f));
+                for (auto& child : rootNode->getChildren()) {
+                    child->getTransform()->setPosition(glm::vec3(0.0f));
+                }
+            }
+            JobSystem jobs(threads - 1);
+            scriptScene.setJobSystem(&jobs);
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int frame = 0; frame < frameCount; ++frame) {
+                scriptScene.update(0.016f);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            scriptScene.setJobSystem(nullptr);
+            
+            double frameTime = ms(start, end) / frameCount;
+            if (threads == 1) {
+                serialState = state;
+                serialTime = frameTime;
+            }
+            correct = correct && state == serialState;
+            VF_LOG_INFO("{} scripts, {:2} threads: {:.2f} ms per update ({:.2f}x)",
+                        state.size(), threads, frameTime, serialTime / frameTime);
+        }
+        VF_LOG_INFO("Hardware threads: {}", std::thread::hardware_concurrency());
+        
+        if (correct) {
+            VF_LOG_INFO("✓ Parallel scene update matches the serial one");
+        } else {
+            VF_LOG_WARN("✗ Parallel scene update diverged from the serial one");
+        }
+    }
+    
+    // Test 17: Binary Scene Files
+    VF_LOG_INFO("=== Test 17: Binary Scene Files ===");
+    
+    {
+        const std::size_t entityCount = 100000;
+        const std::string sceneFile = "scenegraph_test.vfscene";
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> valueRange(-100.0f, 100.0f);
+        
+        // A random forest: 1000 roots, everything else under an earlier entity
+        Scene original("SavedScene");
+        std::vector<SceneNode*> created;
+        created.reserve(entityCount);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            std::string entityName = "Entity" + std::to_string(i);
+            SceneNode* node = i < 1000 ? original.createEntity(entityName)
+                                       : original.createChildEntity(created[rng() % i], entityName);
+            TransformComponent* transform = node->getTransform();
+            transform->setPosition(glm::vec3(valueRange(rng), valueRange(rng), valueRange(rng)));
+            transform->setRotation(glm::vec3(valueRange(rng), valueRange(rng), valueRange(rng)));
+            transform->setScale(glm::vec3(1.0f + i % 3));
+            if (i % 4 == 0) {
+                auto mesh = node->addComponent<MeshComponent>();
+                mesh->autoLoad = false;
+                mesh->meshPath = "models/prop" + std::to_string(i % 50) + ".obj";
+                mesh->visible = i % 8 != 0;
+            }
+            if (i % 10 == 0) {
+                auto light = node->addComponent<LightComponent>();
+                light->type = static_cast<LightComponent::LightType>(i % 3);
+                light->color = glm::vec3(0.1f, 0.5f, valueRange(rng));
+                light->intensity = 2.0f;
+            }
+            if (i % 1000 == 0) {
+                auto camera = node->addComponent<CameraComponent>();
+                camera->fov = 60.0f + i % 30;
+                camera->isMainCamera = i == 0;
+            }
+            if (i % 997 == 5) {
+                node->setActive(false);
+            }
+            if (i % 1009 == 7) {
+                node->removeComponent<TransformComponent>();
+            }
+            created.push_back(node);
+        }
+        auto built = std::chrono::high_resolution_clock::now();
+        
+        bool saved = original.saveToFile(sceneFile);
+        auto written = std::chrono::high_resolution_clock::now();
+        
+        Scene loaded("LoadedScene");
+        loaded.createEntity("Leftover");
+        bool loadedOk = loaded.loadFromFile(sceneFile);
+        auto read = std::chrono::high_resolution_clock::now();
+        
+        VF_LOG_INFO("100k entities: built in code {:.1f} ms, saved {:.1f} ms, loaded {:.1f} ms",
+                    ms(start, built), ms(built, written), ms(written, read));
+        
+        bool matches = saved && loadedOk && loaded.getEntityCount() == entityCount &&
+                       loaded.getComponentCount() == original.getComponentCount() &&
+                       loaded.findEntity("Leftover") == nullptr;
+        for (SceneNode* node : created) {
+            if (!matches) break;
+            const SceneNode* copy = loaded.getEntity(node->getID());
+            matches = copy && copy->getName() == node->getName() && copy->isActive() == node->isActive() &&
+                      copy->getChildren().size() == node->getChildren().size() &&
+                      (copy->getParent() ? copy->getParent()->getID() : 0) == (node->getParent() ? node->getParent()->getID() : 0);
+            if (!matches) break;
+            
+            const TransformComponent* transform = node->getTransform();
+            const TransformComponent* transformCopy = copy->getTransform();
+            matches = (transform == nullptr) == (transformCopy == nullptr) &&
+                      (!transform || (transform->position == transformCopy->position &&
+                                      transform->rotation == transformCopy->rotation &&
+                                      transform->scale == transformCopy->scale));
+            const MeshComponent* mesh = node->getComponent<MeshComponent>();
+            const MeshComponent* meshCopy = copy->getComponent<MeshComponent>();
+            matches = matches && (mesh == nullptr) == (meshCopy == nullptr) &&
+                      (!mesh || (mesh->meshPath == meshCopy->meshPath && mesh->visible == meshCopy->visible &&
+                                 mesh->autoLoad == meshCopy->autoLoad));
+            const LightComponent* light = node->getComponent<LightComponent>();
+            const LightComponent* lightCopy = copy->getComponent<LightComponent>();
+            matches = matches && (light == nullptr) == (lightCopy == nullptr) &&
+                      (!light || (light->type == lightCopy->type && light->color == lightCopy->color &&
+                                  light->intensity == lightCopy->intensity));
+            const CameraComponent* camera = node->getComponent<CameraComponent>();
+            const CameraComponent* cameraCopy = copy->getComponent<CameraComponent>();
+            matches = matches && (camera == nullptr) == (cameraCopy == nullptr) &&
+                      (!camera || (camera->fov == cameraCopy->fov && camera->isMainCamera == cameraCopy->isMainCamera));
+        }
+        // New entities don't collide with loaded IDs
+        matches = matches && loaded.getEntity(loaded.createEntity("Fresh")->getID())->getName() == "Fresh";
+        
+        // Corrupt, truncated and foreign files are rejected without touching the scene
+        std::string bytes;
+        {
+            std::ifstream in(sceneFile, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        // The first entity record claims four billion children
+        std::string corrupt = bytes;
+        std::uint64_t entitiesOffset = 0;
+        std::memcpy(&entitiesOffset, corrupt.data() + 16 + 8, sizeof(entitiesOffset));
+        const std::uint32_t childCount = 0xFFFFFFFF;
+        std::memcpy(&corrupt[entitiesOffset + sizeof(EntityID) + 4], &childCount, sizeof(childCount));
+        std::ofstream(sceneFile, std::ios::binary | std::ios::trunc).write(corrupt.data(), corrupt.size());
+        bool rejectsChildCount = !loaded.loadFromFile(sceneFile);
+        std::ofstream(sceneFile, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() / 2);
+        bool rejectsTruncated = !loaded.loadFromFile(sceneFile);
+        std::ofstream(sceneFile, std::ios::binary | std::ios::trunc) << "not a scene file";
+        bool rejectsForeign = !loaded.loadFromFile(sceneFile);
+        matches = matches && rejectsChildCount && rejectsTruncated && rejectsForeign && loaded.getEntityCount() == entityCount + 1;
+        std::remove(sceneFile.c_str());
+        
+        if (matches) {
+            VF_LOG_INFO("✓ Scene files round-trip entities, hierarchy and built-in components");
+        } else {
+            VF_LOG_WARN("✗ Loaded scene differs from the saved one");
+        }
+    }
+    
+    // Test 18: Generational Entity Handles
+    VF_LOG_INFO("=== Test 18: Generational Entity Handles ===");
+
+    {
+        Scene handleScene("HandleScene");
+        bool correct = true;
+
+        // A destroyed entity's slot is reused under a new generation
+        SceneNode* first = handleScene.createEntity("First");
+        EntityID staleId = first->getID();
+        handleScene.destroyEntity(staleId);
+        SceneNode* second = handleScene.createEntity("Second");
+        correct = correct && entityIndex(second->getID()) == entityIndex(staleId) &&
+                  second->getID() != staleId && handleScene.getEntity(staleId) == nullptr &&
+                  handleScene.getEntity(second->getID()) == second;
+
+        // Destroying a parent frees its descendants' IDs as well
+        SceneNode* parent = handleScene.createEntity("Parent");
+        SceneNode* child = handleScene.createChildEntity(parent, "Child");
+        SceneNode* grandchild = handleScene.createChildEntity(child, "Grandchild");
+        EntityID grandchildId = grandchild->getID();
+        correct = correct && parent->findChild(grandchildId) == grandchild && child->findChild(grandchildId) == grandchild &&
+                  grandchild->findChild(parent->getID()) == nullptr && second->findChild(grandchildId) == nullptr;
+        handleScene.destroyEntity(parent);
+        correct = correct && handleScene.getEntity(grandchildId) == nullptr && handleScene.getEntityCount() == 1;
+
+        // Detaching and re-adding keeps the ID while the slot is free
+        SceneNode* mover = handleScene.createEntity("Mover");
+        EntityID moverId = mover->getID();
+        std::unique_ptr<SceneNode> detached = handleScene.removeRootEntity(moverId);
+        correct = correct && handleScene.getEntity(moverId) == nullptr;
+        handleScene.addRootEntity(std::move(detached));
+        correct = correct && handleScene.getEntity(moverId) == mover && mover->getTransform();
+
+        // An ID already taken in another scene is replaced on the way in
+        Scene otherScene("OtherScene");
+        SceneNode* occupant = otherScene.createEntity(moverId, "Occupant");
+        otherScene.addRootEntity(handleScene.removeRootEntity(moverId));
+        correct = correct && occupant->getID() == moverId && mover->getID() != moverId &&
+                  otherScene.getEntity(moverId) == occupant && otherScene.getEntity(mover->getID()) == mover &&
+                  occupant->getTransform() != mover->getTransform();
+
+        // Lookup cost with 1M live handles and as many stale ones
+        const std::size_t entityCount = 1000000;
+        Scene lookupScene("LookupScene");
+        std::vector<EntityID> live(entityCount), stale(entityCount);
+        SceneNode* staleRoot = lookupScene.createEntity("StaleRoot");
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            stale[i] = lookupScene.createChildEntity(staleRoot, "Stale")->getID();
+        }
+        lookupScene.destroyEntity(staleRoot);
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            live[i] = lookupScene.createEntity("Live")->getID();
+        }
+        std::shuffle(live.begin(), live.end(), std::mt19937(18));
+
+        std::size_t found = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (EntityID id : live) {
+            found += lookupScene.getEntity(id) ? 1 : 0;
+        }
+        for (EntityID id : stale) {
+            found += lookupScene.getEntity(id) ? 1 : 0;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        VF_LOG_INFO("2M random lookups (half stale): {:.1f} ms",
+                    std::chrono::duration<double, std::milli>(end - start).count());
+        correct = correct && found == entityCount && lookupScene.getEntityCount() == entityCount;
+
+        if (correct) {
+            VF_LOG_INFO("✓ Stale entity handles no longer resolve");
+        } else {
+            VF_LOG_WARN("✗ Entity handles resolved incorrectly");
+        }
+    }
+
+    // Test 19: Deferred Structural Changes
+    VF_LOG_INFO("=== Test 19: Deferred Structural Changes ===");
+
+    {
+        // Every root spawns a lit child per update and destroys its oldest
+        // child once it has two, from jobs on several threads
+        const std::size_t rootCount = 256;
+        const int frameCount = 4;
+        auto spawnScene = [&](JobSystem* jobs) {
+            auto spawner = std::make_unique<Scene>("SpawnScene");
+            Scene* target = spawner.get();
+            for (std::size_t i = 0; i < rootCount; ++i) {
+                SceneNode* root = target->createEntity("Spawner");
+                EntityID rootId = root->getID();
+                root->addComponent<ScriptComponent>()->updateFunction = [target, rootId](float) {
+                    const SceneNode* self = target->getEntity(rootId);
+                    SceneCommandBuffer& commands = target->getCommandBuffer();
+                    if (self->getChildren().size() >= 2) {
+                        commands.destroyEntity(self->getChildren().front()->getID());
+                    }
+                    auto spawned = commands.createEntity("Spawned", rootId);
+                    commands.addComponent<LightComponent>(spawned);
+                    commands.createEntity("Grandchild", spawned);
+                };
+            }
+            target->setJobSystem(jobs);
+            for (int frame = 0; frame < frameCount; ++frame) {
+                target->update(0.016f);
+            }
+            target->setJobSystem(nullptr);
+            return spawner;
+        };
+
+        JobSystem jobs(3);
+        std::unique_ptr<Scene> serialScene = spawnScene(nullptr);
+        std::unique_ptr<Scene> parallelScene = spawnScene(&jobs);
+
+        bool correct = true;
+        for (Scene* spawned : {serialScene.get(), parallelScene.get()}) {
+            correct = correct && spawned->getEntityCount() == rootCount * 5 &&
+                      spawned->getRootEntities().size() == rootCount &&
+                      spawned->getEntitiesWithComponent<LightComponent>().size() == rootCount * 2;
+            for (const auto& root : spawned->getRootEntities()) {
+                correct = correct && root->getChildren().size() == 2 &&
+                          root->getChildren()[0]->getChildren().size() == 1;
+            }
+        }
+
+        // Reparenting, refusing cycles, and commands on entities that are gone
+        Scene moveScene("MoveScene");
+        SceneNode* a = moveScene.createEntity("A");
+        SceneNode* b = moveScene.createEntity("B");
+        SceneNode* c = moveScene.createChildEntity(b, "C");
+        SceneCommandBuffer& commands = moveScene.getCommandBuffer();
+        commands.setParent(b->getID(), a->getID());
+        commands.setParent(a->getID(), c->getID());
+        commands.setParent(c->getID(), SceneCommandBuffer::EntityRef());
+        EntityID goneId = moveScene.createEntity("Gone")->getID();
+        moveScene.destroyEntity(goneId);
+        commands.addComponent<MeshComponent>(goneId);
+        commands.createEntity("Orphan", goneId);
+        moveScene.playbackCommands();
+        correct = correct && b->getParent() == a && a->getParent() == nullptr && c->getParent() == nullptr &&
+                  moveScene.getRootEntities().size() == 2 && moveScene.getEntityCount() == 3 &&
+                  commands.empty() && moveScene.findEntity("Orphan") == nullptr;
+
+        // Batched destruction against one-by-one
+        const std::size_t batchCount = 20000;
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        Scene oneByOne("OneByOne");
+        Scene batched("Batched");
+        std::vector<EntityID> oneByOneIds, batchedIds;
+        for (std::size_t i = 0; i < batchCount; ++i) {
+            oneByOneIds.push_back(oneByOne.createEntity("Root")->getID());
+            batchedIds.push_back(batched.createEntity("Root")->getID());
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        for (EntityID id : oneByOneIds) {
+            oneByOne.destroyEntity(id);
+        }
+        auto destroyed = std::chrono::high_resolution_clock::now();
+        for (EntityID id : batchedIds) {
+            batched.getCommandBuffer().destroyEntity(id);
+        }
+        batched.playbackCommands();
+        auto played = std::chrono::high_resolution_clock::now();
+        VF_LOG_INFO("Destroying {} roots: one by one {:.1f} ms, batched {:.1f} ms",
+                    batchCount, ms(start, destroyed), ms(destroyed, played));
+        correct = correct && oneByOne.getEntityCount() == 0 && batched.getEntityCount() == 0;
+
+        if (correct) {
+            VF_LOG_INFO("✓ Recorded structural changes apply at the sync point");
+        } else {
+            VF_LOG_WARN("✗ Recorded structural changes applied incorrectly");
+        }
+    }
+
+    // Test 20: Name Index
+    VF_LOG_INFO("=== Test 20: Name Index ===");
+
+    {
+        // 1000 characters of 100 entities each: Character<i>/Body/Arm/Hand
+        // plus filler parts, so names repeat across characters
+        const std::size_t characterCount = 1000;
+        const std::size_t partCount = 96;
+        Scene nameScene("NameScene");
+        std::vector<SceneNode*> hands;
+        for (std::size_t i = 0; i < characterCount; ++i) {
+            SceneNode* character = nameScene.createEntity("Character" + std::to_string(i));
+            SceneNode* body = nameScene.createChildEntity(character, "Body");
+            for (std::size_t part = 0; part < partCount; ++part) {
+                nameScene.createChildEntity(body, "Part" + std::to_string(part));
+            }
+            SceneNode* arm = nameScene.createChildEntity(body, "Arm");
+            hands.push_back(nameScene.createChildEntity(arm, "Hand" + std::to_string(i)));
+        }
+
+        // The recursive scan findEntity used to do
+        std::function<SceneNode*(SceneNode*, const std::string&)> scanChildren =
+            [&scanChildren](SceneNode* node, const std::string& name) -> SceneNode* {
+                for (const auto& child : node->getChildren()) {
+                    if (child->getName() == name) return child.get();
+                    if (SceneNode* found = scanChildren(child.get(), name)) return found;
+                }
+                return nullptr;
+            };
+        auto scan = [&](const std::string& name) -> SceneNode* {
+            for (const auto& root : nameScene.getRootEntities()) {
+                if (root->getName() == name) return root.get();
+                if (SceneNode* found = scanChildren(root.get(), name)) return found;
+            }
+            return nullptr;
+        };
+
+        const std::size_t lookupCount = 1000;
+        std::mt19937 rng(20);
+        std::vector<std::string> names, paths;
+        for (std::size_t i = 0; i < lookupCount; ++i) {
+            std::size_t character = rng() % characterCount;
+            names.push_back("Hand" + std::to_string(character));
+            paths.push_back("Character" + std::to_string(character) + "/Body/Arm/Hand" + std::to_string(character));
+        }
+
+        bool correct = true;
+        auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const std::string& name : names) {
+            correct = correct && scan(name) != nullptr;
+        }
+        auto scanned = std::chrono::high_resolution_clock::now();
+        for (const std::string& name : names) {
+            correct = correct && nameScene.findEntity(name) == scan(name);
+        }
+        auto indexStart = std::chrono::high_resolution_clock::now();
+        for (const std::string& name : names) {
+            correct = correct && nameScene.findEntity(name) != nullptr;
+        }
+        auto indexed = std::chrono::high_resolution_clock::now();
+        for (const std::string& path : paths) {
+            correct = correct && nameScene.findEntityByPath(path) != nullptr;
+        }
+        auto walked = std::chrono::high_resolution_clock::now();
+        VF_LOG_INFO("{} name lookups in {} entities: scan {:.2f} ms, index {:.3f} ms, path {:.3f} ms",
+                    lookupCount, nameScene.getEntityCount(), ms(start, scanned), ms(indexStart, indexed), ms(indexed, walked));
+
+        // Paths, shared names, relative lookups
+        SceneNode* character = nameScene.findEntity("Character7");
+        SceneNode* hand = hands[7];
+        correct = correct && nameScene.findEntityByPath("Character7/Body/Arm/Hand7") == hand &&
+                  nameScene.findEntityByPath("Character7/Body/Arm/Hand8") == nullptr &&
+                  nameScene.findEntityByPath("Body/Arm") == nullptr &&
+                  nameScene.findEntities("Arm").size() == characterCount &&
+                  character->findChildByPath("Body/Arm/Hand7") == hand && character->findChild("Arm") == hand->getParent() &&
+                  character->findChild("Hand7") == hand && character->findChild("Hand8") == nullptr;
+
+        // Renaming, reparenting and destruction keep the index current
+        hand->setName("Claw");
+        correct = correct && nameScene.findEntity("Hand7") == nullptr && nameScene.findEntity("Claw") == hand &&
+                  nameScene.findEntityByPath("Character7/Body/Arm/Claw") == hand;
+        nameScene.reparentEntity(hand, nullptr);
+        correct = correct && nameScene.findEntityByPath("Claw") == hand &&
+                  nameScene.findEntityByPath("Character7/Body/Arm/Claw") == nullptr;
+        nameScene.destroyEntity(character);
+        correct = correct && nameScene.findEntity("Character7") == nullptr &&
+                  nameScene.findEntities("Arm").size() == characterCount - 1 && nameScene.findEntity("Claw") == hand;
+
+        if (correct) {
+            VF_LOG_INFO("✓ Name index matches the scan and follows changes");
+        } else {
+            VF_LOG_WARN("✗ Name index out of date");
+        }
+    }
+
+    // Test 21: Change Tracking
+    VF_LOG_INFO("=== Test 21: Change Tracking ===");
+
+    {
+        // 100k instances under 1000 groups, every tenth with a mesh
+        const std::size_t groupCount = 1000;
+        const std::size_t instancesPerGroup = 99;
+        Scene changeScene("ChangeScene");
+        std::vector<SceneNode*> groups;
+        std::vector<SceneNode*> instances;
+        for (std::size_t i = 0; i < groupCount; ++i) {
+            SceneNode* group = changeScene.createEntity("Group");
+            groups.push_back(group);
+            for (std::size_t j = 0; j < instancesPerGroup; ++j) {
+                SceneNode* instance = changeScene.createChildEntity(group, "Instance");
+                if (instances.size() % 10 == 0) {
+                    instance->addComponent<MeshComponent>();
+                }
+                instances.push_back(instance);
+            }
+        }
+        changeScene.update(0.016f);
+
+        // A GPU-style instance buffer of world matrices, keyed by entity index
+        std::vector<glm::mat4> instanceBuffer;
+        std::uint32_t synced = 0;
+        std::size_t uploads = 0;
+        auto upload = [&](EntityID id, TransformComponent& transform) {
+            if (entityIndex(id) >= instanceBuffer.size()) {
+                instanceBuffer.resize(entityIndex(id) + 1);
+            }
+            instanceBuffer[entityIndex(id)] = transform.getCachedWorldTransform();
+            ++uploads;
+        };
+        auto sync = [&]() {
+            std::uint32_t since = synced;
+            synced = changeScene.advanceChangeVersion();
+            uploads = 0;
+            changeScene.view<TransformComponent>().eachChanged(since, upload);
+            return uploads;
+        };
+        std::size_t initial = sync();
+        std::size_t unchanged = sync();
+
+        // Moving 1% of the instances uploads only those
+        const std::size_t movedCount = instances.size() / 100;
+        for (std::size_t i = 0; i < movedCount; ++i) {
+            instances[i * 100]->getTransform()->setPosition(glm::vec3(static_cast<float>(i), 1.0f, 0.0f));
+        }
+        changeScene.update(0.016f);
+        auto start = std::chrono::high_resolution_clock::now();
+        std::size_t moved = sync();
+        auto deltaDone = std::chrono::high_resolution_clock::now();
+        uploads = 0;
+        changeScene.view<TransformComponent>().each(upload);
+        auto fullDone = std::chrono::high_resolution_clock::now();
+        VF_LOG_INFO("Instance buffer sync, {} of {} moved: delta {:.3f} ms, full {:.3f} ms", moved, uploads,
+                    std::chrono::duration<double, std::milli>(deltaDone - start).count(),
+                    std::chrono::duration<double, std::milli>(fullDone - deltaDone).count());
+        bool correct = initial == groupCount * (instancesPerGroup + 1) && unchanged == 0 && moved == movedCount &&
+                       instanceBuffer[entityIndex(instances[100]->getID())][3].x == 1.0f;
+
+        // A moved group takes its children along; a lazily computed world
+        // matrix still counts at the next update
+        groups[5]->getTransform()->translate(glm::vec3(0.0f, 0.0f, 1.0f));
+        changeScene.update(0.016f);
+        correct = correct && sync() == instancesPerGroup + 1;
+        instances[7]->getTransform()->setScale(glm::vec3(2.0f));
+        instances[7]->getTransform()->getWorldTransform();
+        changeScene.update(0.016f);
+        correct = correct && sync() == 1;
+
+        // Field writes through markChanged; an entity whose transform and
+        // mesh both changed is visited once
+        changeScene.markChanged<MeshComponent>(instances[10]->getID());
+        changeScene.markChanged<MeshComponent>(instances[20]->getID());
+        changeScene.markChanged<TransformComponent>(instances[20]->getID());
+        changeScene.markChanged<TransformComponent>(instances[21]->getID());
+        std::uint32_t since = synced;
+        synced = changeScene.advanceChangeVersion();
+        std::vector<EntityID> visited;
+        changeScene.view<TransformComponent, MeshComponent>().eachChanged(
+            since, [&visited](EntityID id, TransformComponent&, MeshComponent&) { visited.push_back(id); });
+        std::sort(visited.begin(), visited.end());
+        std::vector<EntityID> expected = {instances[10]->getID(), instances[20]->getID()};
+        std::sort(expected.begin(), expected.end());
+        correct = correct && visited == expected && changeScene.findStorage<MeshComponent>()->getVersion(instances[10]->getID()) == since + 1;
+
+        // Removing a component moves another without reporting it; adding one
+        // reports the new component
+        instances[0]->removeComponent<MeshComponent>();
+        instances[1]->addComponent<MeshComponent>();
+        since = synced;
+        synced = changeScene.advanceChangeVersion();
+        visited.clear();
+        changeScene.view<MeshComponent>().eachChanged(since, [&visited](EntityID id, MeshComponent&) { visited.push_back(id); });
+        correct = correct && visited.size() == 1 && visited[0] == instances[1]->getID();
+
+        if (correct) {
+            VF_LOG_INFO("✓ Change tracking reports exactly the changed components");
+        } else {
+            VF_LOG_WARN("✗ Change tracking reported the wrong components");
+        }
+    }
+
     // Test Results
     VF_LOG_INFO("=== Scene Graph Test Results ===");
     VF_LOG_INFO("✓ Entity creation and management working");
@@ -205,6 +1207,17 @@ int main() {
     VF_LOG_INFO("✓ Scene manager working");
     VF_LOG_INFO("✓ Entity queries working");
     VF_LOG_INFO("✓ Update and render cycles working");
+    VF_LOG_INFO("✓ Pooled allocation working");
+    VF_LOG_INFO("✓ Component storage working");
+    VF_LOG_INFO("✓ Cached queries working");
+    VF_LOG_INFO("✓ Transform propagation working");
+    VF_LOG_INFO("✓ Batch transform kernels working");
+    VF_LOG_INFO("✓ Parallel scene update working");
+    VF_LOG_INFO("✓ Binary scene files working");
+    VF_LOG_INFO("✓ Generational entity handles working");
+    VF_LOG_INFO("✓ Deferred structural changes working");
+    VF_LOG_INFO("✓ Name index working");
+    VF_LOG_INFO("✓ Change tracking working");
     
     VF_LOG_INFO("Scene Graph test completed successfully!");
     